@@ -3,6 +3,9 @@
 #include <iomanip>
 #include <algorithm>
 #include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
 #include "../drw_base.h"
 #include "drw_cptables.h"
 #include "drw_cptable932.h"
@@ -10,6 +13,44 @@
 #include "drw_cptable949.h"
 #include "drw_cptable950.h"
 
+/**
+ * Direct and reverse lookup tables of a double byte code page, indexed by the double byte
+ * code and by the Unicode code point (all mapped code points are in the BMP), 0 - not mapped.
+ * Built once per code page, when the first converter of the code page is created, so
+ * converters may be used concurrently.
+ */
+struct DRW_DBCSLookup {
+    std::vector<duint16> toUnicode;
+    std::vector<duint16> fromUnicode;
+
+    static const DRW_DBCSLookup &get(const int table[][2], int length);
+};
+
+/**
+ * 'table' is a double byte table sorted by double byte code; if several codes are mapped
+ * to the same code point, the reverse table keeps the first one.
+ */
+const DRW_DBCSLookup &DRW_DBCSLookup::get(const int table[][2], int length) {
+    static std::mutex mutex;
+    static std::map<const int (*)[2], std::unique_ptr<DRW_DBCSLookup>> lookups;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<DRW_DBCSLookup> &lookup = lookups[table];
+    if (!lookup) {
+        lookup.reset(new DRW_DBCSLookup);
+        lookup->toUnicode.assign(0x10000, 0);
+        lookup->fromUnicode.assign(0x10000, 0);
+        for (int k = 0; k < length; k++) {
+            duint16 code = table[k][0];
+            duint16 unicode = table[k][1];
+            if (lookup->toUnicode[code] == 0)
+                lookup->toUnicode[code] = unicode;
+            if (lookup->fromUnicode[unicode] == 0)
+                lookup->fromUnicode[unicode] = code;
+        }
+    }
+    return *lookup;
+}
+
 DRW_TextCodec::DRW_TextCodec()
     : version{DRW::AC1021}
     , conv( new DRW_Converter(nullptr, 0) )
@@ -92,14 +133,14 @@ void DRW_TextCodec::setCodePage(const std::string &c, bool dxfFormat){
         else if (cp == "ANSI_932")
             conv.reset( new DRW_Conv932Table() );
         else if (cp == "ANSI_936")
-            conv.reset( new DRW_ConvDBCSTable(DRW_Table936, DRW_LeadTable936,
-                                         DRW_DoubleTable936, CPLENGTH936) );
+            conv.reset( new DRW_ConvDBCSTable(DRW_Table936, DRW_DoubleTable936,
+                                              CPLENGTH936) );
         else if (cp == "ANSI_949")
-            conv.reset( new DRW_ConvDBCSTable(DRW_Table949, DRW_LeadTable949,
-                                         DRW_DoubleTable949, CPLENGTH949) );
+            conv.reset( new DRW_ConvDBCSTable(DRW_Table949, DRW_DoubleTable949,
+                                              CPLENGTH949) );
         else if (cp == "ANSI_950")
-            conv.reset( new DRW_ConvDBCSTable(DRW_Table950, DRW_LeadTable950,
-                                         DRW_DoubleTable950, CPLENGTH950) );
+            conv.reset( new DRW_ConvDBCSTable(DRW_Table950, DRW_DoubleTable950,
+                                              CPLENGTH950) );
         else if (cp == "ANSI_1250")
             conv.reset( new DRW_ConvTable(DRW_Table1250, CPLENGTHCOMMON) );
         else if (cp == "ANSI_1251")
@@ -211,7 +252,7 @@ std::string DRW_ConvTable::toUtf8(const std::string &s) {
             } else
                 res +=c; //c!='\' ascii char write
         } else {//end c < 0x80
-            res += encodeNum(table[c-0x80]); //translate from table
+            appendNum(res, table[c-0x80]); //translate from table
         }
     } //end for
 
@@ -248,27 +289,28 @@ std::string DRW_Converter::decodeText(int c){
 }
 
 std::string DRW_Converter::encodeNum(int c){
-    unsigned char ret[5];
+    std::string res;
+    appendNum(res, c);
+    return res;
+}
+
+void DRW_Converter::appendNum(std::string &res, int c){
     if (c < 128) { // 0-7F US-ASCII 7 bits
-        ret[0] = c;
-        ret[1] = 0;
+        if (c != 0) //null char is not written
+            res += static_cast<char>(c);
     } else if (c < 0x800) { //80-07FF 2 bytes
-        ret[0] = 0xC0 | (c >> 6);
-        ret[1] = 0x80 | (c & 0x3f);
-        ret[2] = 0;
+        res += static_cast<char>(0xC0 | (c >> 6));
+        res += static_cast<char>(0x80 | (c & 0x3f));
     } else if (c< 0x10000) { //800-FFFF 3 bytes
-        ret[0] = 0xe0 | (c >> 12);
-        ret[1] = 0x80 | ((c >> 6) & 0x3f);
-        ret[2] = 0x80 | (c & 0x3f);
-        ret[3] = 0;
+        res += static_cast<char>(0xe0 | (c >> 12));
+        res += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        res += static_cast<char>(0x80 | (c & 0x3f));
     } else { //10000-10FFFF 4 bytes
-        ret[0] = 0xf0 | (c >> 18);
-        ret[1] = 0x80 | ((c >> 12) & 0x3f);
-        ret[2] = 0x80 | ((c >> 6) & 0x3f);
-        ret[3] = 0x80 | (c & 0x3f);
-        ret[4] = 0;
+        res += static_cast<char>(0xf0 | (c >> 18));
+        res += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+        res += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        res += static_cast<char>(0x80 | (c & 0x3f));
     }
-    return std::string(reinterpret_cast<char*>(ret));
 }
 
 /** 's' is a string with at least 4 bytes length
@@ -298,50 +340,47 @@ int DRW_Converter::decodeNum(const std::string &s, int *b){
 }
 
 
+DRW_ConvDBCSTable::DRW_ConvDBCSTable(const int *t, const int dt[][2], int l)
+    :DRW_Converter(t, l)
+    ,doubleTable{dt}
+    ,lookup{DRW_DBCSLookup::get(dt, l)}
+{}
+
 std::string DRW_ConvDBCSTable::fromUtf8(const std::string &s) {
+    const DRW_DBCSLookup &dbcs = lookup;
     std::string result;
-    bool notFound;
+    result.reserve(s.length());
     int code;
 
     int j = 0;
     for (unsigned int i=0; i < s.length(); i++) {
         unsigned char c = s.at(i);
         if (c > 0x7F) { //need to decode
-            result += s.substr(j,i-j);
-            std::string part1 = s.substr(i,4);
-            int l;
-            code = decodeNum(part1, &l);
+            result.append(s, j, i-j);
+            int l = 1;
+            code = decodeNum(s.substr(i,4), &l);
             j = i+l;
             i = j - 1;
-            notFound = true;
-                for (int k=0; k<cpLength; k++){
-                    if(doubleTable[k][1] == code) {
-                        int data = doubleTable[k][0];
-                        char d[3];
-                        d[0] = data >> 8;
-                        d[1] = data & 0xFF;
-                        d[2]= '\0';
-                        result += d; //translate from table
-                        notFound = false;
-                        break;
-                    }
-                }
-            if (notFound)
+            int data = code < 0x10000 ? dbcs.fromUnicode[code] : 0;
+            if (data != 0) { //translate from table
+                result += static_cast<char>(data >> 8);
+                result += static_cast<char>(data & 0xFF);
+            } else
                 result += decodeText(code);
         } //direct conversion
     }
-    result += s.substr(j);
+    result.append(s, j, std::string::npos);
 
     return result;
 }
 
 std::string DRW_ConvDBCSTable::toUtf8(const std::string &s) {
+    const DRW_DBCSLookup &dbcs = lookup;
     std::string res;
+    res.reserve(s.length());
     for (auto it=s.begin() ; it < s.end(); ++it ) {
-        bool notFound = true;
         unsigned char c = *it;
         if (c < 0x80) {
-            notFound = false;
             //check for \U+ encoded text
             if (c == '\\') {
                 if (s.end()-it > 6 && *(it+1) == 'U' && *(it+2) == '+')  {
@@ -353,34 +392,28 @@ std::string DRW_ConvDBCSTable::toUtf8(const std::string &s) {
             } else
                 res +=c; //c!='\' ascii char write
         } else if(c == 0x80 ){//1 byte table
-            notFound = false;
-            res += encodeNum(0x20AC);//euro sign
+            appendNum(res, 0x20AC);//euro sign
         } else {//2 bytes
-            ++it;
-            int code = (c << 8) | static_cast<unsigned char >(*it);
-            int sta = leadTable[c-0x81];
-            int end = leadTable[c-0x80];
-            for (int k=sta; k<end; k++){
-                if(doubleTable[k][0] == code) {
-                    res += encodeNum(doubleTable[k][1]); //translate from table
-                    notFound = false;
-                    break;
-                }
-            }
+            int code = c << 8;
+            if (s.end()-it > 1)
+                code |= static_cast<unsigned char>(*++it);
+            int unicode = dbcs.toUnicode[code];
+            appendNum(res, unicode != 0 ? unicode : NOTFOUND936); //translate from table
         }
-        //not found
-        if (notFound) res += encodeNum(NOTFOUND936);
     } //end for
 
     return res;
 }
 
 DRW_Conv932Table::DRW_Conv932Table()
-    :DRW_Converter(DRW_Table932, CPLENGTH932) {
+    :DRW_Converter(DRW_Table932, CPLENGTH932)
+    ,lookup{DRW_DBCSLookup::get(DRW_DoubleTable932, CPLENGTH932)} {
 }
 
 std::string DRW_Conv932Table::fromUtf8(const std::string &s) {
+    const DRW_DBCSLookup &dbcs = lookup;
     std::string result;
+    result.reserve(s.length());
     bool notFound;
     int code;
 
@@ -388,10 +421,9 @@ std::string DRW_Conv932Table::fromUtf8(const std::string &s) {
     for (unsigned int i=0; i < s.length(); i++) {
         unsigned char c = s.at(i);
         if (c > 0x7F) { //need to decode
-            result += s.substr(j,i-j);
-            std::string part1 = s.substr(i,4);
-            int l;
-            code = decodeNum(part1, &l);
+            result.append(s, j, i-j);
+            int l = 1;
+            code = decodeNum(s.substr(i,4), &l);
             j = i+l;
             i = j - 1;
             notFound = true;
@@ -401,36 +433,30 @@ std::string DRW_Conv932Table::fromUtf8(const std::string &s) {
                 notFound = false;
             }
             if (notFound && ( code<0xF8 || (code>0x390 && code<0x542) ||
-                    (code>0x200F && code<0x9FA1) || code>0xF928 )) {
-                for (int k=0; k<cpLength; k++){
-                    if(DRW_DoubleTable932[k][1] == code) {
-                        int data = DRW_DoubleTable932[k][0];
-                        char d[3];
-                        d[0] = data >> 8;
-                        d[1] = data & 0xFF;
-                        d[2]= '\0';
-                        result += d; //translate from table
-                        notFound = false;
-                        break;
-                    }
+                    (code>0x200F && code<0x9FA1) || (code>0xF928 && code<0x10000) )) {
+                int data = dbcs.fromUnicode[code];
+                if (data != 0) { //translate from table
+                    result += static_cast<char>(data >> 8);
+                    result += static_cast<char>(data & 0xFF);
+                    notFound = false;
                 }
             }
             if (notFound)
                 result += decodeText(code);
         } //direct conversion
     }
-    result += s.substr(j);
+    result.append(s, j, std::string::npos);
 
     return result;
 }
 
 std::string DRW_Conv932Table::toUtf8(const std::string &s) {
+    const DRW_DBCSLookup &dbcs = lookup;
     std::string res;
+    res.reserve(s.length());
     for (auto it=s.begin() ; it < s.end(); ++it ) {
-        bool notFound = true;
         unsigned char c = *it;
         if (c < 0x80) {
-            notFound = false;
             //check for \U+ encoded text
             if (c == '\\') {
                 if (s.end()-it > 6 && *(it+1) == 'U' && *(it+2) == '+')  {
@@ -442,32 +468,14 @@ std::string DRW_Conv932Table::toUtf8(const std::string &s) {
             } else
                 res +=c; //c!='\' ascii char write
         } else if(c > 0xA0 && c < 0xE0 ){//1 byte table
-            notFound = false;
-            res += encodeNum(c + CPOFFSET932); //translate from table
+            appendNum(res, c + CPOFFSET932); //translate from table
         } else {//2 bytes
-            ++it;
-            int code = (c << 8) | static_cast<unsigned char>(*it);
-            int sta=0;
-            int end=0;
-            if (c > 0x80 && c < 0xA0) {
-                sta = DRW_LeadTable932[c-0x81];
-                end = DRW_LeadTable932[c-0x80];
-            } else if (c > 0xDF && c < 0xFD){
-                sta = DRW_LeadTable932[c-0xC1];
-                end = DRW_LeadTable932[c-0xC0];
-            }
-            if (end > 0) {
-                for (int k=sta; k<end; k++){
-                    if(DRW_DoubleTable932[k][0] == code) {
-                        res += encodeNum(DRW_DoubleTable932[k][1]); //translate from table
-                        notFound = false;
-                        break;
-                    }
-                }
-            }
+            int code = c << 8;
+            if (s.end()-it > 1)
+                code |= static_cast<unsigned char>(*++it);
+            int unicode = dbcs.toUnicode[code];
+            appendNum(res, unicode != 0 ? unicode : NOTFOUND932); //translate from table
         }
-        //not found
-        if (notFound) res += encodeNum(NOTFOUND932);
     } //end for
 
     return res;
@@ -485,7 +493,7 @@ std::string DRW_ConvUTF16::toUtf8(const std::string &s){//RLZ: pending to write
         unsigned char c1 = *it;
         unsigned char c2 = *(++it);
         duint16 ch = (c2 <<8) | c1;
-        res +=encodeNum(ch);
+        appendNum(res, ch);
     } //end for
 
     return res;
@@ -6,6 +6,7 @@
 #include "../drw_base.h"
 
 class DRW_Converter;
+struct DRW_DBCSLookup;
 
 class DRW_TextCodec
 {
@@ -42,6 +43,8 @@ public:
     std::string encodeText(const std::string& stmp);
     std::string decodeText(int c);
     std::string encodeNum(int c);
+    /** appends code point 'c' encoded in UTF-8 to 'res' */
+    static void appendNum(std::string &res, int c);
     int decodeNum(const std::string& s, int *b);
     const int *table{nullptr};
     int cpLength;
@@ -63,18 +66,13 @@ public:
 
 class DRW_ConvDBCSTable : public DRW_Converter {
 public:
-    DRW_ConvDBCSTable(const int *t,  const int *lt, const int dt[][2], int l)
-        :DRW_Converter(t, l)
-        ,leadTable{lt}
-        ,doubleTable{dt}
-    {}
+    DRW_ConvDBCSTable(const int *t, const int dt[][2], int l);
 
     std::string fromUtf8(const std::string &s) override;
     std::string toUtf8(const std::string &s) override;
 private:
-    const int *leadTable{nullptr};
     const int (*doubleTable)[2];
-
+    const DRW_DBCSLookup &lookup;
 };
 
 class DRW_Conv932Table : public DRW_Converter {
@@ -82,7 +80,8 @@ public:
     DRW_Conv932Table();
     std::string fromUtf8(const std::string &s) override;
     std::string toUtf8(const std::string &s) override;
-
+private:
+    const DRW_DBCSLookup &lookup;
 };
 
 #endif // DRW_TEXTCODEC_H
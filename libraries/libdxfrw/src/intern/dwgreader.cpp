@@ -10,11 +10,17 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdlib>
+#include <exception>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <vector>
 #include "dwgreader.h"
 #include "drw_textcodec.h"
 #include "drw_dbg.h"
@@ -913,6 +919,12 @@ bool dwgReader::readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf){
     bool ret = true;
 
     DRW_DBG("\nobject map total size= "); DRW_DBG(ObjectMap.size());
+    //2004+ entities are read from the decompressed data in memory, so they can be decoded
+    //concurrently; not with debug output, it is not thread safe
+    unsigned threads = decodingThreads > 0 ? decodingThreads : std::max(1u, std::thread::hardware_concurrency());
+    if (threads > 1 && version >= DRW::AC1018 && DRW_DBGGL != DRW_dbg::Level::Debug) {
+        return readDwgEntitiesConcurrent(intfa, dbuf, threads);
+    }
     auto itB=ObjectMap.begin();
     auto itE=ObjectMap.end();
     while (itB != itE) {
@@ -926,19 +938,157 @@ bool dwgReader::readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf){
     return ret;
 }
 
+/**
+ * Reads the entities of ObjectMap with one set of 'threads' - 1 worker threads kept for the
+ * whole read: workers decode entities ahead, each with its own copy of 'dbuf', into a window
+ * of slots; this thread sends them to the interface in the order of readDwgEntities(), with
+ * the same results.
+ */
+bool dwgReader::readDwgEntitiesConcurrent(DRW_Interface& intfa, dwgBuffer *dbuf, unsigned threads){
+    struct DecodedEntity {
+        std::unique_ptr<DRW_Entity> entity;
+        bool ret{true};
+        std::exception_ptr exception;
+        bool decoded{false};
+    };
+    bool ret = true;
+
+    //order of reading, erasing from ObjectMap doesn't change the order of the remaining objects;
+    //workers only use this copy, ObjectMap is changed by this thread when reading polylines
+    std::vector<objHandle> objects;
+    objects.reserve(ObjectMap.size());
+    for (const auto& it: ObjectMap)
+        objects.push_back(it.second);
+    const size_t count = objects.size();
+    if (count == 0)
+        return ret;
+
+    //entities decoded ahead of the sent ones are limited to the window
+    const size_t window = std::min<size_t>(4096, count);
+    std::vector<DecodedEntity> slots(window);
+    std::mutex mutex;
+    std::condition_variable decodedCv;
+    std::condition_variable sentCv;
+    size_t next = 0;
+    size_t sent = 0;
+    bool stop = false;
+
+    auto decode = [&, dbuf]() {
+        dwgBuffer buff(*dbuf);
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            sentCv.wait(lock, [&]{ return stop || next >= count || next < sent + window; });
+            if (stop || next >= count)
+                return;
+            size_t i = next++;
+            objHandle obj = objects[i];
+            lock.unlock();
+            DecodedEntity d;
+            try {
+                d.entity = decodeDwgEntity(&buff, obj, d.ret);
+            } catch (...) {
+                d.exception = std::current_exception();
+            }
+            d.decoded = true;
+            lock.lock();
+            objects[i].type = obj.type;
+            slots[i % window] = std::move(d);
+            decodedCv.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < std::max(2u, threads) && t <= count; ++t)
+        workers.emplace_back(decode);
+
+    std::exception_ptr exception;
+    //workers are joined before any exception leaves this function
+    try {
+        for (size_t i = 0; i < count; ++i) {
+            DecodedEntity d;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                DecodedEntity &slot = slots[i % window];
+                decodedCv.wait(lock, [&slot]{ return slot.decoded; });
+                d = std::move(slot);
+                slot.decoded = false;
+                sent = i + 1;
+            }
+            sentCv.notify_all();
+
+            objHandle &obj = objects[i];
+            auto it = ObjectMap.find(obj.handle);
+            if (it == ObjectMap.end()) //already read, as a vertex of a polyline
+                continue;
+            ObjectMap.erase(it);
+            if (d.exception) {
+                exception = d.exception;
+                break;
+            }
+            if (!d.ret) {
+                // once an entity failed, just clear the ObjectMap
+                ret = false;
+                break;
+            }
+            if (d.entity) {
+                nextEntLink = d.entity->nextEntLink;
+                prevEntLink = d.entity->prevEntLink;
+                sendDwgEntity(d.entity.get(), obj.type, dbuf, intfa);
+            } else //not supported or are object add to remaining map
+                objObjectMap[obj.handle]= obj;
+        }
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    sentCv.notify_all();
+    for (auto& worker: workers)
+        worker.join();
+    ObjectMap.clear();
+    if (exception)
+        std::rethrow_exception(exception);
+    return ret;
+}
+
 /**
  * Reads a dwg drawing entity (dwg object entity) given its offset in the file
  */
 bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa){
     bool ret = true;
-    duint32 bs = 0;
 
     nextEntLink = prevEntLink = 0;// set to 0 to skip unimplemented entities
+    std::unique_ptr<DRW_Entity> e = decodeDwgEntity(dbuf, obj, ret);
+    if (e) {
+        nextEntLink = e->nextEntLink;
+        prevEntLink = e->prevEntLink;
+        sendDwgEntity(e.get(), obj.type, dbuf, intfa);
+    } else if (ret) {
+        //not supported or are object add to remaining map
+        objObjectMap[obj.handle]= obj;
+    }
+
+    return ret;
+}
+
+/**
+ * Decodes a dwg drawing entity given its offset in 'dbuf' and sets the type of 'obj'.
+ * Only reads the reader's tables, so entities may be decoded concurrently, each thread
+ * with its own 'dbuf'.
+ * @return the entity; nullptr if decoding failed ('ret' is false) or the object isn't
+ * a supported entity ('ret' is true)
+ */
+std::unique_ptr<DRW_Entity> dwgReader::decodeDwgEntity(dwgBuffer *dbuf, objHandle& obj, bool &ret){
+    duint32 bs = 0;
+
+    ret = true;
     dbuf->setPosition(obj.loc);
     //verify if position is ok:
     if (!dbuf->isGood()){
         DRW_DBG(" Warning: readDwgEntity, bad location\n");
-        return false;
+        ret = false;
+        return nullptr;
     }
     int size = dbuf->getModularShort();
     if (version > DRW::AC1021) {//2010+
@@ -949,7 +1099,8 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
     //verify if getBytes is ok:
     if (!dbuf->isGood()) {
         DRW_DBG(" Warning: readDwgEntity, bad size\n");
-        return false;
+        ret = false;
+        return nullptr;
     }
     dwgBuffer buff(tmpByteStr.data(), size, &decoder);
     dint16 oType = buff.getObjType(version);
@@ -959,7 +1110,8 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
         auto it = classesmap.find(oType);
         if (it == classesmap.end()){//fail, not found in classes set error
             DRW_DBG("Class "); DRW_DBG(oType);DRW_DBG("not found, handle: "); DRW_DBG(obj.handle); DRW_DBG("\n");
-            return false;
+            ret = false;
+            return nullptr;
         } else {
             DRW_Class *cl = it->second;
             if (cl->dwgType != 0)
@@ -968,201 +1120,217 @@ bool dwgReader::readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& in
     }
 
     obj.type = oType;
+    std::unique_ptr<DRW_Entity> ent;
     switch (oType) {
-        case 17: {
-            DRW_Arc e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addArc(e);
-            }
-            break; }
-        case 18: {
-            DRW_Circle e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addCircle(e);
-            }
-            break; }
-        case 19:{
-            DRW_Line e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addLine(e);
-            }
-            break;}
-        case 27: {
-            DRW_Point e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addPoint(e);
-            }
-            break; }
-        case 35: {
-            DRW_Ellipse e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addEllipse(e);
-            }
-            break; }
+        case 17:
+            ent = entryParse<DRW_Arc>(buff, bs, ret);
+            break;
+        case 18:
+            ent = entryParse<DRW_Circle>(buff, bs, ret);
+            break;
+        case 19:
+            ent = entryParse<DRW_Line>(buff, bs, ret);
+            break;
+        case 27:
+            ent = entryParse<DRW_Point>(buff, bs, ret);
+            break;
+        case 35:
+            ent = entryParse<DRW_Ellipse>(buff, bs, ret);
+            break;
         case 7:
         case 8: {//minsert = 8
-            DRW_Insert e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.name = findTableName(DRW::BLOCK_RECORD,
-                                       e.blockRecH.ref);//RLZ: find as block or blockrecord (ps & ps0)
-                intfa.addInsert(e);
-            }
-            break; }
-        case 77: {
-            DRW_LWPolyline e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addLWPolyline(e);
+            auto e = entryParse<DRW_Insert>(buff, bs, ret);
+            if (e) {
+                e->name = findTableName(DRW::BLOCK_RECORD,
+                                        e->blockRecH.ref);//RLZ: find as block or blockrecord (ps & ps0)
             }
+            ent = std::move(e);
             break; }
+        case 77:
+            ent = entryParse<DRW_LWPolyline>(buff, bs, ret);
+            break;
         case 1: {
-            DRW_Text e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::STYLE, e.styleH.ref);
-                intfa.addText(e);
+            auto e = entryParse<DRW_Text>(buff, bs, ret);
+            if (e) {
+                e->style = findTableName(DRW::STYLE, e->styleH.ref);
             }
+            ent = std::move(e);
             break; }
         case 44: {
-            DRW_MText e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::STYLE, e.styleH.ref);
-                intfa.addMText(e);
-            }
-            break; }
-        case 28: {
-            DRW_3Dface e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.add3dFace(e);
-            }
-            break; }
-        case 20: {
-            DRW_DimOrdinate e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimOrdinate(&e);
-            }
-            break; }
-        case 21: {
-            DRW_DimLinear e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimLinear(&e);
-            }
-            break; }
-        case 22: {
-            DRW_DimAligned e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimAlign(&e);
-            }
-            break; }
-        case 23: {
-            DRW_DimAngular3p e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimAngular3P(&e);
-            }
-            break; }
-        case 24: {
-            DRW_DimAngular e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimAngular(&e);
-            }
-            break; }
-        case 25: {
-            DRW_DimRadial e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimRadial(&e);
-            }
-            break; }
-        case 26: {
-            DRW_DimDiametric e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addDimDiametric(&e);
-            }
-            break; }
-        case 45: {
-            DRW_Leader e;
-            if (entryParse( e, buff, bs, ret)) {
-                e.style = findTableName(DRW::DIMSTYLE, e.dimStyleH.ref);
-                intfa.addLeader(&e);
-            }
-            break; }
-        case 31: {
-            DRW_Solid e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addSolid(e);
-            }
-            break; }
-        case 78: {
-            DRW_Hatch e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addHatch(&e);
-            }
-            break; }
-        case 32: {
-            DRW_Trace e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addTrace(e);
-            }
-            break; }
-        case 34: {
-            DRW_Viewport e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addViewport(e);
-            }
-            break; }
-        case 36: {
-            DRW_Spline e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addSpline(&e);
-            }
-            break; }
-        case 40: {
-            DRW_Ray e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addRay(e);
+            auto e = entryParse<DRW_MText>(buff, bs, ret);
+            if (e) {
+                e->style = findTableName(DRW::STYLE, e->styleH.ref);
             }
+            ent = std::move(e);
             break; }
+        case 28:
+            ent = entryParse<DRW_3Dface>(buff, bs, ret);
+            break;
+        case 20:
+            ent = dimensionParse<DRW_DimOrdinate>(buff, bs, ret);
+            break;
+        case 21:
+            ent = dimensionParse<DRW_DimLinear>(buff, bs, ret);
+            break;
+        case 22:
+            ent = dimensionParse<DRW_DimAligned>(buff, bs, ret);
+            break;
+        case 23:
+            ent = dimensionParse<DRW_DimAngular3p>(buff, bs, ret);
+            break;
+        case 24:
+            ent = dimensionParse<DRW_DimAngular>(buff, bs, ret);
+            break;
+        case 25:
+            ent = dimensionParse<DRW_DimRadial>(buff, bs, ret);
+            break;
+        case 26:
+            ent = dimensionParse<DRW_DimDiametric>(buff, bs, ret);
+            break;
+        case 45:
+            ent = dimensionParse<DRW_Leader>(buff, bs, ret);
+            break;
+        case 31:
+            ent = entryParse<DRW_Solid>(buff, bs, ret);
+            break;
+        case 78:
+            ent = entryParse<DRW_Hatch>(buff, bs, ret);
+            break;
+        case 32:
+            ent = entryParse<DRW_Trace>(buff, bs, ret);
+            break;
+        case 34:
+            ent = entryParse<DRW_Viewport>(buff, bs, ret);
+            break;
+        case 36:
+            ent = entryParse<DRW_Spline>(buff, bs, ret);
+            break;
+        case 40:
+            ent = entryParse<DRW_Ray>(buff, bs, ret);
+            break;
         case 15:    // pline 2D
         case 16:    // pline 3D
-        case 29: {  // pline PFACE
-            DRW_Polyline e;
-            if (entryParse( e, buff, bs, ret)) {
-                readPlineVertex(e, dbuf);
-                intfa.addPolyline(e);
-            }
-            break; }
+        case 29:    // pline PFACE
+            ent = entryParse<DRW_Polyline>(buff, bs, ret);
+            break;
 //        case 30: {
 //            DRW_Polyline e;// MESH (not pline)
 //            ENTRY_PARSE(e)
 //            intfa.addRay(e);
 //            break; }
-        case 41: {
-            DRW_Xline e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addXline(e);
-            }
-            break; }
-        case 101: {
-            DRW_Image e;
-            if (entryParse( e, buff, bs, ret)) {
-                intfa.addImage(&e);
-            }
-            break; }
+        case 41:
+            ent = entryParse<DRW_Xline>(buff, bs, ret);
+            break;
+        case 101:
+            ent = entryParse<DRW_Image>(buff, bs, ret);
+            break;
 
         default:
-            //not supported or are object add to remaining map
-            objObjectMap[obj.handle]= obj;
+            //not supported or are object
             break;
     }
     if (!ret){
         DRW_DBG("Warning: Entity type "); DRW_DBG(oType);DRW_DBG("has failed, handle: "); DRW_DBG(obj.handle); DRW_DBG("\n");
     }
 
-    return ret;
+    return ent;
+}
+
+/**
+ * Sends an entity decoded by decodeDwgEntity() to the interface, 'type' is the type of
+ * its object. Vertices of polylines are read from 'dbuf'.
+ */
+void dwgReader::sendDwgEntity(DRW_Entity *e, duint32 type, dwgBuffer *dbuf, DRW_Interface& intfa){
+    switch (type) {
+        case 17:
+            intfa.addArc(*static_cast<DRW_Arc*>(e));
+            break;
+        case 18:
+            intfa.addCircle(*static_cast<DRW_Circle*>(e));
+            break;
+        case 19:
+            intfa.addLine(*static_cast<DRW_Line*>(e));
+            break;
+        case 27:
+            intfa.addPoint(*static_cast<DRW_Point*>(e));
+            break;
+        case 35:
+            intfa.addEllipse(*static_cast<DRW_Ellipse*>(e));
+            break;
+        case 7:
+        case 8://minsert = 8
+            intfa.addInsert(*static_cast<DRW_Insert*>(e));
+            break;
+        case 77:
+            intfa.addLWPolyline(*static_cast<DRW_LWPolyline*>(e));
+            break;
+        case 1:
+            intfa.addText(*static_cast<DRW_Text*>(e));
+            break;
+        case 44:
+            intfa.addMText(*static_cast<DRW_MText*>(e));
+            break;
+        case 28:
+            intfa.add3dFace(*static_cast<DRW_3Dface*>(e));
+            break;
+        case 20:
+            intfa.addDimOrdinate(static_cast<DRW_DimOrdinate*>(e));
+            break;
+        case 21:
+            intfa.addDimLinear(static_cast<DRW_DimLinear*>(e));
+            break;
+        case 22:
+            intfa.addDimAlign(static_cast<DRW_DimAligned*>(e));
+            break;
+        case 23:
+            intfa.addDimAngular3P(static_cast<DRW_DimAngular3p*>(e));
+            break;
+        case 24:
+            intfa.addDimAngular(static_cast<DRW_DimAngular*>(e));
+            break;
+        case 25:
+            intfa.addDimRadial(static_cast<DRW_DimRadial*>(e));
+            break;
+        case 26:
+            intfa.addDimDiametric(static_cast<DRW_DimDiametric*>(e));
+            break;
+        case 45:
+            intfa.addLeader(static_cast<DRW_Leader*>(e));
+            break;
+        case 31:
+            intfa.addSolid(*static_cast<DRW_Solid*>(e));
+            break;
+        case 78:
+            intfa.addHatch(static_cast<DRW_Hatch*>(e));
+            break;
+        case 32:
+            intfa.addTrace(*static_cast<DRW_Trace*>(e));
+            break;
+        case 34:
+            intfa.addViewport(*static_cast<DRW_Viewport*>(e));
+            break;
+        case 36:
+            intfa.addSpline(static_cast<DRW_Spline*>(e));
+            break;
+        case 40:
+            intfa.addRay(*static_cast<DRW_Ray*>(e));
+            break;
+        case 15:    // pline 2D
+        case 16:    // pline 3D
+        case 29: {  // pline PFACE
+            auto pline = static_cast<DRW_Polyline*>(e);
+            readPlineVertex(*pline, dbuf);
+            intfa.addPolyline(*pline);
+            break; }
+        case 41:
+            intfa.addXline(*static_cast<DRW_Xline*>(e));
+            break;
+        case 101:
+            intfa.addImage(static_cast<DRW_Image*>(e));
+            break;
+        default:
+            break;
+    }
 }
 
 bool dwgReader::readDwgObjects(DRW_Interface& intfa, dwgBuffer *dbuf){
@@ -140,6 +140,8 @@ protected:
     virtual bool readDwgObjects(DRW_Interface& intfa) = 0;
 
     virtual bool readDwgEntity(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa);
+    std::unique_ptr<DRW_Entity> decodeDwgEntity(dwgBuffer *dbuf, objHandle& obj, bool &ret);
+    void sendDwgEntity(DRW_Entity *e, duint32 type, dwgBuffer *dbuf, DRW_Interface& intfa);
     bool readDwgObject(dwgBuffer *dbuf, objHandle& obj, DRW_Interface& intfa);
     void parseAttribs(DRW_Entity* e);
     std::string findTableName(DRW::TTYPE table, dint32 handle);
@@ -153,6 +155,7 @@ protected:
 
     bool readDwgBlocks(DRW_Interface& intfa, dwgBuffer *dbuf);
     bool readDwgEntities(DRW_Interface& intfa, dwgBuffer *dbuf);
+    bool readDwgEntitiesConcurrent(DRW_Interface& intfa, dwgBuffer *dbuf, unsigned threads);
     bool readDwgObjects(DRW_Interface& intfa, dwgBuffer *dbuf);
     bool readPlineVertex(DRW_Polyline& pline, dwgBuffer *dbuf);
 
@@ -170,6 +173,8 @@ public:
     std::unordered_map<duint32, DRW_AppId*> appIdmap;
 //    duint32 currBlock;
     duint8 maintenanceVersion{0};
+    //number of threads decoding entities of 2004+ files, 0 = number of cores, 1 = sequential
+    unsigned decodingThreads{1};
 
 protected:
     std::unique_ptr<dwgBuffer> fileBuf;
@@ -193,15 +198,21 @@ protected:
 
 private:
     template <class T>
-    bool entryParse(T &e, dwgBuffer &buff, duint32 bs, bool &ret) {
-        ret = e.parseDwg( version, &buff, bs);
-        if (ret) {
-            parseAttribs(&e);
-            nextEntLink = e.nextEntLink;
-            prevEntLink = e.prevEntLink;
-        }
-
-        return ret;
+    std::unique_ptr<T> entryParse(dwgBuffer &buff, duint32 bs, bool &ret) {
+        std::unique_ptr<T> e{new T};
+        ret = e->parseDwg( version, &buff, bs);
+        if (!ret)
+            return nullptr;
+        parseAttribs(e.get());
+        return e;
+    }
+
+    template <class T>
+    std::unique_ptr<T> dimensionParse(dwgBuffer &buff, duint32 bs, bool &ret) {
+        std::unique_ptr<T> e = entryParse<T>(buff, bs, ret);
+        if (e)
+            e->style = findTableName(DRW::DIMSTYLE, e->dimStyleH.ref);
+        return e;
     }
 
 };
@@ -10,7 +10,9 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <charconv>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -18,6 +20,22 @@
 #include "drw_textcodec.h"
 #include "drw_dbg.h"
 
+namespace {
+//size of the blocks read from ascii dxf files, grows for longer lines
+constexpr size_t asciiBufferSize = 256 * 1024;
+
+//skips leading blanks and a plus sign, as atoi() and strtod() do
+const char *skipBlanks(std::string_view text) {
+    const char *first = text.data();
+    const char *last = first + text.size();
+    while (first != last && (*first == ' ' || *first == '\t'))
+        ++first;
+    if (first != last && *first == '+')
+        ++first;
+    return first;
+}
+}
+
 bool dxfReader::readRec(int *codeData) {
 //    std::string text;
     int code;
@@ -95,7 +113,7 @@ bool dxfReader::readRec(int *codeData) {
         //break in binary files because the conduct is unpredictable
         return false;
 
-    return (filestr->good());
+    return isGood();
 }
 int dxfReader::getHandleString(){
     int res;
@@ -204,28 +222,81 @@ bool dxfReaderBinary::readBool() {
     return (filestr->good());
 }
 
+dxfReaderAscii::dxfReaderAscii(std::ifstream *stream):
+    dxfReader(stream),
+    buffer(asciiBufferSize) {
+    skip = true;
+}
+
+bool dxfReaderAscii::fillBuffer() {
+    if (!filestr->good())
+        return false;
+    //keep the unscanned part of the current line
+    size_t pending = bufferEnd - bufferPos;
+    if (bufferPos > 0) {
+        std::memmove(buffer.data(), buffer.data() + bufferPos, pending);
+        bufferPos = 0;
+        bufferEnd = pending;
+    }
+    if (bufferEnd == buffer.size())
+        buffer.resize(buffer.size() * 2);
+    filestr->read(buffer.data() + bufferEnd, buffer.size() - bufferEnd);
+    size_t count = static_cast<size_t>(filestr->gcount());
+    bufferEnd += count;
+    return count > 0;
+}
+
+//same results as std::getline(), but without copying the line
+bool dxfReaderAscii::readLine() {
+    size_t scanPos = bufferPos;
+    const void *lineBreak = nullptr;
+    while ((lineBreak = std::memchr(buffer.data() + scanPos, '\n', bufferEnd - scanPos)) == nullptr) {
+        size_t scanned = bufferEnd - bufferPos;
+        if (!fillBuffer()) {
+            //last line without line break, or nothing left to read
+            line = std::string_view(buffer.data() + bufferPos, bufferEnd - bufferPos);
+            bufferPos = bufferEnd;
+            good = false;
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            return false;
+        }
+        scanPos = bufferPos + scanned;
+    }
+    size_t lineEnd = static_cast<const char *>(lineBreak) - buffer.data();
+    line = std::string_view(buffer.data() + bufferPos, lineEnd - bufferPos);
+    bufferPos = lineEnd + 1;
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    return good;
+}
+
+int dxfReaderAscii::lineToInt() const {
+    int value = 0;
+    if (std::from_chars(skipBlanks(line), line.data() + line.size(), value).ec != std::errc())
+        return 0;
+    return value;
+}
+
 bool dxfReaderAscii::readCode(int *code) {
-    std::string text;
-    std::getline(*filestr, text);
-    *code = atoi(text.c_str());
+    readLine();
+    *code = lineToInt();
     DRW_DBG(*code); DRW_DBG("\n");
-    return (filestr->good());
+    return good;
 }
 bool dxfReaderAscii::readString(std::string *text) {
     type = STRING;
-    std::getline(*filestr, *text);
-    if (!text->empty() && text->at(text->size()-1) == '\r')
-        text->erase(text->size()-1);
-    return (filestr->good());
+    readLine();
+    text->assign(line);
+    return good;
 }
 
 bool dxfReaderAscii::readString() {
     type = STRING;
-    std::getline(*filestr, strData);
-    if (!strData.empty() && strData.at(strData.size()-1) == '\r')
-        strData.erase(strData.size()-1);
+    readLine();
+    strData.assign(line);
     DRW_DBG(strData); DRW_DBG("\n");
-    return (filestr->good());
+    return good;
 }
 
 bool dxfReaderAscii::readBinary() {
@@ -234,9 +305,8 @@ bool dxfReaderAscii::readBinary() {
 
 bool dxfReaderAscii::readInt16() {
     type = INT32;
-    std::string text;
-    if (readString(&text)){
-        intData = atoi(text.c_str());
+    if (readLine()){
+        intData = lineToInt();
         DRW_DBG(intData); DRW_DBG("\n");
         return true;
     } else
@@ -255,9 +325,14 @@ bool dxfReaderAscii::readInt64() {
 
 bool dxfReaderAscii::readDouble() {
     type = DOUBLE;
-    std::string text;
-    if (readString(&text)){
-#if defined(__APPLE__)
+    if (readLine()){
+#if defined(__cpp_lib_to_chars)
+        // invalid or out of range values are read as 0, like lineToInt() does
+        if (std::from_chars(skipBlanks(line), line.data() + line.size(), doubleData).ec != std::errc())
+            doubleData = 0.0;
+        DRW_DBG(doubleData); DRW_DBG('\n');
+#elif defined(__APPLE__)
+        std::string text(line);
         int succeeded=sscanf( & (text[0]), "%lg", &doubleData);
         if(succeeded != 1) {
             DRW_DBG("dxfReaderAscii::readDouble(): reading double error: ");
@@ -265,7 +340,7 @@ bool dxfReaderAscii::readDouble() {
             DRW_DBG('\n');
         }
 #else
-        std::istringstream sd(text);
+        std::istringstream sd{std::string(line)};
         sd >> doubleData;
         DRW_DBG(doubleData); DRW_DBG('\n');
 #endif
@@ -277,12 +352,10 @@ bool dxfReaderAscii::readDouble() {
 //saved as int or add a bool member??
 bool dxfReaderAscii::readBool() {
     type = BOOL;
-    std::string text;
-    if (readString(&text)){
-        intData = atoi(text.c_str());
+    if (readLine()){
+        intData = lineToInt();
         DRW_DBG(intData); DRW_DBG("\n");
         return true;
     } else
         return false;
 }
-
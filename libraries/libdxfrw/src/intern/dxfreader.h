@@ -13,6 +13,9 @@
 #ifndef DXFREADER_H
 #define DXFREADER_H
 
+#include <fstream>
+#include <string_view>
+#include <vector>
 #include "drw_textcodec.h"
 
 class dxfReader {
@@ -58,6 +61,8 @@ protected:
     virtual bool readInt64() = 0;
     virtual bool readDouble() = 0;
     virtual bool readBool() = 0;
+    //state of the stream after the last read record
+    virtual bool isGood() const {return filestr->good();}
 
 protected:
     std::ifstream *filestr;
@@ -85,9 +90,13 @@ public:
     bool readBool() override;
 };
 
+/**
+ * Reader of ascii dxf files. The stream is read by large blocks, and lines are
+ * scanned in place in the buffer, numbers are parsed directly from the buffer.
+ */
 class dxfReaderAscii : public dxfReader {
 public:
-    dxfReaderAscii(std::ifstream *stream):dxfReader(stream){skip = true; }
+    dxfReaderAscii(std::ifstream *stream);
     bool readCode(int *code) override;
     bool readString(std::string *text) override;
     bool readString() override;
@@ -97,6 +106,21 @@ public:
     bool readInt32() override;
     bool readInt64() override;
     bool readBool() override;
+    bool isGood() const override {return good;}
+
+private:
+    //scans the next line, without the line break, to line
+    bool readLine();
+    //refills the buffer keeping unscanned data, false if no more data
+    bool fillBuffer();
+    int lineToInt() const;
+
+    std::vector<char> buffer;
+    size_t bufferPos {0};
+    size_t bufferEnd {0};
+    std::string_view line;
+    //false when the last line read failed or was terminated by the end of file
+    bool good {true};
 };
 
 #endif // DXFREADER_H
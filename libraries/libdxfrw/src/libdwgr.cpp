@@ -261,6 +261,7 @@ bool dwgR::openFile(std::ifstream *filestr){
 
 bool dwgR::processDwg() {
     DRW_DBG("dwgR::processDwg() start processing dwg\n");
+    reader->decodingThreads = decodingThreads;
     bool ret;
     bool ret2;
     DRW_Header hdr;
@@ -35,6 +35,8 @@ public:
     DRW::error getError(){return error;}
 bool testReader();
     void setDebug(DRW::DebugLevel lvl);
+    /** number of threads decoding entities of 2004+ files, 0 = number of cores, 1 = sequential (default) */
+    void setDecodingThreads(unsigned threads){decodingThreads = threads;}
 
 private:
     bool openFile(std::ifstream *filestr);
@@ -49,6 +51,7 @@ private:
     std::string codePage;
     DRW_Interface *iface { nullptr };
     std::unique_ptr< dwgReader > reader;
+    unsigned decodingThreads { 1 };
 
 };
 
@@ -730,6 +730,9 @@ bool dxfRW::writePoint(DRW_Point *ent) {
     if (ent->basePoint.z != 0.0) {
         writer->writeDouble(30, ent->basePoint.z);
     }
+    if (!ent->extData.empty()) {
+        writeExtData(ent->extData);
+    }
     return true;
 }
 
@@ -2021,6 +2024,15 @@ bool dxfRW::writeExtData(const std::vector<DRW_Variant*> &ed){
     return true;
 }
 
+bool dxfRW::writeExtData(const std::vector<std::shared_ptr<DRW_Variant>> &ed){
+    std::vector<DRW_Variant*> variants;
+    variants.reserve(ed.size());
+    for (const auto &v: ed) {
+        variants.push_back(v.get());
+    }
+    return writeExtData(variants);
+}
+
 /********* Reader Process *********/
 
 bool dxfRW::processDxf() {
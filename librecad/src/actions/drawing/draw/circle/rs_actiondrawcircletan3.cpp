@@ -20,6 +20,8 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 **********************************************************************/
 
+#include <cassert>
+
 #include "rs_actiondrawcircletan3.h"
 
 #include "lc_quadratic.h"
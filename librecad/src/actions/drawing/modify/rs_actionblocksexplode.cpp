@@ -43,7 +43,8 @@ void RS_ActionBlocksExplode::doTrigger(bool keepSelected) {
 }
 
 bool RS_ActionBlocksExplode::isEntityAllowedToSelect(RS_Entity *ent) const {
-    return ent->isContainer();
+    // inserts drawn as instances of their blocks have no entities, but are exploded to the block entities
+    return ent->isContainer() || ent->rtti() == RS2::EntityInsert;
 }
 
 void RS_ActionBlocksExplode::updateMouseButtonHintsForSelection() {
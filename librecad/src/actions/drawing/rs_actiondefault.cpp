@@ -511,16 +511,21 @@ void RS_ActionDefault::onMouseMoveEvent([[maybe_unused]]int status, LC_MouseEven
 
 //            preview->addSelectionFrom(*container,viewport);
              // fixme - sand - iterating over all entities!!! Rework selection. Add selection manager to the document, after all...
-             for(auto ent: *m_container) {
-                if (ent->isSelected()) {
+            std::vector<RS_Entity*> selectedEntities;
+            m_container->collectSelected(selectedEntities, false);
+
+            const RS_Vector &offset = m_actionData->v2 - m_actionData->v1;
+            if (m_preview->isPreviewedTransformed(selectedEntities)) {
+                m_preview->addTransformed(selectedEntities, QTransform::fromTranslate(offset.x, offset.y));
+            }
+            else {
+                for (auto ent: selectedEntities) {
                     RS_Entity* clone = getClone(ent);
                     m_preview->addEntity(clone);
                 }
+                m_preview->move(offset);
             }
 
-            const RS_Vector &offset = m_actionData->v2 - m_actionData->v1;
-            m_preview->move(offset);
-
             auto *line = new RS_Line(m_actionData->v1, m_actionData->v2);
             m_preview->addEntity(line);
             if (m_showRefEntitiesOnPreview) {
@@ -658,6 +663,7 @@ void RS_ActionDefault::onMouseLeftButtonPress(int status, LC_MouseEvent *e) {
             data.offset = m_actionData->v2 - m_actionData->v1;
 
             m.move(data);
+            m_preview->resetTransformed();
             if (e->isControl) { // allow creation of several copies
                 m_actionData->v1 = m_actionData->v2;
             }
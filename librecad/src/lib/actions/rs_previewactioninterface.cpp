@@ -117,6 +117,8 @@ void RS_PreviewActionInterface::resume() {
 void RS_PreviewActionInterface::trigger() {
     RS_ActionInterface::trigger();
     deletePreview();
+    // entities previewed by transformation may be modified or deleted now
+    m_preview->resetTransformed();
     deleteInfoCursor();
     deleteHighlights();
     deleteSnapper();
@@ -26,6 +26,8 @@
 
 
 
+#include <cassert>
+
 #include <QFileInfo>
 
 #include "lc_quadratic.h"
@@ -29,11 +29,19 @@
 #include <QString>
 #include <QTextStream>
 #include <iostream>
+#include <mutex>
 
 #include "rs_vector.h"
 
 namespace {
 FILE *s_logStream = nullptr;
+
+// guards writes to the log stream, so lines printed by different threads aren't mixed;
+// never destroyed, as messages may be printed by static destructors
+std::mutex& logMutex() {
+    static auto* mutex = new std::mutex();
+    return *mutex;
+}
 }
 
 // The implementation to delegate methods to QTextStream
@@ -178,14 +186,11 @@ void debugHeader(char const *file, char const *func, int line) {
  * singleton class
  */
 RS_Debug *RS_Debug::instance() {
-    static RS_Debug *uniqueInstance = nullptr;
-    if (uniqueInstance == nullptr) {
-        QDateTime now = QDateTime::currentDateTime();
-        QString nowStr = now.toString("yyyyMMdd_hhmmss");
-
-        uniqueInstance = new RS_Debug;
+    // initialization of the static is thread safe
+    static RS_Debug *uniqueInstance = [] {
         s_logStream = stderr;
-    }
+        return new RS_Debug;
+    }();
     return uniqueInstance;
 }
 
@@ -235,6 +240,7 @@ RS_Debug::RS_DebugLevel RS_Debug::getLevel() { return m_debugLevel; }
  */
 void RS_Debug::print(const char *format...) {
     if (m_debugLevel == D_DEBUGGING) {
+        std::lock_guard<std::mutex> lock(logMutex());
         va_list ap;
         va_start(ap, format);
         vfprintf(s_logStream, format, ap);
@@ -253,6 +259,7 @@ void RS_Debug::print(const char *format...) {
 void RS_Debug::print(RS_DebugLevel level, const char *format...) {
 
     if (m_debugLevel >= level) {
+        std::lock_guard<std::mutex> lock(logMutex());
         va_list ap;
         va_start(ap, format);
         vfprintf(s_logStream, format, ap);
@@ -270,6 +277,7 @@ void RS_Debug::timestamp() {
     QString nowStr;
 
     nowStr = now.toString("yyyyMMdd_hh:mm:ss:zzz ");
+    std::lock_guard<std::mutex> lock(logMutex());
     fprintf(s_logStream, "%s", nowStr.toLatin1().data());
     fprintf(s_logStream, "\n");
     fflush(s_logStream);
@@ -290,6 +298,7 @@ void RS_Debug::printUnicode(const QString &text) {
  * Prints the unicode for every character in the given string.
  */
 void RS_Debug::print(const QString &text) {
+    std::lock_guard<std::mutex> lock(logMutex());
     std::cerr << text.toStdString() << std::endl;
 }
 
@@ -31,6 +31,8 @@
 #include <sys/_size_t.h>
 #endif
 
+#include <atomic>
+
 class RS_Vector;
 class QByteArray;
 class QChar;
@@ -55,6 +57,7 @@ void debugHeader(char const* file, char const* func, int line);
 
 /**
  * Debugging facilities.
+ * Messages may be printed by any thread, each message is printed as a whole line.
  *
  * @author Andrew Mustun
  */
@@ -146,7 +149,7 @@ public:
 private:
     RS_Debug();
 
-    RS_DebugLevel m_debugLevel = D_INFORMATIONAL;
+    std::atomic<RS_DebugLevel> m_debugLevel{D_INFORMATIONAL};
 };
 
 #endif
@@ -0,0 +1,168 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "lc_blockgeometry.h"
+
+#include "rs_arc.h"
+#include "rs_block.h"
+#include "rs_circle.h"
+#include "rs_debug.h"
+#include "rs_math.h"
+#include "rs_polyline.h"
+
+namespace {
+// maximum distance of arcs flattened for borders to the arcs, relative to the size of the block
+    constexpr double relativeFlatteningTolerance = 5e-4;
+
+    LC_BlockGeometry::Part& findPart(LC_BlockGeometry& geometry, const RS_Pen& pen, RS_Layer* layer) {
+        for (LC_BlockGeometry::Part& part: geometry.parts) {
+            if (part.layer == layer && part.pen == pen) {
+                return part;
+            }
+        }
+        geometry.parts.emplace_back();
+        geometry.parts.back().pen = pen;
+        geometry.parts.back().layer = layer;
+        return geometry.parts.back();
+    }
+
+    void addStroke(LC_BlockGeometry& geometry, LC_BlockGeometry::Part& part, std::vector<RS_Vector>&& points) {
+        for (const RS_Vector& p: points) {
+            part.minV = RS_Vector::minimum(part.minV, p);
+            part.maxV = RS_Vector::maximum(part.maxV, p);
+        }
+        geometry.endpoints.push_back(points.front());
+        geometry.endpoints.push_back(points.back());
+        // continue the previous stroke, if connected
+        if (!part.strokes.empty() && part.strokes.back().back().squaredTo(points.front()) < RS_TOLERANCE2) {
+            auto& stroke = part.strokes.back();
+            stroke.insert(stroke.end(), points.cbegin() + 1, points.cend());
+        } else {
+            part.strokes.push_back(std::move(points));
+        }
+    }
+
+    void addArc(LC_BlockGeometry& geometry, LC_BlockGeometry::Part& part, const LC_BlockGeometry::Arc& arc) {
+        const std::vector<RS_Vector> points = LC_BlockGeometry::flattenArc(arc, geometry.tolerance);
+        for (const RS_Vector& p: points) {
+            part.minV = RS_Vector::minimum(part.minV, p);
+            part.maxV = RS_Vector::maximum(part.maxV, p);
+        }
+        geometry.endpoints.push_back(points.front());
+        geometry.endpoints.push_back(points.back());
+        part.arcs.push_back(arc);
+    }
+
+    /**
+     * Adds the entity, relative to the base point, to the part of its pen and layer.
+     * @return false, if the entity can't be flattened
+     */
+    bool addEntity(LC_BlockGeometry& geometry, const RS_Entity* e, const RS_Vector& basePoint,
+                   const RS_Pen& pen, RS_Layer* layer) {
+        switch (e->rtti()) {
+            case RS2::EntityLine:
+                addStroke(geometry, findPart(geometry, pen, layer),
+                          {e->getStartpoint() - basePoint, e->getEndpoint() - basePoint});
+                return true;
+            case RS2::EntityArc: {
+                auto arc = static_cast<const RS_Arc*>(e);
+                double angleLength = arc->isReversed() ? -arc->getAngleLength() : arc->getAngleLength();
+                addArc(geometry, findPart(geometry, pen, layer),
+                       {arc->getCenter() - basePoint, arc->getRadius(), arc->getAngle1(), angleLength});
+                return true;
+            }
+            case RS2::EntityCircle: {
+                auto circle = static_cast<const RS_Circle*>(e);
+                addArc(geometry, findPart(geometry, pen, layer),
+                       {circle->getCenter() - basePoint, circle->getRadius(), 0., 2. * M_PI});
+                return true;
+            }
+            case RS2::EntityPolyline: {
+                // segments are drawn with the pen and layer of the polyline
+                for (const RS_Entity* segment: *static_cast<const RS_Polyline*>(e)) {
+                    if (segment->rtti() != RS2::EntityLine && segment->rtti() != RS2::EntityArc) {
+                        return false;
+                    }
+                    addEntity(geometry, segment, basePoint, pen, layer);
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+}
+
+int LC_BlockGeometry::arcSegments(double radius, double angleLength, double tolerance) {
+    double step = (radius > tolerance) ? 2. * std::acos(1. - tolerance / radius) : M_PI;
+    return std::max(1, static_cast<int>(std::ceil(std::abs(angleLength) / step)));
+}
+
+std::vector<RS_Vector> LC_BlockGeometry::flattenArc(const Arc& arc, double tolerance) {
+    return flattenArc(arc.center, arc.radius, arc.startAngle, arc.angleLength, tolerance);
+}
+
+std::vector<RS_Vector> LC_BlockGeometry::flattenArc(const RS_Vector& center, double radius,
+                                                    double startAngle, double angleLength, double tolerance) {
+    int segments = arcSegments(radius, angleLength, tolerance);
+    std::vector<RS_Vector> points;
+    points.reserve(segments + 1);
+    for (int i = 0; i <= segments; ++i) {
+        points.push_back(center + RS_Vector::polar(radius, startAngle + angleLength * i / segments));
+    }
+    return points;
+}
+
+std::unique_ptr<LC_BlockGeometry> LC_BlockGeometry::create(const RS_Block& block) {
+    RS_Vector minV{false};
+    RS_Vector maxV{false};
+    for (const RS_Entity* e: block) {
+        if (e->isUndone() || !e->getFlag(RS2::FlagVisible)) {
+            continue;
+        }
+        minV = RS_Vector::minimum(minV, e->getMin());
+        maxV = RS_Vector::maximum(maxV, e->getMax());
+    }
+    if (!minV.valid) {
+        return nullptr;
+    }
+    auto geometry = std::make_unique<LC_BlockGeometry>();
+    geometry->tolerance = std::max(RS_TOLERANCE, minV.distanceTo(maxV) * relativeFlatteningTolerance);
+    const RS_Vector basePoint = block.getBasePoint();
+    for (const RS_Entity* e: block) {
+        if (e->isUndone() || !e->getFlag(RS2::FlagVisible)) {
+            continue;
+        }
+        if (!addEntity(*geometry, e, basePoint, e->getPen(false), e->getLayer(false))) {
+            RS_DEBUG->print("LC_BlockGeometry::create: block( %s ) is inserted by cloning",
+                            qPrintable(block.getName()));
+            return nullptr;
+        }
+    }
+    for (const Part& part: geometry->parts) {
+        geometry->minV = RS_Vector::minimum(geometry->minV, part.minV);
+        geometry->maxV = RS_Vector::maximum(geometry->maxV, part.maxV);
+    }
+    return geometry->parts.empty() ? nullptr : std::move(geometry);
+}
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#ifndef LC_BLOCKGEOMETRY_H
+#define LC_BLOCKGEOMETRY_H
+
+#include <memory>
+#include <vector>
+
+#include "rs_pen.h"
+#include "rs_vector.h"
+
+class RS_Block;
+class RS_Layer;
+
+/**
+ * Entities of a block as polylines and arcs, in block coordinates relative to
+ * the base point of the block. Inserts of the block may draw and pick this shared
+ * geometry through their transformation, instead of owning transformed clones of
+ * the block entities.
+ *
+ * Strokes are grouped to parts by pen and layer of the source entities, so the
+ * insert can resolve ByBlock attributes and layer "0" as cloned entities do.
+ * Arcs and circles are kept as arcs, so inserts flatten them for the scale they
+ * are drawn with.
+ */
+struct LC_BlockGeometry {
+    struct Arc {
+        RS_Vector center;
+        double radius = 0.;
+        double startAngle = 0.;
+        //! signed angle length, negative for clockwise arcs
+        double angleLength = 0.;
+    };
+
+    struct Part {
+        //! pen of the source entities, as set (not resolved)
+        RS_Pen pen;
+        //! layer of the source entities
+        RS_Layer* layer = nullptr;
+        std::vector<std::vector<RS_Vector>> strokes;
+        std::vector<Arc> arcs;
+        RS_Vector minV{false};
+        RS_Vector maxV{false};
+    };
+
+    std::vector<Part> parts;
+    //! endpoints of the source entities
+    std::vector<RS_Vector> endpoints;
+    RS_Vector minV{false};
+    RS_Vector maxV{false};
+    //! maximum distance of arcs flattened for borders to the arcs
+    double tolerance = 0.;
+
+    /**
+     * @brief create geometry of visible entities of the block. Only lines, arcs, circles and
+     * polylines of them are supported.
+     * @return nullptr, if the block is empty or has entities of other types
+     */
+    static std::unique_ptr<LC_BlockGeometry> create(const RS_Block& block);
+
+    /**
+     * @brief flattenArc points of an arc approximated by chords
+     * @param angleLength - signed angle length, negative for clockwise arcs
+     * @param tolerance - maximum distance of the chords to the arc
+     */
+    static std::vector<RS_Vector> flattenArc(const RS_Vector& center, double radius,
+                                             double startAngle, double angleLength, double tolerance);
+    static std::vector<RS_Vector> flattenArc(const Arc& arc, double tolerance);
+    /**
+     * @return number of chords of an arc approximated with the given tolerance
+     */
+    static int arcSegments(double radius, double angleLength, double tolerance);
+};
+
+#endif // LC_BLOCKGEOMETRY_H
@@ -27,6 +27,7 @@
 #include<iostream>
 #include "rs_block.h"
 
+#include "lc_blockgeometry.h"
 #include "rs_blocklist.h"
 #include "rs_graphic.h"
 #include "rs_insert.h"
@@ -105,6 +106,19 @@ void RS_Block::setModified(bool m) {
         p->setModified(m);
     }
     modified = m;
+    if (m) {
+        m_instanceGeometryValid = false;
+    }
+}
+
+std::shared_ptr<const LC_BlockGeometry> RS_Block::getInstanceGeometry() const {
+    // entities added or removed without an undo cycle don't mark the block modified
+    if (!m_instanceGeometryValid || m_instanceGeometryCount != count()) {
+        m_instanceGeometry = LC_BlockGeometry::create(*this);
+        m_instanceGeometryCount = count();
+        m_instanceGeometryValid = true;
+    }
+    return m_instanceGeometry;
 }
 
 /**
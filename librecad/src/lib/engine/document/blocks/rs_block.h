@@ -28,8 +28,12 @@
 #ifndef RS_BLOCK_H
 #define RS_BLOCK_H
 
+#include <memory>
+
 #include "rs_document.h"
 
+struct LC_BlockGeometry;
+
 /**
  * Holds the data that defines a block.
  */
@@ -184,9 +188,30 @@ public:
      */
     QStringList findNestedInsert(const QString& bName);
 
+    /**
+     * @brief getInstanceGeometry flattened entities of this block, shared by inserts drawn
+     * as instances. Created on the first request, and again after the block was modified.
+     * @return nullptr, if the block can't be drawn as instances
+     */
+    std::shared_ptr<const LC_BlockGeometry> getInstanceGeometry() const;
+    /**
+     * @brief invalidateInstanceGeometry recreate the instance geometry on the next request,
+     * after an entity of the block changed its undo state, layer or pen
+     */
+    void invalidateInstanceGeometry() {
+        m_instanceGeometryValid = false;
+    }
+
 protected:
 //! Block data
     RS_BlockData data;
+
+private:
+    //! cache of getInstanceGeometry(), inserts keep their geometry until they are updated
+    mutable std::shared_ptr<const LC_BlockGeometry> m_instanceGeometry;
+    mutable bool m_instanceGeometryValid = false;
+    //! number of entities the cached geometry was created from
+    mutable unsigned m_instanceGeometryCount = 0;
 };
 
 
@@ -53,6 +53,7 @@ RS_BlockList::RS_BlockList(bool owner) {
  */
 void RS_BlockList::clear() {
     m_blocks.clear();
+    m_blocksByName.clear();
 	m_activeBlock = nullptr;
 	setModified(true);
 }
@@ -98,6 +99,7 @@ bool RS_BlockList::add(RS_Block* block, bool notify) {
     RS_Block* b = find(block->getName());
 	if (!b) {
         m_blocks.append(block);
+        m_blocksByName.insert(block->getName(), block);
 
         if (notify) {
             addNotification();
@@ -135,6 +137,9 @@ void RS_BlockList::remove(RS_Block* block) {
 
     // here the block is removed from the list but not deleted
     m_blocks.removeOne(block);
+    if (block != nullptr && m_blocksByName.value(block->getName()) == block) {
+        m_blocksByName.remove(block->getName());
+    }
 
 	for(auto l: m_blockListListeners){
 		l->blockRemoved(block);
@@ -168,6 +173,10 @@ bool RS_BlockList:: rename(RS_Block* block, const QString& name) {
 		if (!find(name)) {
 			QString oldName = block->getName();
 			block->setName(name);
+			if (m_blocksByName.value(oldName) == block) {
+				m_blocksByName.remove(oldName);
+			}
+			m_blocksByName.insert(name, block);
 			setModified(true);
 
 			// when the renamed block is nested within other block, we need to rename its inserts as well
@@ -205,22 +214,25 @@ void RS_BlockList::editBlock(RS_Block* block, const RS_Block& source) {
  * \p nullptr if no such block was found.
  */
 RS_Block* RS_BlockList::find(const QString& name) {
-    try {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): %s", name.toLatin1().constData());
-    }
-    catch(...) {
-        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): wrong name to find");
-        return nullptr;
-    }
-	// Todo : reduce this from O(N) to O(log(N)) complexity based on sorted list or hash
-	//DFS
+	RS_Block* block = m_blocksByName.value(name, nullptr);
+	if (block != nullptr && block->getName() != name) {
+		// the block was renamed bypassing rename()
+		rebuildNameIndex();
+		block = m_blocksByName.value(name, nullptr);
+	}
+	return block;
+}
+
+/**
+ * Rebuilds the name index from the blocks, the first block of a name wins.
+ */
+void RS_BlockList::rebuildNameIndex() {
+	m_blocksByName.clear();
 	for(RS_Block* b: m_blocks) {
-		if (b->getName()==name) {
-			return b;
+		if (!m_blocksByName.contains(b->getName())) {
+			m_blocksByName.insert(b->getName(), b);
 		}
 	}
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): bad");
-	return nullptr;
 }
 
 /**
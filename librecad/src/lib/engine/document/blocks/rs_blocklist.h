@@ -28,9 +28,10 @@
 #ifndef RS_BLOCKLIST_H
 #define RS_BLOCKLIST_H
 
+#include <QHash>
 #include <QList>
+#include <QString>
 
-class QString;
 class RS_Block;
 class RS_BlockListListener;
 
@@ -102,8 +103,12 @@ public:
 private:
     //! Is the list owning the blocks?
     bool m_owner = false;
+    void rebuildNameIndex();
+
     //! Blocks in the graphic
     QList<RS_Block*> m_blocks;
+    //! Blocks by name, maintained by add(), remove() and rename()
+    QHash<QString, RS_Block*> m_blocksByName;
     //! List of registered BlockListListeners
     QList<RS_BlockListListener*> m_blockListListeners;
     //! Currently active block
@@ -24,6 +24,7 @@
 */
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <deque>
 #include <map>
 #include <random>
@@ -33,9 +34,6 @@
 
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/numeric/ublas/io.hpp>
-#include <boost/geometry.hpp>
-#include <boost/geometry/geometries/register/point.hpp>
-#include <boost/geometry/index/rtree.hpp>
 
 #include "lc_looputils.h"
 #include "rs_circle.h"
@@ -194,18 +192,128 @@ bool isEnclosed(RS_EntityContainer& loop, RS_AtomicEntity& entity)
     return intersections.size()%2 == 0;
 }
 
+//------------------------------------------------------------------------------------//
+struct EndpointHash::Data {
+    using Cell = std::pair<long long, long long>;
+    struct CellHash {
+        size_t operator()(const Cell& cell) const {
+            return std::hash<long long>{}(cell.first * 73856093LL ^ cell.second * 19349663LL);
+        }
+    };
+
+    Data(double tolerance):
+        tolerance{tolerance}
+    {}
+
+    Cell getCell(const RS_Vector& point) const
+    {
+        // cell coordinates are clamped, so far away points don't overflow
+        constexpr double limit = 4.0E18;
+        auto toIndex = [this, limit](double coordinate) {
+            return static_cast<long long>(std::clamp(std::floor(coordinate / tolerance), -limit, limit));
+        };
+        return {toIndex(point.x), toIndex(point.y)};
+    }
+
+    double tolerance = g_contourGapTolerance;
+    std::unordered_map<Cell, std::vector<std::pair<RS_Vector, size_t>>, CellHash> cells;
+};
+
+EndpointHash::EndpointHash():
+    EndpointHash{g_contourGapTolerance}
+{}
+
+EndpointHash::EndpointHash(double tolerance):
+    m_data{std::make_unique<Data>(std::max(tolerance, RS_TOLERANCE * RS_TOLERANCE))}
+{}
+
+EndpointHash::~EndpointHash() = default;
+
+void EndpointHash::insert(const RS_Vector& point, size_t id)
+{
+    if (point.valid)
+        m_data->cells[m_data->getCell(point)].emplace_back(point, id);
+}
+
+void EndpointHash::remove(const RS_Vector& point, size_t id)
+{
+    if (!point.valid)
+        return;
+    auto it = m_data->cells.find(m_data->getCell(point));
+    if (it == m_data->cells.end())
+        return;
+    auto& entries = it->second;
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [id](const std::pair<RS_Vector, size_t>& entry) {
+        return entry.second == id;
+    }), entries.end());
+    if (entries.empty())
+        m_data->cells.erase(it);
+}
+
+std::vector<size_t> EndpointHash::find(const RS_Vector& point) const
+{
+    std::vector<size_t> ids;
+    if (!point.valid)
+        return ids;
+    // a point within the tolerance is in the cell of the point, or in a neighbouring cell
+    const double tolerance2 = m_data->tolerance * m_data->tolerance;
+    const auto [column, row] = m_data->getCell(point);
+    for (long long c = column - 1; c <= column + 1; c++) {
+        for (long long r = row - 1; r <= row + 1; r++) {
+            auto it = m_data->cells.find({c, r});
+            if (it == m_data->cells.end())
+                continue;
+            for (const auto& [position, id]: it->second) {
+                if (position.squaredTo(point) < tolerance2)
+                    ids.push_back(id);
+            }
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+//------------------------------------------------------------------------------------//
 struct LoopExtractor::LoopData {
     LoopData(RS_EntityContainer &edges):
     edges{edges}
     {
         edges.forcedCalculateBorders();
         size = edges.getSize().magnitude();
+        for (RS_Entity* edge: edges) {
+            ids.emplace(edge, edgeList.size());
+            endpoints.insert(edge->getStartpoint(), edgeList.size());
+            endpoints.insert(edge->getEndpoint(), edgeList.size());
+            edgeList.push_back(edge);
+        }
+        processed.assign(edgeList.size(), false);
+        remaining = edgeList.size();
+    }
+
+    // mark an edge as processed: it's removed from the input edges at the end of extraction
+    void setProcessed(RS_Entity* edge)
+    {
+        const size_t id = ids.at(edge);
+        processed[id] = true;
+        endpoints.remove(edge->getStartpoint(), id);
+        endpoints.remove(edge->getEndpoint(), id);
+        remaining--;
     }
+
     double size = 0.;
     RS_Vector vertex;
     RS_Vector vertexTarget;
     RS_Entity* current = nullptr;
     RS_EntityContainer& edges;
+    // edges by ids, and end points of unprocessed edges
+    std::vector<RS_Entity*> edgeList;
+    std::unordered_map<const RS_Entity*, size_t> ids;
+    std::vector<bool> processed;
+    EndpointHash endpoints;
+    size_t remaining = 0;
+    // no edge before this id is unprocessed
+    size_t firstUnprocessed = 0;
 };
 
 LoopExtractor::LoopExtractor(RS_EntityContainer &edges) :
@@ -220,14 +328,11 @@ LoopExtractor::LoopExtractor(RS_EntityContainer &edges) :
 std::vector<RS_Entity*> LoopExtractor::getConnected() const
 {
     std::vector<RS_Entity *> connected;
-    std::copy_if(m_data->edges.begin(), m_data->edges.end(), std::back_inserter(connected),
-                 [vertex = m_data->vertex, current = m_data->current](const RS_Entity *e) {
-        if (e == current)
-            return false;
-        double dist = RS_MAXDOUBLE;
-        e->getNearestEndpoint(vertex, &dist);
-        return dist < g_contourGapTolerance;
-    });
+    for (size_t id: m_data->endpoints.find(m_data->vertex)) {
+        RS_Entity* edge = m_data->edgeList[id];
+        if (edge != m_data->current)
+            connected.push_back(edge);
+    }
     return connected;
 }
 
@@ -246,7 +351,9 @@ RS_Entity* LoopExtractor::findFirst() const
 {
 
     // draw a line crossing the first edge
-    RS_Entity* first = m_data->edges.firstEntity();
+    while (m_data->processed[m_data->firstUnprocessed])
+        m_data->firstUnprocessed++;
+    RS_Entity* first = m_data->edgeList[m_data->firstUnprocessed];
     RS_Vector p0 = first->getMiddlePoint();
     RS_Vector t0 = first->getTangentDirection(p0).normalize();
     // The dP0 direction is off the normal direction by a random angle smaller than 0.06*Pi
@@ -256,11 +363,20 @@ RS_Entity* LoopExtractor::findFirst() const
     std::array<RS_Vector, 2> linePoints = {{p0 - dP0, p0 + dP0}};
     std::sort(std::begin(linePoints), std::end(linePoints), ComparePoints{});
     RS_Line line0{linePoints.front(), linePoints.back()};
+    const RS_Vector lineMin = RS_Vector::minimum(linePoints.front(), linePoints.back());
+    const RS_Vector lineMax = RS_Vector::maximum(linePoints.front(), linePoints.back());
 
     // Find intersections: only keep the intersection of minimum xy-coordinates
     double dist=RS_MAXDOUBLE * RS_MAXDOUBLE;
-    for(RS_Entity* edge: m_data->edges)
+    for(size_t id = m_data->firstUnprocessed; id < m_data->edgeList.size(); id++)
     {
+        RS_Entity* edge = m_data->edgeList[id];
+        // edges out of the bounding box of the line can't intersect it
+        if (m_data->processed[id])
+            continue;
+        if (edge->getMax().x < lineMin.x || edge->getMin().x > lineMax.x
+            || edge->getMax().y < lineMin.y || edge->getMin().y > lineMax.y)
+            continue;
         RS_VectorSolutions sol0 = RS_Information::getIntersection(&line0, edge, true);
         if (!sol0.empty()) {
             for (const RS_Vector& p00: sol0) {
@@ -287,7 +403,7 @@ RS_Entity* LoopExtractor::findFirst() const
     m_data->current = first;
     m_loop = std::make_unique<RS_EntityContainer>(nullptr, false);
     m_loop->addEntity(m_data->current);
-    m_data->edges.removeEntity(first);
+    m_data->setProcessed(first);
     return first;
 }
 
@@ -352,7 +468,7 @@ bool LoopExtractor::findNext() const
     }
     m_data->vertex = (m_data->vertex.squaredTo(m_data->current->getStartpoint()) > RS_TOLERANCE) ? m_data->current->getStartpoint() : m_data->current->getEndpoint();
     m_loop->addEntity(m_data->current);
-    m_data->edges.removeEntity(m_data->current);
+    m_data->setProcessed(m_data->current);
     return true;
 }
 
@@ -365,7 +481,7 @@ std::vector<std::unique_ptr<RS_EntityContainer>> LoopExtractor::extract() {
         return loops;
 
     bool success = true;
-    while(success && !m_data->edges.isEmpty()) {
+    while(success && m_data->remaining > 0) {
         findFirst();
         while(success && m_data->vertex.squaredTo(m_data->vertexTarget) > RS_TOLERANCE) {
             LC_LOG<<m_data->vertex.x<<", "<< m_data->vertex.y<<" : "<<" : ds2 = "
@@ -377,6 +493,13 @@ std::vector<std::unique_ptr<RS_EntityContainer>> LoopExtractor::extract() {
             LC_ERR << __func__<<"(): invalid loop of size = "<<m_loop->count();
         loops.push_back(std::move(m_loop));
     }
+    // remove the processed edges at once
+    std::vector<RS_Entity*> processed;
+    for (size_t id = 0; id < m_data->edgeList.size(); id++) {
+        if (m_data->processed[id])
+            processed.push_back(m_data->edgeList[id]);
+    }
+    m_data->edges.removeEntities(processed);
     LC_LOG<<__func__<<"(): loops.size() = "<<loops.size();
     return loops;
 }
@@ -519,55 +642,39 @@ struct ContourPoint {
     }
 };
 
-namespace bg = boost::geometry;
-namespace bgi = boost::geometry::index;
-using BPoint = bg::model::point<double, 2, bg::cs::cartesian> ;
-using BBox = bg::model::box<BPoint>;
-using TreeValue = std::pair<BBox, ContourPoint>;
-
-struct LoopOptimizer::Data: public bgi::rtree< TreeValue, bgi::quadratic<16> >
+struct LoopOptimizer::Data
 {
     Data(double tolerance):
-        m_tolerance{tolerance},
-        m_halfBox{0.5 * m_tolerance, 0.5 * m_tolerance}
+        m_endpoints{tolerance}
     {}
 
     ~Data()
     {
         std::set<RS_Entity*> edges;
-        for(const auto& [box, contourPoint]: *this) {
-            std::copy(contourPoint.loop->begin(), contourPoint.loop->end(), std::inserter(edges, edges.begin()));
+        for(const auto& [point, contourPoint]: m_contourPoints) {
+            if (contourPoint.loop != nullptr)
+                std::copy(contourPoint.loop->begin(), contourPoint.loop->end(), std::inserter(edges, edges.begin()));
         }
         qDeleteAll(edges);
     }
 
-    static BPoint ToPoint(const RS_Vector& point)
-    {
-        return {point.x, point.y};
-    }
-
-    BBox ToBox(const RS_Vector& point) const
-    {
-        return {ToPoint(point - m_halfBox), ToPoint(point + m_halfBox)};
-    }
-
-    std::vector<TreeValue> Intersects(const BBox& box) const
+    // ids of contour end points connected to the point
+    std::vector<size_t> Intersects(const RS_Vector& point) const
     {
-        std::vector<TreeValue> result_s;
-        query(bgi::intersects(box), std::back_inserter(result_s));
-        return result_s;
+        return m_endpoints.find(point);
     }
 
-    std::vector<TreeValue> Intersects(const RS_Vector& point) const
+    void Insert(const RS_Vector& point, ContourPoint contourPoint)
     {
-        return Intersects(ToBox(point));
+        m_endpoints.insert(point, m_contourPoints.size());
+        m_contourPoints.emplace_back(point, std::move(contourPoint));
     }
 
-    void RemoveAll(const BBox& box)
+    void Remove(size_t id)
     {
-        auto it = qbegin(bgi::intersects(box));
-        if (it != qend())
-            remove(*it);
+        auto& [position, contourPoint] = m_contourPoints[id];
+        m_endpoints.remove(position, id);
+        contourPoint.loop.reset();
     }
 
     /**
@@ -586,8 +693,9 @@ struct LoopOptimizer::Data: public bgi::rtree< TreeValue, bgi::quadratic<16> >
     // total ownership of edges
     std::shared_ptr<RS_EntityContainer> m_result = std::make_shared<RS_EntityContainer>(nullptr, true);
 
-    double m_tolerance = RS_TOLERANCE;
-    RS_Vector m_halfBox{false};
+    // end points of open contours, by ids in m_endpoints. Removed points have no loop
+    std::vector<std::pair<RS_Vector, ContourPoint>> m_contourPoints;
+    EndpointHash m_endpoints;
 };
 
 void LoopOptimizer::Data::AddEdge(RS_AtomicEntity* entity)
@@ -608,19 +716,19 @@ void LoopOptimizer::Data::AddEdge(RS_AtomicEntity* entity)
         break;
     }
 
-    BBox startBox = ToBox(entity->getStartpoint());
-    BBox endBox = ToBox(entity->getEndpoint());
-    std::vector<TreeValue> startResults = Intersects(startBox);
-    std::vector<TreeValue> endResults = Intersects(endBox);
+    const RS_Vector startPoint = entity->getStartpoint();
+    const RS_Vector endPoint = entity->getEndpoint();
+    std::vector<size_t> startResults = Intersects(startPoint);
+    std::vector<size_t> endResults = Intersects(endPoint);
     if (startResults.empty() && endResults.empty()) {
         // insert new loop
         auto newLoop = std::make_shared<std::deque<RS_Entity*>>();
         newLoop->push_back(entity);
-        insert(TreeValue{startBox, {newLoop, RS2::EndPointType::Start}});
-        insert(TreeValue{endBox, {newLoop, RS2::EndPointType::End}});
+        Insert(startPoint, {newLoop, RS2::EndPointType::Start});
+        Insert(endPoint, {newLoop, RS2::EndPointType::End});
     } else if (!startResults.empty() && !endResults.empty()) {
         // loop complete
-        ContourPoint& node = endResults.front().second;
+        ContourPoint node = m_contourPoints[endResults.front()].second;
         if (node.pointType == RS2::EndPointType::End) {
             // append the new edge
             entity->revertDirection();
@@ -633,40 +741,40 @@ void LoopOptimizer::Data::AddEdge(RS_AtomicEntity* entity)
         std::copy(node.loop->cbegin(), node.loop->cend(), std::back_inserter(*loopContainer));
         m_result->addEntity(loopContainer.get());
         loopContainer.release();
-        RemoveAll(startBox);
-        RemoveAll(endBox);
+        Remove(startResults.front());
+        Remove(endResults.front());
     } else if (startResults.empty()) {
         // connect by end point of the new edge
-        ContourPoint& node = endResults.front().second;
+        ContourPoint node = m_contourPoints[endResults.front()].second;
         if (node.pointType == RS2::EndPointType::End) {
             // append the new edge
             entity->revertDirection();
             node.loop->push_back(entity);
-            // update the end point in tree
-            insert({startBox, {node.loop, RS2::EndPointType::End}});
+            // update the end point in the hash
+            Insert(startPoint, {node.loop, RS2::EndPointType::End});
         } else {
             // prepend the new edge
             node.loop->push_front(entity);
-            // update the start point in tree
-            insert({startBox, {node.loop, RS2::EndPointType::Start}});
+            // update the start point in the hash
+            Insert(startPoint, {node.loop, RS2::EndPointType::Start});
         }
         // remove the merged point
-        RemoveAll(endBox);
+        Remove(endResults.front());
     } else {
         // connected by the start point of the new edge
-        ContourPoint& node = startResults.front().second;
+        ContourPoint node = m_contourPoints[startResults.front()].second;
         if (node.pointType == RS2::EndPointType::Start) {
             // prepend the new edge
             entity->revertDirection();
             node.loop->push_front(entity);
-            insert({endBox, {node.loop, RS2::EndPointType::Start}});
+            Insert(endPoint, {node.loop, RS2::EndPointType::Start});
         } else {
             // append the new edge
             node.loop->push_back(entity);
-            insert({endBox, {node.loop, RS2::EndPointType::End}});
+            Insert(endPoint, {node.loop, RS2::EndPointType::End});
         }
         // remove the merged point
-        RemoveAll(startBox);
+        Remove(startResults.front());
     }
 }
 
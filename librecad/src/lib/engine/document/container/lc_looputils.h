@@ -25,6 +25,7 @@
 #ifndef LC_LOOPUTILS_H
 #define LC_LOOPUTILS_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -52,6 +53,43 @@ namespace LC_LoopUtils {
  */
 bool isEnclosed(RS_EntityContainer& loop, RS_AtomicEntity& entity);
 
+/**
+ * @brief The EndpointHash class - spatial hash of end points, with cells of the connection tolerance.
+ * Each point is stored with an id chosen by the caller (usually the index of its edge), so points
+ * connected to a given point are found by looking up the neighbouring cells only, instead of
+ * checking all edges.
+ */
+class EndpointHash {
+public:
+    /**
+     * @brief EndpointHash - hash of points connected within the contour gap tolerance
+     */
+    EndpointHash();
+    /**
+     * @brief EndpointHash - hash of points connected within the given tolerance
+     * @param tolerance - maximum distance of connected points
+     */
+    explicit EndpointHash(double tolerance);
+    ~EndpointHash();
+
+    /**
+     * @brief insert - add a point. Invalid points are ignored
+     */
+    void insert(const RS_Vector& point, size_t id);
+    /**
+     * @brief remove - remove a point added by insert()
+     */
+    void remove(const RS_Vector& point, size_t id);
+    /**
+     * @brief find - find points connected to the given point
+     * @return std::vector<size_t> - ids of points within the tolerance of the point, ascending and unique
+     */
+    std::vector<size_t> find(const RS_Vector& point) const;
+private:
+    struct Data;
+    std::unique_ptr<Data> m_data;
+};
+
 /**
  * @brief The LoopExtractor class, to extract closed loops from edges.
  * The algorithm：
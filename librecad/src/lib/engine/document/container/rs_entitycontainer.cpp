@@ -29,7 +29,9 @@
 #include "rs_entitycontainer.h"
 
 #include <QObject>
+#include <algorithm>
 #include <set>
+#include <unordered_set>
 
 #include "lc_looputils.h"
 #include "qg_dialogfactory.h"
@@ -37,10 +39,13 @@
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_dimension.h"
+#include "rs_document.h"
 #include "rs_ellipse.h"
 #include "rs_information.h"
+#include "rs_graphic.h"
 #include "rs_insert.h"
 #include "rs_layer.h"
+#include "rs_layerlist.h"
 #include "rs_line.h"
 #include "rs_painter.h"
 #include "rs_solid.h"
@@ -53,6 +58,9 @@ namespace {
 // the tolerance used to check topology of contours in hatching
     constexpr double contourTolerance = 1e-8;
 
+// the minimum number of entities for a container to use a spatial index in nearest queries
+    constexpr int spatialIndexMinSize = 256;
+
 // For validate hatch contours, whether an entity in the contour is a closed
 // loop itself
     bool isClosedLoop(RS_Entity &entity) {
@@ -68,6 +76,31 @@ namespace {
         }
     }
 
+// the maximum number of cached intersections of entity pairs
+    constexpr std::size_t intersectionCacheMaxSize = 8192;
+
+// construction lines are infinite, so their borders can't be used to prune intersections
+    bool hasFiniteBorders(const RS_Entity &entity) {
+        return entity.rtti() != RS2::EntityConstructionLine;
+    }
+
+// whether the bounding box of an entity overlaps the given box
+    bool bordersOverlap(const RS_Entity &entity, const LC_Rect &box) {
+        return !hasFiniteBorders(entity) || box.intersects(LC_Rect{entity.getMin(), entity.getMax()});
+    }
+
+// the distance from a point to the bounding box of an entity
+    double bordersDistance(const RS_Entity &entity, const RS_Vector &point) {
+        if (!hasFiniteBorders(entity)) {
+            return 0.;
+        }
+        const RS_Vector &minV = entity.getMin();
+        const RS_Vector &maxV = entity.getMax();
+        double dx = std::max({minV.x - point.x, 0., point.x - maxV.x});
+        double dy = std::max({minV.y - point.y, 0., point.y - maxV.y});
+        return std::hypot(dx, dy);
+    }
+
 // Find the nearest distance between the endpoints of an entity to a given point
     double endPointDistance(const RS_Vector &point, const RS_Entity &entity) {
         double distance = RS_MAXDOUBLE;
@@ -128,6 +161,7 @@ RS_EntityContainer& RS_EntityContainer::operator = (const RS_EntityContainer& ot
             }
         }
     }
+    invalidateSpatialIndex();
     return *this;
 }
 
@@ -150,6 +184,8 @@ RS_EntityContainer& RS_EntityContainer::operator = (RS_EntityContainer&& other)
     m_autoUpdateBorders = other.m_autoUpdateBorders;
     entIdx = other.entIdx;
     autoDelete = other.autoDelete;
+    invalidateSpatialIndex();
+    other.invalidateSpatialIndex();
     return *this;
 }
 
@@ -480,8 +516,10 @@ void RS_EntityContainer::addEntity(RS_Entity *entity) {
     if (entity->rtti() == RS2::EntityImage ||
         entity->rtti() == RS2::EntityHatch) {
         m_entities.prepend(entity);
+        indexEntity(entity, true);
     } else {
         m_entities.append(entity);
+        indexEntity(entity, false);
     }
     if (m_autoUpdateBorders) {
         adjustBorders(entity);
@@ -496,6 +534,7 @@ void RS_EntityContainer::appendEntity(RS_Entity *entity) {
     if (entity == nullptr)
         return;
     m_entities.append(entity);
+    indexEntity(entity, false);
     if (m_autoUpdateBorders)
         adjustBorders(entity);
 }
@@ -508,6 +547,7 @@ void RS_EntityContainer::prependEntity(RS_Entity *entity) {
     if (entity == nullptr)
         return;
     m_entities.prepend(entity);
+    indexEntity(entity, true);
     if (m_autoUpdateBorders)
         adjustBorders(entity);
 }
@@ -546,6 +586,8 @@ void RS_EntityContainer::moveEntity(int index, QList<RS_Entity *> &entList) {
     for (auto e: entList) {
         m_entities.insert(ci++, e);
     }
+    // container orders are changed
+    invalidateSpatialIndex();
 }
 
 /**
@@ -557,6 +599,7 @@ void RS_EntityContainer::insertEntity(int index, RS_Entity *entity) {
         return;
 
     m_entities.insert(index, entity);
+    invalidateSpatialIndex();
 
     if (m_autoUpdateBorders) {
         adjustBorders(entity);
@@ -593,6 +636,10 @@ bool RS_EntityContainer::removeEntity(RS_Entity *entity) {
     //    and sets 'entIdx' in next() or last() if 'entity' is the last item in the list.
     //    in LibreCAD is never called with nullptr
     bool ret = m_entities.removeOne(entity);
+    clearIntersectionCache();
+    if (ret && m_spatialIndexValid && m_spatialIndex != nullptr) {
+        m_spatialIndex->Remove(entity);
+    }
 
     if (autoDelete && ret) {
         delete entity;
@@ -603,6 +650,76 @@ bool RS_EntityContainer::removeEntity(RS_Entity *entity) {
     return ret;
 }
 
+/**
+ * Adds the given entities to this container, in the same way as addEntity()
+ * for each of them. For a batch that is large compared to this container, the
+ * spatial index is rebuilt by the next query instead of being updated
+ * entity by entity.
+ */
+void RS_EntityContainer::addEntities(const std::vector<RS_Entity*>& entities) {
+    if (entities.empty())
+        return;
+    if (entities.size() * 4 > size_t(m_entities.size())) {
+        invalidateSpatialIndex();
+    }
+    m_entities.reserve(m_entities.size() + int(entities.size()));
+    for (RS_Entity* entity: entities) {
+        addEntity(entity);
+    }
+}
+
+/**
+ * Removes the given entities from this container by a single pass over the
+ * entity list, and updates the borders of this entity-container once, if
+ * autoUpdateBorders is true. Removed entities are deleted if this container
+ * owns them.
+ *
+ * @return number of entities removed
+ */
+int RS_EntityContainer::removeEntities(const std::vector<RS_Entity*>& entities) {
+    if (entities.empty())
+        return 0;
+    if (entities.size() == 1)
+        return removeEntity(entities.front()) ? 1 : 0;
+
+    std::unordered_set<RS_Entity*> toRemove(entities.cbegin(), entities.cend());
+    QList<RS_Entity*> kept;
+    kept.reserve(m_entities.size());
+    std::vector<RS_Entity*> removed;
+    for (RS_Entity* e: std::as_const(m_entities)) {
+        // erase from the set, so an entity listed twice is still removed once
+        if (toRemove.erase(e) > 0) {
+            removed.push_back(e);
+        } else {
+            kept.append(e);
+        }
+    }
+    if (removed.empty())
+        return 0;
+    m_entities.swap(kept);
+
+    clearIntersectionCache();
+    if (m_spatialIndexValid && m_spatialIndex != nullptr) {
+        if (removed.size() * 4 > size_t(m_entities.size())) {
+            invalidateSpatialIndex();
+        } else {
+            for (RS_Entity* e: removed) {
+                m_spatialIndex->Remove(e);
+            }
+        }
+    }
+
+    if (autoDelete) {
+        for (RS_Entity* e: removed) {
+            delete e;
+        }
+    }
+    if (m_autoUpdateBorders) {
+        calculateBorders();
+    }
+    return int(removed.size());
+}
+
 /**
  * Erases all entities in this container and resets the borders..
  */
@@ -615,6 +732,10 @@ void RS_EntityContainer::clear() {
     } else {
         m_entities.clear();
     }
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->Clear();
+    }
+    invalidateSpatialIndex();
     resetBorders();
 }
 
@@ -745,6 +866,9 @@ void RS_EntityContainer::calculateBorders() {
     RS_DEBUG->print("RS_EntityContainer::calculateBorders");
 
     resetBorders();
+    clearIntersectionCache();
+    // keep index nodes in sync with the recalculated borders
+    LC_EntityRTree* index = (m_spatialIndexValid) ? m_spatialIndex.get() : nullptr;
     for (RS_Entity *e: *this) {
 
         RS_Layer *layer = e->getLayer();
@@ -756,6 +880,9 @@ void RS_EntityContainer::calculateBorders() {
             e->calculateBorders();
             adjustBorders(e);
         }
+        if (index != nullptr) {
+            index->Update(e);
+        }
     }
 
     RS_DEBUG->print("RS_EntityContainer::calculateBorders: size 1: %f,%f",
@@ -800,6 +927,8 @@ void RS_EntityContainer::forcedCalculateBorders() {
     //RS_DEBUG->print("RS_EntityContainer::calculateBorders");
 
     resetBorders();
+    clearIntersectionCache();
+    LC_EntityRTree* index = (m_spatialIndexValid) ? m_spatialIndex.get() : nullptr;
     for (RS_Entity *e: *this) {
 
         //RS_Layer* layer = e->getLayer();
@@ -811,6 +940,9 @@ void RS_EntityContainer::forcedCalculateBorders() {
             e->calculateBorders();
         }
         adjustBorders(e);
+        if (index != nullptr) {
+            index->Update(e);
+        }
     }
 
     // needed for correcting corrupt data (PLANS.dxf)
@@ -841,6 +973,7 @@ void RS_EntityContainer::forcedCalculateBorders() {
  */
 void RS_EntityContainer::updateDimensions(bool autoText) {
     RS_DEBUG->print("RS_EntityContainer::updateDimensions()");
+    invalidateSpatialIndex();
 
     //for (RS_Entity* e=firstEntity(RS2::ResolveNone);
     //        e;
@@ -869,6 +1002,7 @@ void RS_EntityContainer::updateInserts() {
 
     std::string idTypeId = std::to_string(getId()) + "/" + std::to_string(rtti());
     RS_DEBUG->print("RS_EntityContainer::updateInserts() ID/type: %s", idTypeId.c_str());
+    invalidateSpatialIndex();
 
     for (RS_Entity *e: std::as_const(*this)) {
         //// Only update our own inserts and not inserts of inserts
@@ -921,6 +1055,7 @@ void RS_EntityContainer::renameInserts(const QString &oldName,const QString &new
  */
 void RS_EntityContainer::updateSplines() {
     RS_DEBUG->print("RS_EntityContainer::updateSplines()");
+    invalidateSpatialIndex();
 
     for (RS_Entity *e: *this) {
         //// Only update our own inserts and not inserts of inserts
@@ -938,6 +1073,7 @@ void RS_EntityContainer::updateSplines() {
  * Updates the sub entities of this container.
  */
 void RS_EntityContainer::update() {
+    invalidateSpatialIndex();
     for (RS_Entity *e: *this) {
         e->update();
     }
@@ -1312,6 +1448,7 @@ void RS_EntityContainer::setEntityAt(int index, RS_Entity *en) {
         delete m_entities.at(index);
     }
     m_entities[index] = en;
+    invalidateSpatialIndex();
 }
 
 /**
@@ -1331,6 +1468,113 @@ int RS_EntityContainer::findEntity(RS_Entity const *const entity) {
     return entIdx;
 }
 
+/**
+ * @brief RS_EntityContainer::spatialIndex the spatial index is built for large containers
+ * on the first query, and maintained by entity additions/removals and border updates afterwards
+ */
+LC_EntityRTree* RS_EntityContainer::spatialIndex() const {
+    if (m_entities.size() < spatialIndexMinSize) {
+        return nullptr;
+    }
+    if (m_spatialIndex == nullptr) {
+        m_spatialIndex = std::make_unique<LC_EntityRTree>();
+    }
+    // lines on construction layers are indexed without a box, so the index is outdated
+    // when the construction flag of a layer changes
+    unsigned long constructionChanges = 0;
+    RS_Graphic* graphic = getGraphic();
+    if (graphic != nullptr && graphic->getLayerList() != nullptr) {
+        constructionChanges = graphic->getLayerList()->getConstructionChanges();
+    }
+    if (!m_spatialIndexValid || m_spatialIndex->Size() != std::size_t(m_entities.size())
+        || m_spatialIndexConstructionChanges != constructionChanges) {
+        m_spatialIndex->Build(std::vector<RS_Entity*>(m_entities.cbegin(), m_entities.cend()));
+        m_spatialOrderFirst = 0;
+        m_spatialOrderLast = m_entities.size() - 1;
+        m_spatialIndexValid = true;
+        m_spatialIndexConstructionChanges = constructionChanges;
+    }
+    return m_spatialIndex.get();
+}
+
+/**
+ * Intersections cached for snapping are kept by the document, and cleared whenever
+ * any of its containers changes.
+ */
+void RS_EntityContainer::clearIntersectionCache() const {
+    RS_Document* document = getDocument();
+    if (document != nullptr) {
+        document->getIntersectionCache().clear();
+    }
+}
+
+void RS_EntityContainer::indexEntity(RS_Entity *entity, bool prepended) {
+    clearIntersectionCache();
+    if (m_spatialIndexValid && m_spatialIndex != nullptr) {
+        m_spatialIndex->Insert(entity, prepended ? --m_spatialOrderFirst : ++m_spatialOrderLast);
+    }
+}
+
+void RS_EntityContainer::visitNearest(const RS_Vector &coord, const double &minDist,
+                                      const std::function<void(RS_Entity *, long long)> &visitor) const {
+    LC_EntityRTree* index = spatialIndex();
+    if (index == nullptr) {
+        long long order = 0;
+        for (RS_Entity *en: m_entities) {
+            visitor(en, order++);
+        }
+        return;
+    }
+    // box distances are lower bounds of entity distances, so no closer entity
+    // can be found once the box distance exceeds the current minimum
+    index->VisitNearest(coord, [&minDist, &visitor](RS_Entity *en, long long order, double boxDistance) {
+        if (boxDistance > minDist) {
+            return false;
+        }
+        visitor(en, order);
+        return true;
+    });
+}
+
+bool RS_EntityContainer::getEntitiesInWindow(const LC_Rect &window, std::vector<RS_Entity *> &entities) const {
+    LC_EntityRTree* index = spatialIndex();
+    if (index == nullptr) {
+        return false;
+    }
+    entities = index->EntitiesInBox(window);
+    return true;
+}
+
+void RS_EntityContainer::sortByContainerOrder(std::vector<RS_Entity*>& entities) const {
+    if (entities.size() < 2) {
+        return;
+    }
+    LC_EntityRTree* index = spatialIndex();
+    if (index == nullptr) {
+        std::unordered_set<RS_Entity*> wanted(entities.cbegin(), entities.cend());
+        entities.clear();
+        for (RS_Entity* e: m_entities) {
+            if (wanted.count(e) > 0) {
+                entities.push_back(e);
+            }
+        }
+        return;
+    }
+    std::vector<std::pair<long long, RS_Entity*>> ordered;
+    ordered.reserve(entities.size());
+    for (RS_Entity* e: entities) {
+        long long order = 0;
+        if (index->Order(e, order)) {
+            ordered.emplace_back(order, e);
+        }
+    }
+    std::sort(ordered.begin(), ordered.end());
+    entities.clear();
+    for (const auto& [order, e]: ordered) {
+        entities.push_back(e);
+    }
+}
+
 /**
  * @return The point which is closest to 'coord'
  * (one of the vertices)
@@ -1340,11 +1584,10 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(
     double *dist) const
 {
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist = 0.;                 // currently measured distance
+    long long minOrder = 0;         // container order of the closest entity
     RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
 
-    for(RS_Entity* en : *this) {
+    visitNearest(coord, minDist, [&](RS_Entity* en, long long order) {
         if (en != nullptr && en->getId() != 0 && en->isVisible()){
             auto parent = en->getParent();
             bool checkForEndpoint = true;
@@ -1352,17 +1595,20 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(
                 checkForEndpoint = !parent->ignoredOnModification();
             }
             if (checkForEndpoint) {//no end point for Insert, text, Dim
-                point = en->getNearestEndpoint(coord, &curDist);
-                if (point.valid && curDist < minDist) {
+                double curDist = 0.;                 // currently measured distance
+                RS_Vector point = en->getNearestEndpoint(coord, &curDist);
+                // on a tie, prefer the first entity in the container
+                if (point.valid && (curDist < minDist || (closestPoint.valid && curDist == minDist && order < minOrder))) {
                     closestPoint = point;
                     minDist = curDist;
+                    minOrder = order;
                     if (dist) {
                         *dist = minDist;
                     }
                 }
             }
         }
-    }
+    });
 
     return closestPoint;
 }
@@ -1377,22 +1623,18 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(
     double *dist, RS_Entity **pEntity) const {
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist;                 // currently measured distance
+    long long minOrder = 0;         // container order of the closest entity
     RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
-
-    //QListIterator<RS_Entity> it = createIterator();
-    //RS_Entity* en;
-    //while ( (en = it.current())  ) {
-    //    ++it;
 
-    for (auto en: m_entities) {
+    visitNearest(coord, minDist, [&](RS_Entity* en, long long order) {
         if (en->getParent() == nullptr || !en->getParent()->ignoredOnModification()) {//no end point for Insert, text, Dim
             //            std::cout<<"find nearest for entity "<<i0<<std::endl;
-            point = en->getNearestEndpoint(coord, &curDist);
-            if (point.valid && curDist < minDist) {
+            double curDist = 0.;                 // currently measured distance
+            RS_Vector point = en->getNearestEndpoint(coord, &curDist);
+            if (point.valid && (curDist < minDist || (closestPoint.valid && curDist == minDist && order < minOrder))) {
                 closestPoint = point;
                 minDist = curDist;
+                minOrder = order;
                 if (dist) {
                     *dist = minDist;
                 }
@@ -1401,7 +1643,7 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(
                 }
             }
         }
-    }
+    });
 
     //    std::cout<<__FILE__<<" : "<<__func__<<" : line "<<__LINE__<<std::endl;
     //    std::cout<<"count()="<<const_cast<RS_EntityContainer*>(this)->count()<<"\tminDist= "<<minDist<<"\tclosestPoint="<<closestPoint;
@@ -1431,23 +1673,24 @@ RS_Vector RS_EntityContainer::getNearestCenter(
     const RS_Vector &coord,
     double *dist) const {
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist = RS_MAXDOUBLE;  // currently measured distance
+    long long minOrder = 0;         // container order of the closest entity
     RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
 
-    for (auto en: m_entities) {
+    visitNearest(coord, minDist, [&](RS_Entity* en, long long order) {
 
         if (en != nullptr && en->getId() != 0
             && en->isVisible()
             && !en->getParent()->ignoredSnap()
             ) {//no center point for spline, text, Dim
-            point = en->getNearestCenter(coord, &curDist);
-            if (point.valid && curDist < minDist) {
+            double curDist = RS_MAXDOUBLE;  // currently measured distance
+            RS_Vector point = en->getNearestCenter(coord, &curDist);
+            if (point.valid && (curDist < minDist || (closestPoint.valid && curDist == minDist && order < minOrder))) {
                 closestPoint = point;
                 minDist = curDist;
+                minOrder = order;
             }
         }
-    }
+    });
     if (dist) {
         *dist = minDist;
     }
@@ -1463,22 +1706,23 @@ RS_Vector RS_EntityContainer::getNearestMiddle(
     int middlePoints
 ) const {
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist = RS_MAXDOUBLE;  // currently measured distance
+    long long minOrder = 0;         // container order of the closest entity
     RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
 
-    for (auto en: m_entities) {
+    visitNearest(coord, minDist, [&](RS_Entity* en, long long order) {
 
         if (en->isVisible()
             && !en->getParent()->ignoredSnap()
             ) {//no midle point for spline, text, Dim
-            point = en->getNearestMiddle(coord, &curDist, middlePoints);
-            if (point.valid && curDist < minDist) {
+            double curDist = RS_MAXDOUBLE;  // currently measured distance
+            RS_Vector point = en->getNearestMiddle(coord, &curDist, middlePoints);
+            if (point.valid && (curDist < minDist || (closestPoint.valid && curDist == minDist && order < minOrder))) {
                 closestPoint = point;
                 minDist = curDist;
+                minOrder = order;
             }
         }
-    }
+    });
     if (dist) {
         *dist = minDist;
     }
@@ -1497,6 +1741,31 @@ RS_Vector RS_EntityContainer::getNearestDist(
                                       : RS_Vector{false};
 }
 
+void RS_EntityContainer::collectIntersectionCandidates(const LC_Rect &box, std::vector<RS_Entity *> &candidates) const {
+    std::vector<RS_Entity*> entitiesInBox;
+    if (getEntitiesInWindow(box, entitiesInBox)) {
+        for (RS_Entity *e: entitiesInBox) {
+            if (e->isContainer() && e->rtti() != RS2::EntityText && e->rtti() != RS2::EntityMText) {
+                static_cast<RS_EntityContainer *>(e)->collectIntersectionCandidates(box, candidates);
+            } else if (bordersOverlap(*e, box)) {
+                candidates.push_back(e);
+            }
+        }
+        return;
+    }
+    // same order and resolution as iterating by RS2::ResolveAllButTextImage
+    for (RS_Entity *e: m_entities) {
+        if (!bordersOverlap(*e, box)) {
+            continue;
+        }
+        if (e->isContainer() && e->rtti() != RS2::EntityText && e->rtti() != RS2::EntityMText) {
+            static_cast<RS_EntityContainer *>(e)->collectIntersectionCandidates(box, candidates);
+        } else {
+            candidates.push_back(e);
+        }
+    }
+}
+
 /**
  * @return The intersection which is closest to 'coord'
  */
@@ -1509,19 +1778,51 @@ RS_Vector RS_EntityContainer::getNearestIntersection(
     RS_Entity* closestEntity = getNearestEntity(coord, nullptr, RS2::ResolveAllButTextImage);
 
     if (closestEntity) {
-        for (RS_Entity *en = firstEntity(RS2::ResolveAllButTextImage);
-             en;
-             en = nextEntity(RS2::ResolveAllButTextImage)) {
+        // intersections are within the bounding box of the closest entity, so only entities
+        // with overlapping boxes are tested
+        std::vector<RS_Entity*> candidates;
+        if (hasFiniteBorders(*closestEntity)) {
+            LC_Rect box{closestEntity->getMin(), closestEntity->getMax()};
+            double tolerance = RS_TOLERANCE + 1e-8 * std::max(box.width(), box.height());
+            collectIntersectionCandidates(box.increaseBy(tolerance), candidates);
+        } else {
+            for (RS_Entity *en = firstEntity(RS2::ResolveAllButTextImage);
+                 en;
+                 en = nextEntity(RS2::ResolveAllButTextImage)) {
+                candidates.push_back(en);
+            }
+        }
+
+        RS_Document* document = getDocument();
+        RS_Document::IntersectionCache* cache = (document != nullptr) ? &document->getIntersectionCache() : nullptr;
+        if (cache != nullptr && cache->size() > intersectionCacheMaxSize) {
+            cache->clear();
+        }
+
+        for (RS_Entity *en: candidates) {
             if (
                 !en->isVisible()
                 || en->getParent()->ignoredSnap()
                 ) {
                 continue;
             }
+            // intersections are within the bounding box of the entity too
+            if (bordersDistance(*en, coord) > minDist) {
+                continue;
+            }
 
-            RS_VectorSolutions sol = RS_Information::getIntersection(closestEntity,
-                                                  en,
-                                                  true);
+            RS_VectorSolutions sol;
+            const auto key = std::make_pair(closestEntity->getId(), en->getId());
+            const bool cacheable = cache != nullptr && key.first != 0 && key.second != 0;
+            auto cached = cacheable ? cache->find(key) : RS_Document::IntersectionCache::iterator{};
+            if (cacheable && cached != cache->end()) {
+                sol = cached->second;
+            } else {
+                sol = RS_Information::getIntersection(closestEntity, en, true);
+                if (cacheable) {
+                    cache->emplace(key, sol);
+                }
+            }
 
             double curDist = RS_MAXDOUBLE;  // currently measured distance
             RS_Vector point = sol.getClosest(coord, &curDist, nullptr);
@@ -1569,23 +1870,24 @@ RS_Vector RS_EntityContainer::getNearestRef(
     double *dist) const {
 
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist;                 // currently measured distance
+    long long minOrder = 0;         // container order of the closest entity
     RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
 
-    for (RS_Entity* en: *this) {
+    visitNearest(coord, minDist, [&](RS_Entity* en, long long order) {
 
         if (en->isVisible()) {
-            point = en->getNearestRef(coord, &curDist);
-            if (point.valid && curDist < minDist) {
+            double curDist = 0.;            // currently measured distance
+            RS_Vector point = en->getNearestRef(coord, &curDist);
+            if (point.valid && (curDist < minDist || (closestPoint.valid && curDist == minDist && order < minOrder))) {
                 closestPoint = point;
                 minDist = curDist;
+                minOrder = order;
                 if (dist) {
                     *dist = minDist;
                 }
             }
         }
-    }
+    });
 
     return closestPoint;
 }
@@ -1640,18 +1942,19 @@ double RS_EntityContainer::getDistanceToPoint(
 
 
     double minDist = RS_MAXDOUBLE;      // minimum measured distance
-    double curDist = 0.;                     // currently measured distance
+    long long maxOrder = 0;             // container order of the closest entity
+    bool found = false;
     RS_Entity *closestEntity = nullptr;    // closest entity found
-    RS_Entity *subEntity = nullptr;
 
-    for (RS_Entity* e: *this) {
+    visitNearest(coord, minDist, [&](RS_Entity* e, long long order) {
         auto entityLayer = e->getLayer();
         if (e->isVisible() && (entityLayer == nullptr || !entityLayer->isLocked())) {
             RS_DEBUG->print("entity: getDistanceToPoint");
             RS_DEBUG->print("entity: %d", e->rtti());
             // bug#426, need to ignore Images to find nearest intersections
-            if (level == RS2::ResolveAllButTextImage && e->rtti() == RS2::EntityImage) continue;
-            curDist = e->getDistanceToPoint(coord, &subEntity, level, solidDist);
+            if (level == RS2::ResolveAllButTextImage && e->rtti() == RS2::EntityImage) return;
+            RS_Entity *subEntity = nullptr;
+            double curDist = e->getDistanceToPoint(coord, &subEntity, level, solidDist);
 
             RS_DEBUG->print("entity: getDistanceToPoint: OK");
 
@@ -1663,8 +1966,10 @@ double RS_EntityContainer::getDistanceToPoint(
              * drawn directly over top of another, and it's reasonable to assume that humans will
              * tend to want to reference entities that they see or have recently drawn as opposed
              * to deeper more forgotten and invisible ones...
+             * With the spatial index, entities are not visited in container order, so ties are
+             * resolved by the container order explicitly.
              */
-            if (curDist <= minDist) {
+            if (curDist < minDist || (curDist == minDist && (!found || order > maxOrder))) {
                 switch (level) {
                 case RS2::ResolveAll:
                 case RS2::ResolveAllButTextImage:
@@ -1674,9 +1979,11 @@ double RS_EntityContainer::getDistanceToPoint(
                     closestEntity = e;
                 }
                 minDist = curDist;
+                maxOrder = order;
+                found = true;
             }
         }
-    }
+    });
 
     if (entity != nullptr) {
         *entity = closestEntity;
@@ -1863,6 +2170,7 @@ bool RS_EntityContainer::hasEndpointsWithinWindow(const RS_Vector &v1, const RS_
 }
 
 void RS_EntityContainer::move(const RS_Vector &offset) {
+    invalidateSpatialIndex();
     moveBorders(offset);
     for (RS_Entity *e: *this) {
         e->move(offset);
@@ -1877,6 +2185,7 @@ void RS_EntityContainer::rotate(const RS_Vector &center, double angle) {
 }
 
 void RS_EntityContainer::rotate(const RS_Vector &center, const RS_Vector &angleVector) {
+    invalidateSpatialIndex();
     resetBorders();
 
     for (RS_Entity *e: *this) {
@@ -1889,6 +2198,7 @@ void RS_EntityContainer::rotate(const RS_Vector &center, const RS_Vector &angleV
 
 void RS_EntityContainer::scale(const RS_Vector &center, const RS_Vector &factor) {
     if (std::abs(factor.x) > RS_TOLERANCE && std::abs(factor.y) > RS_TOLERANCE) {
+        invalidateSpatialIndex();
         scaleBorders(center, factor);
         for (RS_Entity* e: *this) {
             e->scale(center, factor);
@@ -1901,7 +2211,7 @@ void RS_EntityContainer::scale(const RS_Vector &center, const RS_Vector &factor)
 
 void RS_EntityContainer::mirror(const RS_Vector &axisPoint1, const RS_Vector &axisPoint2) {
     if (axisPoint1.distanceTo(axisPoint2) > RS_TOLERANCE) {
-
+        invalidateSpatialIndex();
         resetBorders();
         for (RS_Entity *e: *this) {
             e->mirror(axisPoint1, axisPoint2);
@@ -1911,6 +2221,7 @@ void RS_EntityContainer::mirror(const RS_Vector &axisPoint1, const RS_Vector &ax
 }
 
 RS_Entity &RS_EntityContainer::shear(double k) {
+    invalidateSpatialIndex();
     for (RS_Entity *e: *this)
         e->shear(k);
     calculateBorders();
@@ -1923,6 +2234,7 @@ void RS_EntityContainer::stretch(
     const RS_Vector &secondCorner,
     const RS_Vector &offset) {
 
+    invalidateSpatialIndex();
     if (getMin().isInWindow(firstCorner, secondCorner) &&
         getMax().isInWindow(firstCorner, secondCorner)) {
 
@@ -1943,6 +2255,7 @@ void RS_EntityContainer::moveRef(
     const RS_Vector &ref,
     const RS_Vector &offset) {
 
+    invalidateSpatialIndex();
     resetBorders();
     for (RS_Entity *e: *this) {
         e->moveRef(ref, offset);
@@ -1957,6 +2270,7 @@ void RS_EntityContainer::moveSelectedRef(
     const RS_Vector &ref,
     const RS_Vector &offset) {
 
+    invalidateSpatialIndex();
     resetBorders();
     for (RS_Entity *e: *this) {
         e->moveSelectedRef(ref, offset);
@@ -1968,6 +2282,7 @@ void RS_EntityContainer::moveSelectedRef(
 }
 
 void RS_EntityContainer::revertDirection() {
+    invalidateSpatialIndex();
     // revert entity order in the container
     for (int k = 0; k < m_entities.size() / 2; ++k) {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 13, 0))
@@ -29,6 +29,8 @@
 #define RS_ENTITYCONTAINER_H
 
 #include <QList>
+#include "lc_rect.h"
+#include "lc_rtree.h"
 #include "rs_entity.h"
 
 /**
@@ -108,6 +110,8 @@ public:
     virtual void moveEntity(int index, QList<RS_Entity *>& entList);
     virtual void insertEntity(int index, RS_Entity* entity);
     virtual bool removeEntity(RS_Entity* entity);
+    virtual void addEntities(const std::vector<RS_Entity*>& entities);
+    virtual int removeEntities(const std::vector<RS_Entity*>& entities);
 
 //!
 //! \brief addRectangle add four lines to form a rectangle by
@@ -160,7 +164,7 @@ public:
     }
     virtual void adjustBorders(RS_Entity* entity);
     void calculateBorders() override;
-    void forcedCalculateBorders();
+    virtual void forcedCalculateBorders();
     void updateDimensions( bool autoText=true);
     virtual void updateInserts();
     virtual void updateSplines();
@@ -191,6 +195,11 @@ public:
     RS_Vector getNearestDist(double distance,
                              const RS_Vector& coord,
                              double* dist = nullptr) const override;
+    /**
+     * @brief getNearestIntersection find the intersection of the entity closest to coord with other entities.
+     * Only entities with bounding boxes overlapping the closest entity are tested, and intersections
+     * computed are cached by the document until it is modified.
+     */
     RS_Vector getNearestIntersection(const RS_Vector& coord,
                                      double* dist = nullptr);
     RS_Vector getNearestVirtualIntersection(const RS_Vector& coord,
@@ -198,6 +207,12 @@ public:
                                             double* dist);
     RS_Vector getNearestRef(const RS_Vector& coord,
                             double* dist = nullptr) const override;
+    /**
+     * @brief getEntitiesInWindow find entities which may intersect the given window, by the spatial index
+     * @param entities - candidate entities, in container order
+     * @return false, if no spatial index is used by this container, so all entities should be visited
+     */
+    bool getEntitiesInWindow(const LC_Rect& window, std::vector<RS_Entity*>& entities) const;
     RS_Vector getNearestSelectedRef(const RS_Vector& coord,
                                     double* dist = nullptr) const override;
 
@@ -249,11 +264,23 @@ public:
 
     void push_back(RS_Entity* entity) {
         m_entities.push_back(entity);
+        invalidateSpatialIndex();
     }
     void pop_back()
     {
         if (!isEmpty())
             m_entities.pop_back();
+        invalidateSpatialIndex();
+    }
+
+    /**
+     * Marks the spatial index outdated, so it's rebuilt by the next nearest
+     * entity query. Needed when entities of this container are modified
+     * in place without a border update of this container.
+     */
+    void invalidateSpatialIndex() const {
+        m_spatialIndexValid = false;
+        clearIntersectionCache();
     }
 
 /**
@@ -274,6 +301,11 @@ public:
 //! \}
 
     const QList<RS_Entity*>& getEntityList();
+    /**
+     * @brief sortByContainerOrder sort entities of this container by their order in it,
+     * by the spatial index for large containers. Entities not in this container are dropped.
+     */
+    void sortByContainerOrder(std::vector<RS_Entity*>& entities) const;
 
     inline RS_Entity* unsafeEntityAt(int index) const {return m_entities.at(index);}
 
@@ -302,6 +334,28 @@ private:
  */
     bool ignoredSnap() const;
 
+    /**
+     * @brief spatialIndex the spatial index of entities, built on demand
+     * @return nullptr, if this container is too small to benefit from indexing
+     */
+    LC_EntityRTree* spatialIndex() const;
+    void indexEntity(RS_Entity* entity, bool prepended);
+    void clearIntersectionCache() const;
+    /**
+     * @brief collectIntersectionCandidates collect atomic entities, texts and images, with bounding
+     * boxes overlapping the given box, in container order
+     */
+    void collectIntersectionCandidates(const LC_Rect& box, std::vector<RS_Entity*>& candidates) const;
+    /**
+     * @brief visitNearest visit entities as candidates of nearest queries. For large
+     * containers, entities are visited by increasing distance to their bounding boxes,
+     * until the box distance exceeds minDist; otherwise, all entities are visited in
+     * container order. The visitor is given the entity and its container order.
+     * @param minDist - the current minimum distance, updated by the visitor
+     */
+    void visitNearest(const RS_Vector& coord, const double& minDist,
+                      const std::function<void(RS_Entity*, long long)>& visitor) const;
+
     /** m_entities in the container */
     QList<RS_Entity *> m_entities;
     /**
@@ -312,6 +366,15 @@ private:
     mutable int entIdx = 0;
     bool autoDelete = false;
 
+    /** spatial index of m_entities for nearest entity queries */
+    mutable std::unique_ptr<LC_EntityRTree> m_spatialIndex;
+    mutable bool m_spatialIndexValid = false;
+    /** RS_LayerList::getConstructionChanges() when the spatial index was built */
+    mutable unsigned long m_spatialIndexConstructionChanges = 0;
+    /** container orders of entities added since the index was built */
+    mutable long long m_spatialOrderFirst = 0;
+    mutable long long m_spatialOrderLast = 0;
+
 
 };
 
@@ -0,0 +1,299 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+
+#include "lc_entitypool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace {
+    // size of memory block shared by pooled objects, slabs are aligned to it
+    constexpr size_t SLAB_SIZE = 64 * 1024;
+    // pools with a higher index aren't cached by threads
+    constexpr size_t MAX_CACHED_POOLS = 16;
+    // free slots moved between a thread cache and the slabs at once
+    constexpr size_t CACHE_BATCH = 32;
+    // free slots a thread keeps per pool
+    constexpr size_t CACHE_CAPACITY = 2 * CACHE_BATCH;
+    // slabs without objects kept by a pool, so deleting and creating a few entities
+    // doesn't release and allocate slabs repeatedly
+    constexpr size_t MAX_EMPTY_SLABS = 2;
+
+    std::mutex& registryMutex() {
+        static auto* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    std::vector<LC_EntityPool*>& registry() {
+        static auto* pools = new std::vector<LC_EntityPool*>();
+        return *pools;
+    }
+}
+
+struct LC_EntityPool::ThreadCache {
+    FreeSlot* slots;
+    size_t count;
+};
+
+/**
+ * Caches of a thread, trivially destructible, so they stay usable for entities deleted
+ * by static destructors after the caches are flushed.
+ */
+struct LC_EntityPool::ThreadCaches {
+    ThreadCache caches[MAX_CACHED_POOLS];
+    bool registered;
+    bool closed;
+};
+
+/**
+ * Returns cached slots of the exiting thread to their pools.
+ */
+struct LC_EntityPool::ThreadCachesFlusher {
+    ~ThreadCachesFlusher();
+    void touch() {}
+};
+
+thread_local LC_EntityPool::ThreadCaches LC_EntityPool::s_threadCaches{};
+thread_local LC_EntityPool::ThreadCachesFlusher LC_EntityPool::s_threadCachesFlusher;
+
+LC_EntityPool::ThreadCachesFlusher::~ThreadCachesFlusher() {
+    std::vector<LC_EntityPool*> pools;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        pools = registry();
+    }
+    s_threadCaches.closed = true;
+    for (size_t i = 0; i < std::min(pools.size(), MAX_CACHED_POOLS); ++i) {
+        ThreadCache& cache = s_threadCaches.caches[i];
+        pools[i]->returnSlots(cache.slots);
+        cache.slots = nullptr;
+        cache.count = 0;
+    }
+}
+
+LC_EntityPool::LC_EntityPool(const char* typeName, size_t objectSize)
+    : m_typeName{typeName}
+    , m_objectSize{objectSize} {
+    constexpr size_t alignment = alignof(std::max_align_t);
+    m_slotSize = (std::max(objectSize, sizeof(FreeSlot)) + alignment - 1) / alignment * alignment;
+    m_slotsPerSlab = std::max<size_t>(1, (SLAB_SIZE - sizeof(Slab)) / m_slotSize);
+
+    std::lock_guard<std::mutex> lock(registryMutex());
+    m_index = registry().size();
+    registry().push_back(this);
+}
+
+/**
+ * @return cache of the calling thread for this pool, nullptr if the thread has exited or
+ * the pool isn't cached
+ */
+LC_EntityPool::ThreadCache* LC_EntityPool::threadCache() noexcept {
+    ThreadCaches& caches = s_threadCaches;
+    if (caches.closed || m_index >= MAX_CACHED_POOLS) {
+        return nullptr;
+    }
+    if (!caches.registered) {
+        caches.registered = true;
+        s_threadCachesFlusher.touch();
+    }
+    return &caches.caches[m_index];
+}
+
+void LC_EntityPool::addSlab() {
+    auto* memory = static_cast<char*>(::operator new(SLAB_SIZE, std::align_val_t{SLAB_SIZE}));
+    auto* slab = new (memory) Slab{nullptr, m_freeSlabs, nullptr, 0};
+    // slots start after the header, aligned as the slot size
+    char* slots = memory + (sizeof(Slab) + m_slotSize - 1) / m_slotSize * m_slotSize;
+    size_t count = std::min(m_slotsPerSlab, size_t(memory + SLAB_SIZE - slots) / m_slotSize);
+    // link slots in the address order, so objects allocated in sequence are adjacent
+    for (size_t i = count; i > 0; --i) {
+        auto* slot = reinterpret_cast<FreeSlot*>(slots + (i - 1) * m_slotSize);
+        slot->next = slab->freeSlots;
+        slab->freeSlots = slot;
+    }
+    if (m_freeSlabs != nullptr) {
+        m_freeSlabs->prev = slab;
+    }
+    m_freeSlabs = slab;
+    ++m_slabCount;
+    ++m_emptySlabs;
+}
+
+void LC_EntityPool::unlinkSlab(Slab* slab) noexcept {
+    if (slab->prev != nullptr) {
+        slab->prev->next = slab->next;
+    } else {
+        m_freeSlabs = slab->next;
+    }
+    if (slab->next != nullptr) {
+        slab->next->prev = slab->prev;
+    }
+    slab->prev = nullptr;
+    slab->next = nullptr;
+}
+
+/**
+ * Takes up to count free slots from the slabs, adding a slab if there are none.
+ * @return taken slots linked to a list
+ */
+LC_EntityPool::FreeSlot* LC_EntityPool::takeSlots(size_t count, size_t& taken) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_freeSlabs == nullptr) {
+        addSlab();
+    }
+    FreeSlot* result = nullptr;
+    taken = 0;
+    while (taken < count && m_freeSlabs != nullptr) {
+        Slab* slab = m_freeSlabs;
+        FreeSlot* slot = slab->freeSlots;
+        slab->freeSlots = slot->next;
+        if (slab->usedSlots++ == 0) {
+            --m_emptySlabs;
+        }
+        if (slab->freeSlots == nullptr) {
+            unlinkSlab(slab);
+        }
+        slot->next = result;
+        result = slot;
+        ++taken;
+    }
+    m_usedSlots += taken;
+    m_peakSlots = std::max(m_peakSlots, m_usedSlots);
+    return result;
+}
+
+void LC_EntityPool::returnSlots(FreeSlot* slots) noexcept {
+    if (slots == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (slots != nullptr) {
+        FreeSlot* next = slots->next;
+        returnSlot(slots);
+        slots = next;
+    }
+}
+
+/**
+ * Returns the slot to its slab, the lock must be held. Slabs without used slots are
+ * released, except for a few kept for subsequent allocations.
+ */
+void LC_EntityPool::returnSlot(FreeSlot* slot) noexcept {
+    auto* slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(slot) & ~uintptr_t(SLAB_SIZE - 1));
+    if (slab->freeSlots == nullptr) {
+        slab->next = m_freeSlabs;
+        if (m_freeSlabs != nullptr) {
+            m_freeSlabs->prev = slab;
+        }
+        m_freeSlabs = slab;
+    }
+    slot->next = slab->freeSlots;
+    slab->freeSlots = slot;
+    --m_usedSlots;
+    if (--slab->usedSlots == 0) {
+        if (m_emptySlabs < MAX_EMPTY_SLABS) {
+            ++m_emptySlabs;
+        } else {
+            unlinkSlab(slab);
+            slab->~Slab();
+            ::operator delete(slab, std::align_val_t{SLAB_SIZE});
+            --m_slabCount;
+        }
+    }
+}
+
+void* LC_EntityPool::allocate(size_t size) {
+    if (size != m_objectSize) {
+        ++m_heapAllocations;
+        return ::operator new(size);
+    }
+    ThreadCache* cache = threadCache();
+    if (cache == nullptr) {
+        size_t taken = 0;
+        return takeSlots(1, taken);
+    }
+    if (cache->slots == nullptr) {
+        cache->slots = takeSlots(CACHE_BATCH, cache->count);
+    }
+    FreeSlot* slot = cache->slots;
+    cache->slots = slot->next;
+    --cache->count;
+    return slot;
+}
+
+void LC_EntityPool::deallocate(void* object, size_t size) noexcept {
+    if (object == nullptr) {
+        return;
+    }
+    if (size != m_objectSize) {
+        --m_heapAllocations;
+        ::operator delete(object);
+        return;
+    }
+    auto* slot = static_cast<FreeSlot*>(object);
+    ThreadCache* cache = threadCache();
+    if (cache == nullptr) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        returnSlot(slot);
+        return;
+    }
+    slot->next = cache->slots;
+    cache->slots = slot;
+    if (++cache->count > CACHE_CAPACITY) {
+        // keep the most recently freed slots, return the others
+        FreeSlot* last = cache->slots;
+        for (size_t i = 1; i < CACHE_BATCH; ++i) {
+            last = last->next;
+        }
+        FreeSlot* returned = last->next;
+        last->next = nullptr;
+        cache->count = CACHE_BATCH;
+        returnSlots(returned);
+    }
+}
+
+LC_EntityPool::Statistics LC_EntityPool::getStatistics() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Statistics result;
+    result.typeName = m_typeName;
+    result.objectSize = m_slotSize;
+    result.liveObjects = m_usedSlots;
+    result.peakObjects = m_peakSlots;
+    result.reservedBytes = m_slabCount * SLAB_SIZE;
+    result.heapAllocations = m_heapAllocations;
+    return result;
+}
+
+std::vector<LC_EntityPool::Statistics> LC_EntityPool::getAllStatistics() {
+    std::vector<LC_EntityPool*> pools;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        pools = registry();
+    }
+    std::vector<Statistics> result;
+    result.reserve(pools.size());
+    for (const LC_EntityPool* pool : pools) {
+        result.push_back(pool->getStatistics());
+    }
+    return result;
+}
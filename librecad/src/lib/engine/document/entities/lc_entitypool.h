@@ -0,0 +1,146 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#ifndef LC_ENTITYPOOL_H
+#define LC_ENTITYPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * Pool allocator for objects of a single entity class.
+ *
+ * Objects are placed into slabs of fixed size, so entities created one after
+ * another (e.g. by import of a large file) are adjacent in memory, and the
+ * heap is not fragmented by millions of small allocations. Slots of deleted
+ * objects are reused by subsequent allocations, and slabs without objects are
+ * released, so closing a large document returns its memory.
+ *
+ * Each thread keeps a small cache of free slots per pool, so allocations and
+ * deletions lock the pool only to move batches of slots between the cache
+ * and the slabs.
+ *
+ * Allocations of other size than the pooled class (i.e. of derived classes)
+ * are passed to the global heap.
+ *
+ * Pools are used via LC_DECLARE_POOL_ALLOCATION and LC_DEFINE_POOL_ALLOCATION macros,
+ * each pool registers itself, so the memory used by entities may be reported.
+ */
+class LC_EntityPool {
+public:
+    struct Statistics {
+        const char* typeName = "";
+        // size of a slot of the pooled object
+        size_t objectSize = 0;
+        // slots taken from slabs, including free slots cached by threads
+        size_t liveObjects = 0;
+        size_t peakObjects = 0;
+        // memory allocated for slabs
+        size_t reservedBytes = 0;
+        // live objects of other size (derived classes), allocated on the global heap
+        size_t heapAllocations = 0;
+    };
+
+    LC_EntityPool(const char* typeName, size_t objectSize);
+    LC_EntityPool(const LC_EntityPool&) = delete;
+    LC_EntityPool& operator=(const LC_EntityPool&) = delete;
+
+    void* allocate(size_t size);
+    void deallocate(void* object, size_t size) noexcept;
+
+    Statistics getStatistics() const;
+    /** @return statistics of all entity pools */
+    static std::vector<Statistics> getAllStatistics();
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    /**
+     * Header at the start of a slab. Slabs are aligned to their size, so the slab of
+     * an object is found from its address.
+     */
+    struct Slab {
+        // links of slabs with free slots
+        Slab* prev;
+        Slab* next;
+        FreeSlot* freeSlots;
+        size_t usedSlots;
+    };
+
+    struct ThreadCache;
+    struct ThreadCaches;
+    struct ThreadCachesFlusher;
+
+    static thread_local ThreadCaches s_threadCaches;
+    static thread_local ThreadCachesFlusher s_threadCachesFlusher;
+
+    ThreadCache* threadCache() noexcept;
+    FreeSlot* takeSlots(size_t count, size_t& taken);
+    void returnSlots(FreeSlot* slots) noexcept;
+    void returnSlot(FreeSlot* slot) noexcept;
+    void addSlab();
+    void unlinkSlab(Slab* slab) noexcept;
+
+    mutable std::mutex m_mutex;
+    const char* m_typeName;
+    size_t m_objectSize;
+    size_t m_slotSize;
+    size_t m_slotsPerSlab;
+    // index of the pool in the registry and in caches of threads
+    size_t m_index = 0;
+    Slab* m_freeSlabs = nullptr;
+    size_t m_slabCount = 0;
+    size_t m_emptySlabs = 0;
+    size_t m_usedSlots = 0;
+    size_t m_peakSlots = 0;
+    std::atomic<size_t> m_heapAllocations{0};
+};
+
+/**
+ * Declares class specific operators new and delete, placing objects of the class into the entity pool.
+ */
+#define LC_DECLARE_POOL_ALLOCATION \
+    static void* operator new(std::size_t size); \
+    static void operator delete(void* object, std::size_t size) noexcept;
+
+/**
+ * Defines operators declared by LC_DECLARE_POOL_ALLOCATION, should be used in the source file of the class.
+ * The pool is never destroyed, as entities may be deleted by static destructors.
+ */
+#define LC_DEFINE_POOL_ALLOCATION(Class, typeName) \
+    namespace { \
+        LC_EntityPool& Class##_pool() { \
+            static auto* pool = new LC_EntityPool(typeName, sizeof(Class)); \
+            return *pool; \
+        } \
+    } \
+    void* Class::operator new(std::size_t size) { \
+        return Class##_pool().allocate(size); \
+    } \
+    void Class::operator delete(void* object, std::size_t size) noexcept { \
+        Class##_pool().deallocate(object, size); \
+    }
+
+#endif // LC_ENTITYPOOL_H
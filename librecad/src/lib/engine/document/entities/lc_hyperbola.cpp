@@ -24,6 +24,8 @@
 **
 **********************************************************************/
 
+#include <cassert>
+
 #include "lc_hyperbola.h"
 
 #include "lc_quadratic.h"
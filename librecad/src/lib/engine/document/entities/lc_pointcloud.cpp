@@ -0,0 +1,249 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#include "lc_pointcloud.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "rs_math.h"
+#include "rs_painter.h"
+
+void LC_PointCloudData::reserve(size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+}
+
+void LC_PointCloudData::append(double px, double py, double pz, int number, const QString &code) {
+    const size_t index = x.size();
+    x.push_back(px);
+    y.push_back(py);
+    if (!z.empty() || std::abs(pz) > RS_TOLERANCE) {
+        z.resize(index, 0.);
+        z.push_back(pz);
+    }
+    if (!numbers.empty() || number != 0) {
+        numbers.resize(index, 0);
+        numbers.push_back(number);
+    }
+    if (!codes.empty() || !code.isEmpty()) {
+        codes.resize(index);
+        codes.push_back(code);
+    }
+}
+
+LC_PointCloud::LC_PointCloud(RS_EntityContainer* parent, LC_PointCloudData d)
+    :RS_AtomicEntity(parent), data(std::move(d)) {
+    calculateBorders();
+}
+
+RS_Entity* LC_PointCloud::clone() const {
+    auto* p = new LC_PointCloud(*this);
+    return p;
+}
+
+RS2::EntityType LC_PointCloud::rtti() const {
+    return RS2::EntityPointCloud;
+}
+
+void LC_PointCloud::calculateBorders() {
+    if (data.empty()) {
+        minV = maxV = RS_Vector{0., 0.};
+        return;
+    }
+    const auto [minX, maxX] = std::minmax_element(data.x.cbegin(), data.x.cend());
+    const auto [minY, maxY] = std::minmax_element(data.y.cbegin(), data.y.cend());
+    minV = RS_Vector{*minX, *minY};
+    maxV = RS_Vector{*maxX, *maxY};
+}
+
+/**
+ * Builds the grid index of points.
+ */
+void LC_PointCloud::buildGrid() const {
+    const size_t count = data.size();
+    const double width = std::max(maxV.x - minV.x, RS_TOLERANCE);
+    const double height = std::max(maxV.y - minV.y, RS_TOLERANCE);
+    m_gridCellSize = std::max(std::sqrt(width * height / count), std::max(width, height) / 4096.);
+    m_gridColumns = int(width / m_gridCellSize) + 1;
+    m_gridRows = int(height / m_gridCellSize) + 1;
+
+    const size_t cells = size_t(m_gridColumns) * m_gridRows;
+    std::vector<unsigned> pointCells(count);
+    m_gridCellStart.assign(cells + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+        const int column = std::min(int((data.x[i] - minV.x) / m_gridCellSize), m_gridColumns - 1);
+        const int row = std::min(int((data.y[i] - minV.y) / m_gridCellSize), m_gridRows - 1);
+        pointCells[i] = unsigned(row) * m_gridColumns + column;
+        m_gridCellStart[pointCells[i] + 1]++;
+    }
+    for (size_t c = 0; c < cells; c++) {
+        m_gridCellStart[c + 1] += m_gridCellStart[c];
+    }
+    m_gridPoints.resize(count);
+    std::vector<unsigned> next(m_gridCellStart.cbegin(), m_gridCellStart.cend() - 1);
+    for (size_t i = 0; i < count; i++) {
+        m_gridPoints[next[pointCells[i]]++] = unsigned(i);
+    }
+}
+
+void LC_PointCloud::invalidateGrid() {
+    m_gridCellStart.clear();
+    m_gridPoints.clear();
+}
+
+size_t LC_PointCloud::findNearestPoint(const RS_Vector &coord, double* dist) const {
+    const size_t count = data.size();
+    size_t nearest = count;
+    double nearestDist = RS_MAXDOUBLE;
+    if (count > 0) {
+        if (m_gridCellStart.empty()) {
+            buildGrid();
+        }
+        // cell of the coordinate, clamped to the grid
+        const int column = std::clamp(int(std::floor((coord.x - minV.x) / m_gridCellSize)), 0, m_gridColumns - 1);
+        const int row = std::clamp(int(std::floor((coord.y - minV.y) / m_gridCellSize)), 0, m_gridRows - 1);
+        // distance from the coordinate to the grid, if it's outside
+        const double outside = std::hypot(std::max({minV.x - coord.x, coord.x - maxV.x, 0.}),
+                                          std::max({minV.y - coord.y, coord.y - maxV.y, 0.}));
+        const int maxRing = std::max({column, row, m_gridColumns - 1 - column, m_gridRows - 1 - row});
+
+        // search rings of cells around the cell, until points of further rings can't be nearer
+        for (int ring = 0; ring <= maxRing; ring++) {
+            if (nearest < count && std::hypot(outside, std::max(ring - 1, 0) * m_gridCellSize) > nearestDist) {
+                break;
+            }
+            for (int r = row - ring; r <= row + ring; r++) {
+                if (r < 0 || r >= m_gridRows) {
+                    continue;
+                }
+                const bool edgeRow = r == row - ring || r == row + ring;
+                const int step = edgeRow ? 1 : 2 * ring;
+                for (int c = column - ring; c <= column + ring; c += std::max(step, 1)) {
+                    if (c < 0 || c >= m_gridColumns) {
+                        continue;
+                    }
+                    const size_t cell = size_t(r) * m_gridColumns + c;
+                    for (unsigned k = m_gridCellStart[cell]; k < m_gridCellStart[cell + 1]; k++) {
+                        const unsigned i = m_gridPoints[k];
+                        const double d = std::hypot(data.x[i] - coord.x, data.y[i] - coord.y);
+                        if (d < nearestDist) {
+                            nearestDist = d;
+                            nearest = i;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (dist) {
+        *dist = nearestDist;
+    }
+    return nearest;
+}
+
+RS_Vector LC_PointCloud::getNearestEndpoint(const RS_Vector &coord, double* dist) const {
+    const size_t nearest = findNearestPoint(coord, dist);
+    return nearest < data.size() ? data.getPoint(nearest) : RS_Vector(false);
+}
+
+RS_Vector LC_PointCloud::getNearestPointOnEntity(const RS_Vector &coord,
+                                                 bool /*onEntity*/, double* dist, RS_Entity** entity) const {
+    if (entity) {
+        *entity = const_cast<LC_PointCloud*>(this);
+    }
+    return getNearestEndpoint(coord, dist);
+}
+
+RS_Vector LC_PointCloud::getNearestCenter(const RS_Vector & /*coord*/, double* dist) const {
+    if (dist) {
+        *dist = RS_MAXDOUBLE;
+    }
+    return RS_Vector(false);
+}
+
+RS_Vector LC_PointCloud::getNearestMiddle(const RS_Vector & /*coord*/,
+                                          double* dist,
+                                          int /*middlePoints*/) const {
+    if (dist) {
+        *dist = RS_MAXDOUBLE;
+    }
+    return RS_Vector(false);
+}
+
+RS_Vector LC_PointCloud::getNearestDist(double /*distance*/,
+                                        const RS_Vector & /*coord*/,
+                                        double* dist) const {
+    if (dist) {
+        *dist = RS_MAXDOUBLE;
+    }
+    return RS_Vector(false);
+}
+
+template<class Transform>
+void LC_PointCloud::transformPoints(Transform transform) {
+    for (size_t i = 0, count = data.size(); i < count; i++) {
+        RS_Vector p{data.x[i], data.y[i]};
+        transform(p);
+        data.x[i] = p.x;
+        data.y[i] = p.y;
+    }
+    invalidateGrid();
+    calculateBorders();
+}
+
+void LC_PointCloud::move(const RS_Vector &offset) {
+    transformPoints([&offset](RS_Vector &p) {p.move(offset);});
+}
+
+void LC_PointCloud::rotate(const RS_Vector &center, double angle) {
+    rotate(center, RS_Vector{angle});
+}
+
+void LC_PointCloud::rotate(const RS_Vector &center, const RS_Vector &angleVector) {
+    transformPoints([&center, &angleVector](RS_Vector &p) {p.rotate(center, angleVector);});
+}
+
+void LC_PointCloud::scale(const RS_Vector &center, const RS_Vector &factor) {
+    transformPoints([&center, &factor](RS_Vector &p) {p.scale(center, factor);});
+}
+
+void LC_PointCloud::mirror(const RS_Vector &axisPoint1, const RS_Vector &axisPoint2) {
+    transformPoints([&axisPoint1, &axisPoint2](RS_Vector &p) {p.mirror(axisPoint1, axisPoint2);});
+}
+
+RS_Entity &LC_PointCloud::shear(double k) {
+    transformPoints([k](RS_Vector &p) {p.shear(k);});
+    return *this;
+}
+
+void LC_PointCloud::draw(RS_Painter* painter) {
+    painter->drawPointEntitiesWCS(data.x, data.y);
+}
+
+/**
+ * Dumps the point cloud's data to stdout.
+ */
+std::ostream &operator << (std::ostream &os, const LC_PointCloud &p) {
+    os << " PointCloud: " << p.size() << " points, " << p.getMin() << " - " << p.getMax() << "\n";
+    return os;
+}
@@ -0,0 +1,125 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#ifndef LC_POINTCLOUD_H
+#define LC_POINTCLOUD_H
+
+#include <vector>
+
+#include <QString>
+
+#include "rs_atomicentity.h"
+
+/**
+ * Points of a point cloud, stored as structure of arrays. Elevations, numbers and codes
+ * of points are optional: the arrays are empty if no point has them, otherwise they have
+ * an item per point.
+ */
+struct LC_PointCloudData {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    std::vector<int> numbers;
+    std::vector<QString> codes;
+
+    size_t size() const {return x.size();}
+    bool empty() const {return x.empty();}
+    void reserve(size_t count);
+    /**
+     * Appends a point. Optional arrays are created when the first point with the attribute
+     * is appended.
+     */
+    void append(double px, double py, double pz = 0., int number = 0, const QString& code = {});
+    RS_Vector getPoint(size_t index) const {return {x[index], y[index]};}
+    double getElevation(size_t index) const {return z.empty() ? 0. : z[index];}
+    bool hasNumbers() const {return !numbers.empty();}
+    bool hasCodes() const {return !codes.empty();}
+};
+
+/**
+ * Compact entity for large point sets (e.g. survey observations). Points are drawn as point
+ * entities, with $PDMODE and $PDSIZE of the drawing, by a single batched painter call, and
+ * share the attributes (layer, pen) of the cloud.
+ *
+ * A point cloud costs about 16 bytes per point (plus optional attributes), instead of an
+ * entity per point. Snapping to the nearest point uses a grid index of the points, built
+ * on demand. A point cloud is written to DXF as ordinary POINT entities.
+ */
+class LC_PointCloud: public RS_AtomicEntity {
+public:
+    LC_PointCloud(RS_EntityContainer* parent, LC_PointCloudData d);
+    RS_Entity* clone() const override;
+    /** @return RS2::EntityPointCloud */
+    RS2::EntityType rtti() const override;
+
+    const LC_PointCloudData& getData() const {return data;}
+    size_t size() const {return data.size();}
+
+    RS_Vector getNearestEndpoint(const RS_Vector& coord,
+                                 double* dist = nullptr) const override;
+    RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+                                      bool onEntity = true, double* dist = nullptr,
+                                      RS_Entity** entity = nullptr) const override;
+    RS_Vector getNearestCenter(const RS_Vector& coord,
+                               double* dist = nullptr) const override;
+    RS_Vector getNearestMiddle(const RS_Vector& coord,
+                               double* dist = nullptr,
+                               int middlePoints = 1) const override;
+    RS_Vector getNearestDist(double distance,
+                             const RS_Vector& coord,
+                             double* dist = nullptr) const override;
+    /**
+     * @return index of the point nearest to the coordinate, or size() if the cloud is empty
+     */
+    size_t findNearestPoint(const RS_Vector& coord, double* dist = nullptr) const;
+
+    void move(const RS_Vector& offset) override;
+    void rotate(const RS_Vector& center, double angle) override;
+    void rotate(const RS_Vector& center, const RS_Vector& angleVector) override;
+    void scale(const RS_Vector& center, const RS_Vector& factor) override;
+    void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) override;
+    RS_Entity& shear(double k) override;
+
+    void calculateBorders() override;
+    void draw(RS_Painter* painter) override;
+
+    friend std::ostream& operator << (std::ostream& os, const LC_PointCloud& p);
+
+private:
+    LC_PointCloudData data;
+
+    /**
+     * Uniform grid of the bounding box, about a point per cell. Indices of points of a cell
+     * are stored contiguously, cell c holds m_gridPoints[m_gridCellStart[c] .. m_gridCellStart[c+1]).
+     */
+    mutable std::vector<unsigned> m_gridCellStart;
+    mutable std::vector<unsigned> m_gridPoints;
+    mutable int m_gridColumns = 0;
+    mutable int m_gridRows = 0;
+    mutable double m_gridCellSize = 0.;
+
+    template<class Transform>
+    void transformPoints(Transform transform);
+    void buildGrid() const;
+    void invalidateGrid();
+};
+
+#endif // LC_POINTCLOUD_H
@@ -24,6 +24,8 @@
 **
 **********************************************************************/
 
+#include <cassert>
+
 #include "rs_arc.h"
 
 #include "lc_quadratic.h"
@@ -38,6 +40,7 @@
 #include "emu_c99.h"
 #endif
 
+LC_DEFINE_POOL_ALLOCATION(RS_Arc, "Arc")
 
 RS_ArcData::RS_ArcData(const RS_Vector& _center,
 					   double _radius,
@@ -28,6 +28,7 @@
 #define RS_ARC_H
 
 #include "lc_cachedlengthentity.h"
+#include "lc_entitypool.h"
 
 class LC_Quadratic;
 
@@ -69,6 +70,8 @@ std::ostream& operator << (std::ostream& os, const RS_ArcData& ad);
  */
 class RS_Arc : public LC_CachedLengthEntity {
 public:
+    LC_DECLARE_POOL_ALLOCATION
+
     RS_Arc()=default;
     RS_Arc(RS_EntityContainer* parent,
            const RS_ArcData& d);
@@ -27,6 +27,7 @@
 **********************************************************************/
 
 
+#include <cassert>
 #include <vector>
 
 #include "lc_quadratic.h"
@@ -38,6 +39,7 @@
 #include "rs_math.h"
 #include "rs_painter.h"
 
+LC_DEFINE_POOL_ALLOCATION(RS_Circle, "Circle")
 
 namespace {
 // tangent condition tolerance
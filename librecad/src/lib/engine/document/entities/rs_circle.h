@@ -31,6 +31,7 @@
 
 #include "rs_vector.h"
 #include "lc_cachedlengthentity.h"
+#include "lc_entitypool.h"
 
 class LC_Quadratic;
 
@@ -55,6 +56,8 @@ std::ostream& operator << (std::ostream& os, const RS_CircleData& ad);
  */
 class RS_Circle : public LC_CachedLengthEntity {
 public:
+    LC_DECLARE_POOL_ALLOCATION
+
 	RS_Circle()=default;
     RS_Circle (RS_EntityContainer* parent,
                const RS_CircleData& d);
@@ -26,6 +26,7 @@
 **********************************************************************/
 
 
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <utility>
@@ -65,6 +66,16 @@ struct RS_Entity::Impl {
     }
 };
 
+namespace {
+// inserts drawn as instances of a block share geometry flattened from its entities,
+// which is outdated when an entity of the block changes
+void invalidateBlockGeometry(RS_EntityContainer* parent) {
+    if (parent != nullptr && parent->rtti() == RS2::EntityBlock) {
+        static_cast<RS_Block*>(parent)->invalidateInstanceGeometry();
+    }
+}
+}
+
 /**
  * @param parent The parent entity of this entity.
  *               E.g. a line might have a graphic entity or
@@ -123,7 +134,13 @@ RS_Entity& RS_Entity::operator = (RS_Entity&& other)
     return *this;
 }
 
-RS_Entity::~RS_Entity() = default;
+RS_Entity::~RS_Entity() {
+    // entities may be deleted without removal from the document, which tracks the selected ones.
+    // While the document itself is destroyed, its children see it as a plain container.
+    if (parent != nullptr && parent->isDocument()) {
+        static_cast<RS_Document*>(parent)->selectionChanged(this, false);
+    }
+}
 
 /**
  * Copy constructor.
@@ -161,7 +178,8 @@ void RS_Entity::init() {
  * Gives this entity a new unique m_id.
  */
 void RS_Entity::initId() {
-    static unsigned long long idCounter=0;
+    // atomic, as temporary entities may be created by worker threads (hatch trimming)
+    static std::atomic<unsigned long long> idCounter{0};
     m_id = ++idCounter;
 }
 
@@ -209,6 +227,15 @@ bool RS_Entity::setSelected(bool select) {
         delFlag(RS2::FlagSelected);
     }
 
+    // the document tracks its entities which are selected or contain selected entities
+    RS_Entity* topLevel = this;
+    while (topLevel->parent != nullptr && !topLevel->parent->isDocument()) {
+        topLevel = topLevel->parent;
+    }
+    if (topLevel->parent != nullptr && (select || topLevel == this)) {
+        static_cast<RS_Document*>(topLevel->parent)->selectionChanged(topLevel, select);
+    }
+
     return true;
 }
 
@@ -271,6 +298,7 @@ bool RS_Entity::isProcessed() const {
  *               false: entity has become visible.
  */
 void RS_Entity::undoStateChanged([[maybe_unused]] bool undone){
+    invalidateBlockGeometry(parent);
     setSelected(false);
     update();
 }
@@ -760,6 +788,7 @@ void RS_Entity::setLayer(const QString& name) {
     } else {
         m_layer = nullptr;
     }
+    invalidateBlockGeometry(parent);
 }
 
 /**
@@ -767,6 +796,7 @@ void RS_Entity::setLayer(const QString& name) {
  */
 void RS_Entity::setLayer(RS_Layer* l) {
     m_layer = l;
+    invalidateBlockGeometry(parent);
 }
 
 /**
@@ -865,6 +895,7 @@ RS_Pen RS_Entity::getPen(bool resolve) const {
 
 void RS_Entity::setPen(const RS_Pen& pen) {
     m_pImpl->pen = pen;
+    invalidateBlockGeometry(parent);
 }
 
 /**
@@ -25,11 +25,16 @@
 **********************************************************************/
 
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <set>
 
 #include <QPainterPath>
 
 #include "lc_looputils.h"
+#include "lc_parallel.h"
+#include "lc_rect.h"
+#include "lc_rtree.h"
 #include "rs_arc.h"
 #include "rs_circle.h"
 #include "rs_debug.h"
@@ -90,6 +95,50 @@ namespace{
     }
 }
 
+/**
+ * Entity of the hatch pattern, which is repeated over the contour.
+ */
+struct PatternElement {
+    RS2::EntityType type = RS2::EntityUnknown;
+    RS_Vector startPoint;
+    RS_Vector endPoint;
+    RS_Vector center;
+    double radius = 0.;
+    double angle1 = 0.;
+    double angle2 = 0.;
+    bool reversed = false;
+};
+
+/**
+ * Carpet of pattern copies covering the contour. The copies are not created, each one
+ * is identified by the index ((px - px1) * rows + (py - py1)) * elements.size() + element,
+ * and is moved by dvx * px + dvy * py from the pattern.
+ */
+struct RS_Hatch::PatternCarpet {
+    std::vector<PatternElement> elements;
+    int px1 = 0;
+    int py1 = 0;
+    int columns = 0;
+    int rows = 0;
+    RS_Vector dvx;
+    RS_Vector dvy;
+
+    size_t size() const {
+        return size_t(columns) * size_t(rows) * elements.size();
+    }
+};
+
+/**
+ * Piece of the pattern line or arc that is inside of the contour.
+ */
+struct RS_Hatch::PatternSegment {
+    RS_Vector startPoint;
+    RS_Vector endPoint;
+    RS_Vector center;
+    bool arc = false;
+    bool reversed = false;
+};
+
 RS_HatchData::RS_HatchData(bool solid,
                            double scale,
                            double angle,
@@ -303,30 +352,49 @@ void RS_Hatch::update() {
     pat->rotate(rot_center, data.angle);
     pat->move(-rot_center);
 
-    RS_EntityContainer tmp;   // container for untrimmed lines
-
-    // adding array of patterns to tmp:
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet");
-    for (int px=px1; px<px2; px++) {
-        for (int py=py1; py<py2; py++) {
-            for(auto e: *pat){
-                RS_Entity* te=e->clone();
-                te->move(dvx*px + dvy*py);
-                tmp.addEntity(te);
+    // the pattern carpet is not created, copies of pattern entities are generated by trimming
+    PatternCarpet carpet;
+    carpet.px1 = px1;
+    carpet.py1 = py1;
+    carpet.columns = std::max(0, px2 - px1);
+    carpet.rows = std::max(0, py2 - py1);
+    carpet.dvx = dvx;
+    carpet.dvy = dvy;
+    for(auto e: *pat){
+        PatternElement element;
+        element.type = e->rtti();
+        switch (element.type) {
+            case RS2::EntityLine: {
+                auto* line = static_cast<RS_Line*>(e);
+                element.startPoint = line->getStartpoint();
+                element.endPoint = line->getEndpoint();
+                break;
+            }
+            case RS2::EntityArc: {
+                auto* arc = static_cast<RS_Arc*>(e);
+                element.center = arc->getCenter();
+                element.radius = arc->getRadius();
+                element.angle1 = arc->getAngle1();
+                element.angle2 = arc->getAngle2();
+                element.reversed = arc->isReversed();
+                break;
+            }
+            case RS2::EntityCircle: {
+                auto* circle = static_cast<RS_Circle*>(e);
+                element.center = circle->getCenter();
+                element.radius = circle->getRadius();
+                break;
             }
+            default:
+                // other entities (ellipses) never produce pattern lines
+                continue;
         }
+        carpet.elements.push_back(element);
     }
 
-    // clean memory
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: creating pattern carpet: OK");
-
     // cut pattern to contour shape
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet");
-    // start for very very long for(auto e: tmp) loop
-    RS_EntityContainer tmp2 = trimPattern(tmp);   // container for small cut lines
-    // end for very very long for(auto e: tmp) loop
-
-    // updating hatch / adding entities that are inside
+    std::vector<PatternSegment> segments = trimPattern(carpet);
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: cutting pattern carpet: OK");
 
     // add the hatch pattern entities
@@ -335,42 +403,22 @@ void RS_Hatch::update() {
     hatch->setLayer(hatch_layer);
     hatch->setFlag(RS2::FlagTemp);
 
-    //calculateBorders();
-    for(auto e: tmp2){
-
-        RS_Vector middlePoint;
-        RS_Vector middlePoint2;
-        if (e->rtti()==RS2::EntityLine) {
-            auto* line = static_cast<RS_Line*>(e);
-            middlePoint = line->getMiddlePoint();
-            middlePoint2 = line->getNearestDist(line->getLength()/2.1,
-                                                line->getStartpoint());
-        } else if (e->rtti()==RS2::EntityArc) {
-            auto* arc = static_cast<RS_Arc*>(e);
-            middlePoint = arc->getMiddlePoint();
-            middlePoint2 = arc->getNearestDist(arc->getLength()/2.1,
-                                               arc->getStartpoint());
+    for (const PatternSegment& segment: segments) {
+        RS_Entity* te = nullptr;
+        if (segment.arc) {
+            const RS_Vector& center = segment.center;
+            te = new RS_Arc(hatch, RS_ArcData(center,
+                                              center.distanceTo(segment.startPoint),
+                                              center.angleTo(segment.startPoint),
+                                              center.angleTo(segment.endPoint),
+                                              segment.reversed));
         } else {
-            middlePoint = RS_Vector{false};
-            middlePoint2 = RS_Vector{false};
-        }
-
-        if (middlePoint.valid) {
-            bool onContour=false;
-
-            if (RS_Information::isPointInsideContour(
-                middlePoint,
-                this, &onContour) ||
-                RS_Information::isPointInsideContour(middlePoint2, this)) {
-
-                RS_Entity* te = e->clone();
-                te->setPen(hatch_pen);
-                te->setLayer(hatch_layer);
-                te->reparent(hatch);
-                te->setFlag(RS2::FlagHatchChild);
-                hatch->addEntity(te);
-            }
+            te = new RS_Line{hatch, segment.startPoint, segment.endPoint};
         }
+        te->setPen(hatch_pen);
+        te->setLayer(hatch_layer);
+        te->setFlag(RS2::FlagHatchChild);
+        hatch->addEntity(te);
     }
 
     addEntity(hatch);
@@ -387,159 +435,198 @@ void RS_Hatch::update() {
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Hatch::update: OK");
 }
 
-RS_EntityContainer RS_Hatch::trimPattern(const RS_EntityContainer& patternEntities) const
+/**
+ * Trims the copies of pattern entities of the carpet by the contour, and returns the pieces
+ * inside of the contour, in the order of the carpet. The carpet is split into chunks which
+ * are processed by worker threads, contour edges are indexed by their bounding boxes, so each
+ * pattern entity is intersected only with nearby edges.
+ */
+std::vector<RS_Hatch::PatternSegment> RS_Hatch::trimPattern(const PatternCarpet& carpet) const
 {
     LC_LOG<<"RS_Hatch::"<<__func__<<": begin";
-    RS_EntityContainer trimmed;
-    for(auto* e: patternEntities) {
 
-        if (!e) {
-            RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Hatch::update: nullptr entity found");
-            continue;
+    std::vector<RS_Entity*> edges;
+    for(const RS_Entity* loop: *this){
+        if (loop->isContainer()) {
+            for(auto p: * static_cast<const RS_EntityContainer*>(loop)){
+                edges.push_back(p);
+            }
         }
-
-        RS_Line* line = nullptr;
-        RS_Arc* arc = nullptr;
-        RS_Circle* circle = nullptr;
-        RS_Ellipse* ellipse = nullptr;
-
-        RS_Vector startPoint;
-        RS_Vector endPoint;
-        RS_Vector center{};
-        bool reversed=false;
-
-        switch(e->rtti()) {
-        case RS2::EntityLine:
-            line=static_cast<RS_Line*>(e);
-            startPoint = line->getStartpoint();
-            endPoint = line->getEndpoint();
-            break;
-        case RS2::EntityArc:
-            arc=static_cast<RS_Arc*>(e);
-            startPoint = arc->getStartpoint();
-            endPoint = arc->getEndpoint();
-            center = arc->getCenter();
-            reversed = arc->isReversed();
-            break;
-        case RS2::EntityCircle:
-            circle=static_cast<RS_Circle*>(e);
-            startPoint = circle->getCenter()
-                         + RS_Vector(circle->getRadius(), 0.0);
-            endPoint = startPoint;
-            center = circle->getCenter();
-            break;
-        case RS2::EntityEllipse:
-            ellipse = static_cast<RS_Ellipse*>(e);
-            startPoint = ellipse->getStartpoint();
-            endPoint = ellipse->getEndpoint();
-            center = ellipse->getCenter();
-            reversed = ellipse->isReversed();
-            break;
-        default:
-            continue;
+    }
+    LC_EntityRTree edgesIndex;
+    edgesIndex.Build(edges);
+
+    const size_t carpetSize = carpet.size();
+    const size_t chunks = LC_Parallel::chunksCount(carpetSize, 256);
+
+    // RS_Information::isPointInsideContour() iterates over the contour, so each
+    // worker uses own copy of it
+    std::vector<std::unique_ptr<RS_EntityContainer>> contours;
+    if (chunks > 1) {
+        for (size_t i = 0; i < chunks; ++i) {
+            auto contour = std::make_unique<RS_EntityContainer>(nullptr, true);
+            for(const RS_Entity* loop: *this){
+                contour->addEntity(loop->clone());
+            }
+            contour->forcedCalculateBorders();
+            contours.push_back(std::move(contour));
         }
+    }
 
-        // getting all intersections of this pattern line with the contour:
-        QList<RS_Vector> is;
-
-        for(const RS_Entity* loop: *this){
-
-            if (loop->isContainer()) {
-                for(auto p: * static_cast<const RS_EntityContainer*>(loop)){
-
-                    RS_VectorSolutions sol =
-                        RS_Information::getIntersection(e, p, true);
+    std::vector<std::vector<PatternSegment>> chunkSegments(chunks);
+    LC_Parallel::forEachChunk(carpetSize, chunks, [&](size_t chunk, size_t begin, size_t end) {
+        RS_EntityContainer* contour = contours.empty() ? const_cast<RS_Hatch*>(this) : contours[chunk].get();
+        std::vector<PatternSegment>& trimmed = chunkSegments[chunk];
+        RS_Line probeLine{RS_Vector{0., 0.}, RS_Vector{0., 0.}};
+
+        for (size_t i = begin; i < end; ++i) {
+            const PatternElement& element = carpet.elements[i % carpet.elements.size()];
+            const size_t copyIndex = i / carpet.elements.size();
+            const int px = carpet.px1 + int(copyIndex / carpet.rows);
+            const int py = carpet.py1 + int(copyIndex % carpet.rows);
+            const RS_Vector offset = carpet.dvx*px + carpet.dvy*py;
+
+            std::unique_ptr<RS_Entity> probeCurve;
+            const RS_Entity* e = nullptr;
+            RS_Vector startPoint;
+            RS_Vector endPoint;
+            RS_Vector center{};
+            bool reversed = false;
+
+            switch (element.type) {
+                case RS2::EntityLine:
+                    probeLine.setStartpoint(element.startPoint + offset);
+                    probeLine.setEndpoint(element.endPoint + offset);
+                    startPoint = probeLine.getStartpoint();
+                    endPoint = probeLine.getEndpoint();
+                    e = &probeLine;
+                    break;
+                case RS2::EntityArc: {
+                    auto* arc = new RS_Arc(nullptr, RS_ArcData(element.center + offset, element.radius,
+                                                               element.angle1, element.angle2, element.reversed));
+                    probeCurve.reset(arc);
+                    startPoint = arc->getStartpoint();
+                    endPoint = arc->getEndpoint();
+                    center = arc->getCenter();
+                    reversed = arc->isReversed();
+                    e = arc;
+                    break;
+                }
+                case RS2::EntityCircle: {
+                    auto* circle = new RS_Circle(nullptr, RS_CircleData(element.center + offset, element.radius));
+                    probeCurve.reset(circle);
+                    startPoint = circle->getCenter() + RS_Vector(circle->getRadius(), 0.0);
+                    endPoint = startPoint;
+                    center = circle->getCenter();
+                    e = circle;
+                    break;
+                }
+                default:
+                    continue;
+            }
 
-                    for (const RS_Vector& vp: sol) {
-                        if (vp.valid) {
-                            is.append(vp);
-                            RS_DEBUG->print(RS_Debug::D_DEBUGGING, "  pattern line intersection: %f/%f", vp.x, vp.y);
-                        }
+            // getting all intersections of this pattern line with the contour:
+            QList<RS_Vector> is;
+            LC_Rect probeBox{e->getMin(), e->getMax()};
+            for (RS_Entity* p: edgesIndex.EntitiesInBox(probeBox.increaseBy(RS_TOLERANCE))) {
+                RS_VectorSolutions sol = RS_Information::getIntersection(e, p, true);
+                for (const RS_Vector& vp: sol) {
+                    if (vp.valid) {
+                        is.append(vp);
                     }
                 }
             }
-        }
 
-        QList<RS_Vector> is2;       //to be filled with sorted intersections
-        is2.append(startPoint);
+            QList<RS_Vector> is2;       //to be filled with sorted intersections
+            is2.append(startPoint);
 
-        // sort the intersection points into is2 (only if there are intersections):
-        if(is.size() == 1) {        //only one intersection
-            is2.append(is.first());
-        }
-        else if(is.size() > 1) {
-            RS_Vector sp = startPoint;
-            double sa = center.angleTo(sp);
-            if(ellipse )
-                sa=ellipse->getEllipseAngle(sp);
-            bool done = false;
-            double dist = 0.0;
-            RS_Vector av{};
-            RS_Vector last{};
-            do {    // very long while(!done) loop
-                done = true;
-                double minDist = RS_MAXDOUBLE;
-                av.valid = false;
-                for (const RS_Vector& v: is) {
-                    switch(e->rtti()){
-                    case RS2::EntityLine:
-                        dist = sp.distanceTo(v);
-                        break;
-                    case RS2::EntityArc:
-                    case RS2::EntityCircle:
-                        dist = angularDist(center.angleTo(v), sa, reversed);
-                        break;
-                    case RS2::EntityEllipse:
-                        dist = angularDist(ellipse->getEllipseAngle(v), sa, reversed);
-                        break;
-                    default:
-                        break;
-                    }
+            // sort the intersection points into is2 (only if there are intersections):
+            if(is.size() == 1) {        //only one intersection
+                is2.append(is.first());
+            }
+            else if(is.size() > 1) {
+                RS_Vector sp = startPoint;
+                double sa = center.angleTo(sp);
+                bool done = false;
+                double dist = 0.0;
+                RS_Vector av{};
+                RS_Vector last{};
+                do {
+                    done = true;
+                    double minDist = RS_MAXDOUBLE;
+                    av.valid = false;
+                    for (const RS_Vector& v: is) {
+                        if (element.type == RS2::EntityLine) {
+                            dist = sp.distanceTo(v);
+                        } else {
+                            dist = angularDist(center.angleTo(v), sa, reversed);
+                        }
 
-                    if (dist<minDist) {
-                        minDist = dist;
-                        done = false;
-                        av = v;
+                        if (dist<minDist) {
+                            minDist = dist;
+                            done = false;
+                            av = v;
+                        }
                     }
-                }
 
-                // copy to sorted list, removing double points
-                if (!done && av) {
-                    if (last.valid==false || last.distanceTo(av)>RS_TOLERANCE) {
-                        is2.append(av);
-                        last = av;
+                    // copy to sorted list, removing double points
+                    if (!done && av) {
+                        if (last.valid==false || last.distanceTo(av)>RS_TOLERANCE) {
+                            is2.append(av);
+                            last = av;
+                        }
+                        is.removeOne(av);
+
+                        av.valid = false;
                     }
-                    is.removeOne(av);
+                } while(!done);
+            }
 
-                    av.valid = false;
+            is2.append(endPoint);
+
+            // keep small cut lines / arcs which are inside the contour:
+            for (int k = 1; k < is2.size(); ++k) {
+                const RS_Vector& v1 = is2.at(k-1);
+                const RS_Vector& v2 = is2.at(k);
+
+                RS_Vector middlePoint;
+                RS_Vector middlePoint2;
+                PatternSegment segment{v1, v2, center, false, reversed};
+                if (element.type == RS2::EntityLine) {
+                    middlePoint = (v1 + v2)*0.5;
+                    middlePoint2 = v1 + RS_Vector::polar(v1.distanceTo(v2)/2.1, v1.angleTo(v2));
+                } else {
+                    if(fabs(center.angleTo(v2)-center.angleTo(v1)) <= RS_TOLERANCE_ANGLE) {
+                        //don't create an arc with a too small angle
+                        continue;
+                    }
+                    RS_Arc arc{nullptr, RS_ArcData(center, center.distanceTo(v1),
+                                                   center.angleTo(v1), center.angleTo(v2), reversed)};
+                    middlePoint = arc.getMiddlePoint();
+                    middlePoint2 = arc.getNearestDist(arc.getLength()/2.1, arc.getStartpoint());
+                    segment.arc = true;
                 }
-            } while(!done);
-        }
 
-        is2.append(endPoint);
-
-        // add small cut lines / arcs to tmp2:
-        for (int i = 1; i < is2.size(); ++i) {
-            auto v1 = is2.at(i-1);
-            auto v2 = is2.at(i);
-
-            if (line) {
-                trimmed.addEntity(new RS_Line{&trimmed, v1, v2});
-            } else if (arc || circle) {
-                if(fabs(center.angleTo(v2)-center.angleTo(v1)) > RS_TOLERANCE_ANGLE)
-                {//don't create an arc with a too small angle
-                    trimmed.addEntity(new RS_Arc(&trimmed,
-                                              RS_ArcData(center,
-                                                         center.distanceTo(v1),
-                                                         center.angleTo(v1),
-                                                         center.angleTo(v2),
-                                                         reversed)));
+                bool onContour=false;
+                if (RS_Information::isPointInsideContour(middlePoint, contour, &onContour) ||
+                    RS_Information::isPointInsideContour(middlePoint2, contour)) {
+                    trimmed.push_back(segment);
                 }
             }
         }
+    });
+
+    std::vector<PatternSegment> result;
+    size_t resultSize = 0;
+    for (const auto& segments: chunkSegments) {
+        resultSize += segments.size();
+    }
+    result.reserve(resultSize);
+    for (auto& segments: chunkSegments) {
+        result.insert(result.end(), segments.begin(), segments.end());
     }
     LC_LOG<<"RS_Hatch::"<<__func__<<": done";
-    return trimmed;
+    return result;
 }
 
 /**
@@ -580,13 +667,20 @@ void RS_Hatch::draw(RS_Painter* painter) {
 
 void RS_Hatch::drawSolidFill(RS_Painter *painter) {//area of solid fill. Use polygon approximation, except trivial cases
 
-    if (needOptimization == true) {
-        LC_LoopUtils::LoopOptimizer optimizer{*this};
-        m_orderedLoops = optimizer.GetResults();
-        needOptimization = false;
+    std::shared_ptr<RS_EntityContainer> orderedLoops;
+    {
+        // tiles of the drawing may be rendered concurrently
+        static std::mutex optimizationMutex;
+        std::lock_guard<std::mutex> lock(optimizationMutex);
+        if (needOptimization == true) {
+            LC_LoopUtils::LoopOptimizer optimizer{*this};
+            m_orderedLoops = optimizer.GetResults();
+            needOptimization = false;
+        }
+        orderedLoops = m_orderedLoops;
     }
 
-    if (m_orderedLoops == nullptr)
+    if (orderedLoops == nullptr)
         return;
 
     const QBrush brush(painter->brush());
@@ -28,6 +28,8 @@
 #ifndef RS_HATCH_H
 #define RS_HATCH_H
 
+#include <vector>
+
 #include <QString>
 
 #include "rs_entitycontainer.h"
@@ -164,7 +166,9 @@ public:
 
 private:
     double getTotalAreaImpl() const;
-    RS_EntityContainer trimPattern(const RS_EntityContainer& patternEntities) const;
+    struct PatternCarpet;
+    struct PatternSegment;
+    std::vector<PatternSegment> trimPattern(const PatternCarpet& carpet) const;
 
     void drawSolidFill(RS_Painter *painter);
 
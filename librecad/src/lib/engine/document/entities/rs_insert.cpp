@@ -26,18 +26,27 @@
 
 #include "rs_insert.h"
 
+#include <algorithm>
 #include<iostream>
 
+#include <QPolygonF>
+
+#include "lc_blockgeometry.h"
 #include "rs_arc.h"
 #include "rs_block.h"
 #include "rs_circle.h"
 #include "rs_color.h"
 #include "rs_debug.h"
 #include "rs_ellipse.h"
+#include "rs_font.h"
 #include "rs_graphic.h"
+#include "rs_information.h"
 #include "rs_layer.h"
+#include "rs_line.h"
 #include "rs_math.h"
+#include "rs_painter.h"
 #include "rs_pen.h"
+#include "rs_settings.h"
 
 class RS_Circle;
 class RS_Arc;
@@ -47,6 +56,19 @@ namespace {
 // Minimum scaling factor allowed
 constexpr double MIN_Scale_Factor = 1.0e-6;
 
+// whether inserts may be drawn as instances of their blocks, -1 until read from the settings
+int g_instancingEnabled = -1;
+
+// inserts with non-uniform scales keep copies with entities resolved from their blocks, for
+// queries which can't run in block coordinates; only the recently queried ones keep their copies
+constexpr std::size_t RESOLVED_INSTANCES_LIMIT = 8;
+std::vector<const RS_Insert*> g_resolvedInstances;
+
+// maximum distance of the chords of drawn instance arcs to the arcs, in pixels
+constexpr double UI_ARC_TOLERANCE = 0.25;
+// limit of chords of a drawn instance arc, reached only by arcs far larger than the view
+constexpr int UI_ARC_MAX_SEGMENTS = 2048;
+
 // update the entity pen according to the blockPen
 RS_Pen updatePen(RS_Pen&& pen, const RS_Pen& blockPen)
 {
@@ -119,10 +141,16 @@ RS_Insert::RS_Insert(RS_EntityContainer* parent,
     }
 }
 
+RS_Insert::~RS_Insert() {
+    releaseResolvedInstance();
+}
+
 RS_Entity* RS_Insert::clone() const{
 	auto i = new RS_Insert(*this);
 	i->setOwner(isOwner());
 	i->detach();
+	// the copy of the resolved entities is kept only for this insert
+	i->m_resolved.reset();
 	return i;
 }
 
@@ -142,6 +170,8 @@ void RS_Insert::update() {
     }
 
     clear();
+    m_instance.reset();
+    releaseResolvedInstance();
 
     RS_Block* blk = getBlockForInsert();
     if (blk == nullptr) {
@@ -159,6 +189,22 @@ void RS_Insert::update() {
         return;
     }
 
+    if (m_glyph != nullptr) {
+        // letters drawn from shared glyphs don't clone the letter block
+        calculateBorders();
+        return;
+    }
+
+    // inserts of blocks of the drawing are drawn from the shared block geometry,
+    // if the block can be flattened
+    if (m_instancing && m_data.blockSource == nullptr && isInstancingEnabled()) {
+        m_instance = blk->getInstanceGeometry();
+        if (m_instance != nullptr) {
+            calculateBorders();
+            return;
+        }
+    }
+
     RS_DEBUG->print("RS_Insert::update: cols: %d, rows: %d",
                     m_data.cols, m_data.rows);
     RS_DEBUG->print("RS_Insert::update: block has %d entities",
@@ -201,12 +247,13 @@ void RS_Insert::update() {
                     } else {
                         ne = e->clone();
                     }
+                    // reparent first, so changes of the clone don't invalidate the geometry of the block
+                    ne->setParent(this);
                     ne->setUpdateEnabled(false);
                 // if entity layer are 0 set to insert layer to allow "1 layer control" bug ID #3602152
-                    RS_Layer *l= ne->getLayer();//special fontchar block don't have
-                    if (l != nullptr  && ne->getLayer()->getName() == "0")
+                    RS_Layer *l= e->getLayer();//special fontchar block don't have
+                    if (l != nullptr  && l->getName() == "0")
                     ne->setLayer(getLayer());
-                    ne->setParent(this);
                     ne->setVisible(getFlag(RS2::FlagVisible));
 
 //                                RS_DEBUG->print("RS_Insert::update: transforming entity");
@@ -263,6 +310,433 @@ void RS_Insert::update() {
         RS_DEBUG->print("RS_Insert::update: OK");
 }
 
+std::unique_ptr<RS_Insert> RS_Insert::createResolvedInstance() const {
+    if (!isInstance()) {
+        return nullptr;
+    }
+    RS_InsertData resolvedData = m_data;
+    resolvedData.updateMode = RS2::NoUpdate;
+    auto resolved = std::make_unique<RS_Insert>(nullptr, resolvedData);
+    resolved->m_instancing = false;
+    resolved->setLayer(getLayer(false));
+    resolved->setPen(getPen(false));
+    resolved->setVisible(getFlag(RS2::FlagVisible));
+    // the copy isn't added to the parent, it only finds the block through it
+    resolved->reparent(getParent());
+    resolved->update();
+    return resolved;
+}
+
+const RS_Insert* RS_Insert::getResolvedInstance() const {
+    auto it = std::find(g_resolvedInstances.begin(), g_resolvedInstances.end(), this);
+    if (it != g_resolvedInstances.end()) {
+        g_resolvedInstances.erase(it);
+    } else {
+        m_resolved = createResolvedInstance();
+    }
+    g_resolvedInstances.push_back(this);
+    if (g_resolvedInstances.size() > RESOLVED_INSTANCES_LIMIT) {
+        g_resolvedInstances.front()->m_resolved.reset();
+        g_resolvedInstances.erase(g_resolvedInstances.begin());
+    }
+    return m_resolved.get();
+}
+
+void RS_Insert::releaseResolvedInstance() const {
+    if (m_resolved != nullptr) {
+        m_resolved.reset();
+        g_resolvedInstances.erase(std::remove(g_resolvedInstances.begin(), g_resolvedInstances.end(), this),
+                                  g_resolvedInstances.end());
+    }
+}
+
+bool RS_Insert::hasUniformScale() const {
+    return RS_Math::equal(std::abs(m_data.scaleFactor.x), std::abs(m_data.scaleFactor.y));
+}
+
+RS_Vector RS_Insert::worldToBlock(const RS_Vector& coord, const RS_Vector& angleVector,
+                                  const RS_Vector& cellOffset, const RS_Vector& basePoint) const {
+    RS_Vector p = coord - m_data.insertionPoint;
+    p.rotate(RS_Vector{angleVector.x, -angleVector.y});
+    return {(p.x - cellOffset.x) / m_data.scaleFactor.x + basePoint.x,
+            (p.y - cellOffset.y) / m_data.scaleFactor.y + basePoint.y};
+}
+
+RS_Vector RS_Insert::getNearestInBlock(const RS_Vector& coord, double* dist,
+                                       const std::function<RS_Vector(const RS_Block&, const RS_Vector&)>& query) const {
+    RS_Vector nearest{false};
+    double minDist = RS_MAXDOUBLE;
+    const RS_Block* blk = getBlockForInsert();
+    if (blk != nullptr) {
+        const RS_Vector angleVector{m_data.angle};
+        const RS_Vector basePoint = blk->getBasePoint();
+        for (const RS_Vector& cellOffset: getCellOffsets()) {
+            RS_Vector blockPoint = query(*blk, worldToBlock(coord, angleVector, cellOffset, basePoint));
+            if (!blockPoint.valid) {
+                continue;
+            }
+            RS_Vector wcsPoint = instanceToWorld(blockPoint - basePoint, angleVector, cellOffset);
+            double d = wcsPoint.distanceTo(coord);
+            if (d < minDist) {
+                minDist = d;
+                nearest = wcsPoint;
+            }
+        }
+    }
+    if (dist != nullptr) {
+        *dist = minDist;
+    }
+    return nearest;
+}
+
+RS_VectorSolutions RS_Insert::getInstanceIntersection(const RS_Entity* other, bool onEntities) const {
+    RS_VectorSolutions result;
+    if (other == nullptr || !isInstance()) {
+        return result;
+    }
+    if (!hasUniformScale()) {
+        // a non-uniformly scaled circle isn't a circle in the block
+        return collectIntersections(*getResolvedInstance(), other, onEntities);
+    }
+    const RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return result;
+    }
+    const RS_Vector angleVector{m_data.angle};
+    const RS_Vector basePoint = blk->getBasePoint();
+    for (const RS_Vector& cellOffset: getCellOffsets()) {
+        std::unique_ptr<RS_Entity> blockOther{other->clone()};
+        blockOther->move(-m_data.insertionPoint);
+        blockOther->rotate(RS_Vector{0., 0.}, RS_Vector{angleVector.x, -angleVector.y});
+        blockOther->move(-cellOffset);
+        blockOther->scale(RS_Vector{0., 0.}, RS_Vector{1. / m_data.scaleFactor.x, 1. / m_data.scaleFactor.y});
+        blockOther->move(basePoint);
+        for (const RS_Vector& p: collectIntersections(*blk, blockOther.get(), onEntities)) {
+            result.push_back(instanceToWorld(p - basePoint, angleVector, cellOffset));
+        }
+    }
+    return result;
+}
+
+RS_VectorSolutions RS_Insert::collectIntersections(const RS_EntityContainer& container, const RS_Entity* other,
+                                                   bool onEntities) {
+    RS_VectorSolutions result;
+    for (RS_Entity* e: container) {
+        if (e == nullptr || !e->isVisible()) {
+            continue;
+        }
+        RS_VectorSolutions sol = e->isContainer()
+            ? collectIntersections(*static_cast<RS_EntityContainer*>(e), other, onEntities)
+            : RS_Information::getIntersection(e, other, onEntities);
+        for (const RS_Vector& p: sol) {
+            if (p.valid) {
+                result.push_back(p);
+            }
+        }
+    }
+    return result;
+}
+
+void RS_Insert::setInstancingEnabled(bool enabled) {
+    g_instancingEnabled = enabled ? 1 : 0;
+}
+
+bool RS_Insert::isInstancingEnabled() {
+    if (g_instancingEnabled < 0) {
+        setInstancingEnabled(LC_GET_ONE_BOOL("Render", "BlockInstancing", true));
+    }
+    return g_instancingEnabled == 1;
+}
+
+std::vector<RS_Vector> RS_Insert::getCellOffsets() const {
+    if (m_glyph != nullptr) {
+        return {RS_Vector(0., 0.)};
+    }
+    std::vector<RS_Vector> offsets;
+    for (int c = 0; c < m_data.cols; ++c) {
+        for (int r = 0; r < m_data.rows; ++r) {
+            offsets.emplace_back(m_data.spacing.x * c, m_data.spacing.y * r);
+        }
+    }
+    return offsets;
+}
+
+RS_Vector RS_Insert::instanceToWorld(const RS_Vector& point, const RS_Vector& angleVector,
+                                     const RS_Vector& cellOffset) const {
+    RS_Vector wcsPoint{point.x * m_data.scaleFactor.x + cellOffset.x,
+                       point.y * m_data.scaleFactor.y + cellOffset.y};
+    wcsPoint.rotate(angleVector);
+    return wcsPoint + m_data.insertionPoint;
+}
+
+void RS_Insert::visitInstanceStrokes(const std::function<void(const std::vector<RS_Vector>&)>& visitor) const {
+    if (m_glyph != nullptr) {
+        for (const auto& stroke: m_glyph->strokes) {
+            visitor(stroke);
+        }
+    } else if (m_instance != nullptr) {
+        for (const LC_BlockGeometry::Part& part: m_instance->parts) {
+            for (const auto& stroke: part.strokes) {
+                visitor(stroke);
+            }
+            for (const LC_BlockGeometry::Arc& arc: part.arcs) {
+                visitor(LC_BlockGeometry::flattenArc(arc, m_instance->tolerance));
+            }
+        }
+    }
+}
+
+void RS_Insert::calculateBorders() {
+    if (!isInstance()) {
+        RS_EntityContainer::calculateBorders();
+        return;
+    }
+    resetBorders();
+    const RS_Vector angleVector{m_data.angle};
+    for (const RS_Vector& cellOffset: getCellOffsets()) {
+        visitInstanceStrokes([&](const std::vector<RS_Vector>& stroke) {
+            for (const RS_Vector& p: stroke) {
+                RS_Vector wcsPoint = instanceToWorld(p, angleVector, cellOffset);
+                minV = RS_Vector::minimum(minV, wcsPoint);
+                maxV = RS_Vector::maximum(maxV, wcsPoint);
+            }
+        });
+    }
+}
+
+void RS_Insert::forcedCalculateBorders() {
+    if (!isInstance()) {
+        RS_EntityContainer::forcedCalculateBorders();
+    } else {
+        calculateBorders();
+    }
+}
+
+RS_Vector RS_Insert::getNearestEndpoint(const RS_Vector& coord, double* dist) const {
+    if (!isInstance()) {
+        return RS_EntityContainer::getNearestEndpoint(coord, dist);
+    }
+    const std::vector<RS_Vector>& instanceEndpoints = (m_glyph != nullptr) ? m_glyph->endpoints : m_instance->endpoints;
+    const RS_Vector angleVector{m_data.angle};
+    RS_VectorSolutions endpoints;
+    for (const RS_Vector& cellOffset: getCellOffsets()) {
+        for (const RS_Vector& p: instanceEndpoints) {
+            endpoints.push_back(instanceToWorld(p, angleVector, cellOffset));
+        }
+    }
+    return endpoints.getClosest(coord, dist);
+}
+
+RS_Vector RS_Insert::getNearestPointOnEntity(const RS_Vector& coord, bool onEntity,
+                                             double* dist, RS_Entity** entity) const {
+    if (!isInstance()) {
+        return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+    }
+    RS_Vector nearest;
+    if (hasUniformScale()) {
+        nearest = getNearestInBlock(coord, dist, [onEntity](const RS_Block& blk, const RS_Vector& blockCoord) {
+            return blk.getNearestPointOnEntity(blockCoord, onEntity);
+        });
+    } else {
+        nearest = getResolvedInstance()->getNearestPointOnEntity(coord, onEntity, dist);
+    }
+    // entities of the block aren't part of the drawing
+    if (entity != nullptr) {
+        *entity = const_cast<RS_Insert*>(this);
+    }
+    return nearest;
+}
+
+RS_Vector RS_Insert::getNearestCenter(const RS_Vector& coord, double* dist) const {
+    if (!isInstance()) {
+        return RS_EntityContainer::getNearestCenter(coord, dist);
+    }
+    if (!hasUniformScale()) {
+        return getResolvedInstance()->getNearestCenter(coord, dist);
+    }
+    return getNearestInBlock(coord, dist, [](const RS_Block& blk, const RS_Vector& blockCoord) {
+        return blk.getNearestCenter(blockCoord);
+    });
+}
+
+RS_Vector RS_Insert::getNearestMiddle(const RS_Vector& coord, double* dist, int middlePoints) const {
+    if (!isInstance()) {
+        return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+    }
+    if (!hasUniformScale()) {
+        return getResolvedInstance()->getNearestMiddle(coord, dist, middlePoints);
+    }
+    return getNearestInBlock(coord, dist, [middlePoints](const RS_Block& blk, const RS_Vector& blockCoord) {
+        return blk.getNearestMiddle(blockCoord, nullptr, middlePoints);
+    });
+}
+
+RS_Vector RS_Insert::getNearestDist(double distance, const RS_Vector& coord, double* dist) const {
+    if (!isInstance()) {
+        return RS_EntityContainer::getNearestDist(distance, coord, dist);
+    }
+    if (!hasUniformScale()) {
+        return getResolvedInstance()->getNearestDist(distance, coord, dist);
+    }
+    const double blockDistance = distance / std::abs(m_data.scaleFactor.x);
+    return getNearestInBlock(coord, dist, [blockDistance](const RS_Block& blk, const RS_Vector& blockCoord) {
+        return blk.getNearestDist(blockDistance, blockCoord);
+    });
+}
+
+double RS_Insert::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                     RS2::ResolveLevel level, double solidDist) const {
+    if (!isInstance()) {
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    }
+    double dist = RS_MAXDOUBLE;
+    const RS_Block* blk = getBlockForInsert();
+    if (!hasUniformScale()) {
+        dist = getResolvedInstance()->getDistanceToPoint(coord, nullptr, level, solidDist);
+    } else if (blk != nullptr) {
+        const double scale = std::abs(m_data.scaleFactor.x);
+        const RS_Vector angleVector{m_data.angle};
+        const RS_Vector basePoint = blk->getBasePoint();
+        const double blockSolidDist = (solidDist < RS_MAXDOUBLE) ? solidDist / scale : solidDist;
+        for (const RS_Vector& cellOffset: getCellOffsets()) {
+            RS_Vector blockCoord = worldToBlock(coord, angleVector, cellOffset, basePoint);
+            double d = blk->getDistanceToPoint(blockCoord, nullptr, level, blockSolidDist);
+            if (d < RS_MAXDOUBLE) {
+                dist = std::min(dist, d * scale);
+            }
+        }
+    }
+    if (entity != nullptr) {
+        *entity = const_cast<RS_Insert*>(this);
+    }
+    return dist;
+}
+
+void RS_Insert::draw(RS_Painter* painter) {
+    if (m_glyph != nullptr) {
+        // the letter is drawn on its own (not by a text), borders of the glyph are the ones of the insert
+        if (prepareInstancePart(painter, m_glyph->pen, nullptr, minV, maxV)) {
+            drawInstanceStrokes(painter, m_glyph->strokes);
+        }
+    } else if (m_instance != nullptr) {
+        drawInstanceParts(painter);
+    } else {
+        RS_EntityContainer::draw(painter);
+    }
+}
+
+void RS_Insert::drawAsChild(RS_Painter* painter) {
+    if (m_glyph != nullptr) {
+        drawInstanceStrokes(painter, m_glyph->strokes);
+    } else if (m_instance != nullptr) {
+        for (const LC_BlockGeometry::Part& part: m_instance->parts) {
+            drawInstanceStrokes(painter, part.strokes);
+            drawInstanceArcs(painter, part.arcs);
+        }
+    } else {
+        RS_EntityContainer::drawAsChild(painter);
+    }
+}
+
+void RS_Insert::drawInstanceParts(RS_Painter* painter) const {
+    // keep the geometry alive while drawing, even if the insert is updated meanwhile
+    std::shared_ptr<const LC_BlockGeometry> instance = m_instance;
+    const RS_Vector angleVector{m_data.angle};
+    const std::vector<RS_Vector> cellOffsets = getCellOffsets();
+    for (const LC_BlockGeometry::Part& part: instance->parts) {
+        // borders of the part in all array cells, for clipping
+        RS_Vector wcsMin{RS_MAXDOUBLE, RS_MAXDOUBLE};
+        RS_Vector wcsMax{RS_MINDOUBLE, RS_MINDOUBLE};
+        const RS_Vector corners[] = {part.minV, {part.minV.x, part.maxV.y}, part.maxV, {part.maxV.x, part.minV.y}};
+        for (const RS_Vector& cellOffset: cellOffsets) {
+            for (const RS_Vector& corner: corners) {
+                RS_Vector wcsCorner = instanceToWorld(corner, angleVector, cellOffset);
+                wcsMin = RS_Vector::minimum(wcsMin, wcsCorner);
+                wcsMax = RS_Vector::maximum(wcsMax, wcsCorner);
+            }
+        }
+        if (prepareInstancePart(painter, part.pen, part.layer, wcsMin, wcsMax)) {
+            drawInstanceStrokes(painter, part.strokes);
+            drawInstanceArcs(painter, part.arcs);
+        }
+    }
+}
+
+/**
+ * Sets the painter up for a glyph or a part of the shared block geometry, with the pen and layer
+ * the entities of the part would have if cloned into this insert.
+ *
+ * @param layer layer of the entities of the part, nullptr if they have none
+ * @param wcsMin, wcsMax borders of the part in all array cells
+ * @return false if the part isn't drawn
+ */
+bool RS_Insert::prepareInstancePart(RS_Painter* painter, const RS_Pen& pen, RS_Layer* layer,
+                                    const RS_Vector& wcsMin, const RS_Vector& wcsMax) const {
+    // entities on layer "0" are drawn on the layer of the insert
+    if (layer == nullptr || layer->getName() == "0") {
+        layer = getLayer();
+    }
+    RS_Pen partPen = updatePen(RS_Pen(pen), getPen());
+    if (layer != nullptr) {
+        const RS_Pen& layerPen = layer->getPen();
+        if (partPen.isColorByLayer()) {
+            partPen.setColorFromPen(layerPen);
+        }
+        if (partPen.isWidthByLayer()) {
+            partPen.setWidthFromPen(layerPen);
+        }
+        if (partPen.isLineTypeByLayer()) {
+            partPen.setLineTypeFromPen(layerPen);
+        }
+    }
+    return painter->prepareInstancePart(this, partPen, layer, wcsMin, wcsMax);
+}
+
+void RS_Insert::drawInstanceStrokes(RS_Painter* painter, const std::vector<std::vector<RS_Vector>>& strokes) const {
+    const RS_Vector angleVector{m_data.angle};
+    QPolygonF uiStroke;
+    for (const RS_Vector& cellOffset: getCellOffsets()) {
+        for (const auto& stroke: strokes) {
+            uiStroke.clear();
+            uiStroke.reserve(static_cast<int>(stroke.size()));
+            for (const RS_Vector& p: stroke) {
+                uiStroke.append(painter->toGuiPointF(instanceToWorld(p, angleVector, cellOffset)));
+            }
+            painter->drawPolylineUI(uiStroke);
+        }
+    }
+}
+
+/**
+ * Draws arcs of the shared block geometry, flattened for the scale of the view, so they
+ * look smooth at any zoom.
+ */
+void RS_Insert::drawInstanceArcs(RS_Painter* painter, const std::vector<LC_BlockGeometry::Arc>& arcs) const {
+    if (arcs.empty()) {
+        return;
+    }
+    const double uiScale = painter->toGuiDX(1.0) * std::max(std::abs(m_data.scaleFactor.x), std::abs(m_data.scaleFactor.y));
+    if (!(uiScale > 0.)) {
+        return;
+    }
+    const double tolerance = UI_ARC_TOLERANCE / uiScale;
+    const RS_Vector angleVector{m_data.angle};
+    QPolygonF uiStroke;
+    for (const RS_Vector& cellOffset: getCellOffsets()) {
+        for (const LC_BlockGeometry::Arc& arc: arcs) {
+            const int segments = std::min(UI_ARC_MAX_SEGMENTS,
+                                          LC_BlockGeometry::arcSegments(arc.radius, arc.angleLength, tolerance));
+            uiStroke.clear();
+            uiStroke.reserve(segments + 1);
+            for (int i = 0; i <= segments; ++i) {
+                const RS_Vector p = arc.center + RS_Vector::polar(arc.radius, arc.startAngle + arc.angleLength * i / segments);
+                uiStroke.append(painter->toGuiPointF(instanceToWorld(p, angleVector, cellOffset)));
+            }
+            painter->drawPolylineUI(uiStroke);
+        }
+    }
+}
+
 /**
  * @return Pointer to the m_block associated with this Insert or
  *   nullptr if the m_block couldn't be found. Blocks are requested
@@ -289,7 +763,10 @@ RS_Block* RS_Insert::getBlockForInsert() const{
         blk = blkList->find(m_data.name);
     }
 
-    m_block = blk;
+    // missing blocks aren't cached, so lookups of them don't write
+    if (blk != nullptr) {
+        m_block = blk;
+    }
 
     return blk;
 }
@@ -28,9 +28,14 @@
 #ifndef RS_INSERT_H
 #define RS_INSERT_H
 
+#include <functional>
+#include <memory>
+
+#include "lc_blockgeometry.h"
 #include "rs_entitycontainer.h"
 
 class RS_BlockList;
+struct LC_FontGlyph;
 
 /**
  * Holds the data that defines an insert.
@@ -94,6 +99,7 @@ class RS_Insert : public RS_EntityContainer {
 public:
     RS_Insert(RS_EntityContainer* parent,
               const RS_InsertData& d);
+    ~RS_Insert() override;
 
     RS_Entity* clone() const override;
 
@@ -119,6 +125,56 @@ public:
 
     void update() override;
 
+    /**
+     * @brief setGlyph draw this letter of a text from the shared glyph geometry of its font,
+     * instead of cloning entities of the letter block. The insert has no entities of its own,
+     * and acts as an atomic entity.
+     */
+    void setGlyph(const LC_FontGlyph* glyph) {
+        m_glyph = glyph;
+    }
+    const LC_FontGlyph* getGlyph() const {
+        return m_glyph;
+    }
+    /**
+     * @brief isInstance whether this insert draws shared geometry of a font glyph or of
+     * its block, instead of owning transformed clones of the block entities. Inserts of
+     * blocks of the drawing are drawn as instances, if their blocks can be flattened
+     * (see LC_BlockGeometry). Instances have no entities, and act as atomic entities.
+     */
+    bool isInstance() const {
+        return m_glyph != nullptr || m_instance != nullptr;
+    }
+    /**
+     * @brief createResolvedInstance copy of this insert with entities cloned from the block, for
+     * operations which need the exact entities, e.g. exploding the insert. Snapping queries of
+     * instances run on the block entities instead, with the query point in block coordinates.
+     * @return nullptr, if this insert isn't drawn as an instance
+     */
+    std::unique_ptr<RS_Insert> createResolvedInstance() const;
+    /**
+     * @brief getInstanceIntersection intersections of the block entities of this instance with
+     * the other entity, computed with the other entity transformed to block coordinates
+     */
+    RS_VectorSolutions getInstanceIntersection(const RS_Entity* other, bool onEntities) const;
+    /**
+     * @brief setInstancingEnabled whether inserts of blocks of the drawing may be drawn as
+     * instances. Read from the "Render/BlockInstancing" setting, affects inserts updated afterwards.
+     */
+    static void setInstancingEnabled(bool enabled);
+    static bool isInstancingEnabled();
+
+    /**
+     * Instances have no entities, so they act as atomic entities for the callers which walk
+     * into containers. Callers which need the geometry of the block use the queries below,
+     * getInstanceIntersection(), or createResolvedInstance().
+     */
+    bool isContainer() const override {
+        return !isInstance();
+    }
+    void calculateBorders() override;
+    void forcedCalculateBorders() override;
+
     QString getName() const {
         return m_data.name;
     }
@@ -182,6 +238,25 @@ public:
     }
     RS_Vector getNearestRef(const RS_Vector& coord,
                             double* dist = nullptr) const override;
+    using RS_EntityContainer::getNearestEndpoint;
+    RS_Vector getNearestEndpoint(const RS_Vector& coord,
+                                 double* dist = nullptr) const override;
+    RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+                                      bool onEntity = true,
+                                      double* dist = nullptr,
+                                      RS_Entity** entity = nullptr) const override;
+    RS_Vector getNearestCenter(const RS_Vector& coord,
+                               double* dist = nullptr) const override;
+    RS_Vector getNearestMiddle(const RS_Vector& coord,
+                               double* dist = nullptr,
+                               int middlePoints = 1) const override;
+    RS_Vector getNearestDist(double distance,
+                             const RS_Vector& coord,
+                             double* dist = nullptr) const override;
+    double getDistanceToPoint(const RS_Vector& coord,
+                              RS_Entity** entity,
+                              RS2::ResolveLevel level = RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
 
     void move(const RS_Vector& offset) override;
     void rotate(const RS_Vector& center, double angle) override;
@@ -189,11 +264,47 @@ public:
     void scale(const RS_Vector& center, const RS_Vector& factor) override;
     void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) override;
 
+    void draw(RS_Painter* painter) override;
+    void drawAsChild(RS_Painter* painter) override;
+
     friend std::ostream& operator << (std::ostream& os, const RS_Insert& i);
 
 protected:
     RS_InsertData m_data{};
     mutable RS_Block* m_block = nullptr;
+    /** shared geometry of the letter, owned by the font */
+    const LC_FontGlyph* m_glyph = nullptr;
+    /** shared geometry of the block, if this insert is drawn as an instance of the block */
+    std::shared_ptr<const LC_BlockGeometry> m_instance;
+    /** whether this insert may be drawn as an instance of the block */
+    bool m_instancing = true;
+    /** copy with entities cloned from the block, for queries of non-uniformly scaled instances */
+    mutable std::shared_ptr<RS_Insert> m_resolved;
+
+private:
+    /** @return offsets of the array cells, in the rotated insert coordinates */
+    std::vector<RS_Vector> getCellOffsets() const;
+    RS_Vector instanceToWorld(const RS_Vector& point, const RS_Vector& angleVector,
+                              const RS_Vector& cellOffset) const;
+    /** visits strokes of the shared geometry, in glyph or block coordinates */
+    void visitInstanceStrokes(const std::function<void(const std::vector<RS_Vector>&)>& visitor) const;
+    bool prepareInstancePart(RS_Painter* painter, const RS_Pen& pen, RS_Layer* layer,
+                             const RS_Vector& wcsMin, const RS_Vector& wcsMax) const;
+    void drawInstanceStrokes(RS_Painter* painter, const std::vector<std::vector<RS_Vector>>& strokes) const;
+    void drawInstanceArcs(RS_Painter* painter, const std::vector<LC_BlockGeometry::Arc>& arcs) const;
+    void drawInstanceParts(RS_Painter* painter) const;
+    /** @return the copy with resolved entities, kept for a limited number of recently queried inserts */
+    const RS_Insert* getResolvedInstance() const;
+    void releaseResolvedInstance() const;
+    /** whether block coordinates map to the world by a similarity, so distances scale evenly */
+    bool hasUniformScale() const;
+    RS_Vector worldToBlock(const RS_Vector& coord, const RS_Vector& angleVector,
+                           const RS_Vector& cellOffset, const RS_Vector& basePoint) const;
+    /** runs the query on the block for all cells, with the coordinate in block coordinates */
+    RS_Vector getNearestInBlock(const RS_Vector& coord, double* dist,
+                                const std::function<RS_Vector(const RS_Block&, const RS_Vector&)>& query) const;
+    static RS_VectorSolutions collectIntersections(const RS_EntityContainer& container, const RS_Entity* other,
+                                                   bool onEntities);
 };
 
 
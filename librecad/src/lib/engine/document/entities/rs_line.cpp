@@ -36,6 +36,8 @@
 #include "emu_c99.h"
 #endif
 
+LC_DEFINE_POOL_ALLOCATION(RS_Line, "Line")
+
 std::ostream& operator << (std::ostream& os, const RS_LineData& ld) {
 	os << "RS_LINE: ((" << ld.startpoint <<
 		  ")(" << ld.endpoint <<
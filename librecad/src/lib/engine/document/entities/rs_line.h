@@ -28,6 +28,7 @@
 #ifndef RS_Line_INCLUDE_H
 #define RS_Line_INCLUDE_H
 #include "lc_cachedlengthentity.h"
+#include "lc_entitypool.h"
 class LC_Quadratic;
 
 /**
@@ -52,6 +53,8 @@ std::ostream& operator << (std::ostream& os, const RS_LineData& ld);
  */
 class RS_Line : public LC_CachedLengthEntity {
 public:
+    LC_DECLARE_POOL_ALLOCATION
+
     RS_Line() = default;
     RS_Line(RS_EntityContainer* parent,const RS_LineData& d);
     RS_Line(RS_EntityContainer* parent, const RS_Vector& pStart, const RS_Vector& pEnd);
@@ -541,6 +541,7 @@ void RS_MText::addLetter(LC_TextLine &oneLine, QChar letter,
     RS_Insert *letterEntity{new RS_Insert(this, d)};
     letterEntity->setPen(RS_Pen(RS2::FlagInvalid));
     letterEntity->setLayer(nullptr);
+    letterEntity->setGlyph(font.findGlyph(letterText));
     letterEntity->update();
     letterEntity->forcedCalculateBorders();
 
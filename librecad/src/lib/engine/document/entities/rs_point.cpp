@@ -29,6 +29,8 @@
 #include "rs_circle.h"
 #include "rs_painter.h"
 
+LC_DEFINE_POOL_ALLOCATION(RS_Point, "Point")
+
 RS_Point::RS_Point(RS_EntityContainer* parent,
                    const RS_PointData& d)
         :RS_AtomicEntity(parent), data(d) {
@@ -28,6 +28,7 @@
 #ifndef RS_POINT_H
 #define RS_POINT_H
 
+#include "lc_entitypool.h"
 #include "rs_atomicentity.h"
 
 /**
@@ -49,6 +50,8 @@ struct RS_PointData {
  */
 class RS_Point:public RS_AtomicEntity {
 public:
+    LC_DECLARE_POOL_ALLOCATION
+
     RS_Point(
         RS_EntityContainer *parent,
         const RS_PointData &d);
@@ -292,6 +292,7 @@ void RS_Text::update() {
             RS_Vector letterWidth;
             letter->setPen(RS_Pen(RS2::FlagInvalid));
             letter->setLayer(nullptr);
+            letter->setGlyph(font->findGlyph(letterText));
             letter->update();
             letter->forcedCalculateBorders();
 
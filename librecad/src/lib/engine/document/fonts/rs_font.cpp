@@ -32,9 +32,12 @@
 
 #include <QFileInfo>
 
+#include "lc_blockgeometry.h"
 #include "rs_arc.h"
+#include "rs_circle.h"
 #include "rs_debug.h"
 #include "rs_fontchar.h"
+#include "rs_insert.h"
 #include "rs_line.h"
 #include "rs_math.h"
 #include "rs_polyline.h"
@@ -498,9 +501,34 @@ RS_Block* RS_Font::generateLffFont(const QString& key)
 }
 
 RS_Block* RS_Font::findLetter(const QString& name) {
-    RS_Block* ret= letterList.find(name);
-    return (ret != nullptr) ? ret : generateLffFont(name);
+    // letters are looked up for each character of each text, so the results are
+    // cached by code point, which avoids hashing of names and repeated attempts
+    // to generate missing letters
+    std::lock_guard<std::recursive_mutex> lock(cacheMutex);
+    char32_t code = 0;
+    bool singleCharacter = false;
+    if (name.size() == 1) {
+        code = name.at(0).unicode();
+        singleCharacter = true;
+    } else if (name.size() == 2 && name.at(0).isHighSurrogate() && name.at(1).isLowSurrogate()) {
+        code = QChar::surrogateToUcs4(name.at(0), name.at(1));
+        singleCharacter = true;
+    }
+    if (singleCharacter) {
+        auto it = lettersByCode.find(code);
+        if (it != lettersByCode.end()) {
+            return it->second;
+        }
+    }
 
+    RS_Block* ret= letterList.find(name);
+    if (ret == nullptr) {
+        ret = generateLffFont(name);
+    }
+    if (singleCharacter) {
+        lettersByCode.emplace(code, ret);
+    }
+    return ret;
 }
 
 /**
@@ -518,3 +546,85 @@ unsigned RS_Font::countLetters() const {
 RS_Block* RS_Font::letterAt(unsigned i) {
     return letterList.at(i);
 }
+
+namespace {
+// maximum distance of flattened arcs to the arcs, in letter units (letter height is 9.0)
+    constexpr double glyphFlatteningTolerance = 2e-3;
+
+    void addGlyphStroke(LC_FontGlyph &glyph, const std::vector<RS_Vector> &points) {
+        for (const RS_Vector &p: points) {
+            glyph.minV = RS_Vector::minimum(glyph.minV, p);
+            glyph.maxV = RS_Vector::maximum(glyph.maxV, p);
+        }
+        // continue the previous stroke, if connected
+        if (!glyph.strokes.empty() && glyph.strokes.back().back().squaredTo(points.front()) < RS_TOLERANCE2) {
+            auto &stroke = glyph.strokes.back();
+            stroke.insert(stroke.end(), points.cbegin() + 1, points.cend());
+        } else {
+            glyph.strokes.push_back(points);
+        }
+        glyph.endpoints.push_back(points.front());
+        glyph.endpoints.push_back(points.back());
+    }
+}
+
+const LC_FontGlyph* RS_Font::findGlyph(const QString& name) {
+    std::lock_guard<std::recursive_mutex> lock(cacheMutex);
+    auto it = glyphs.find(name);
+    if (it == glyphs.end()) {
+        it = glyphs.emplace(name, createGlyph(name)).first;
+    }
+    return it->second.get();
+}
+
+/**
+ * Resolves entities of a letter block inserted at the origin, and flattens them to
+ * strokes. Empty letters, letters with entities other than lines, arcs and circles
+ * and letters with entities of different pens aren't flattened.
+ */
+std::unique_ptr<LC_FontGlyph> RS_Font::createGlyph(const QString& name) {
+    if (findLetter(name) == nullptr) {
+        return nullptr;
+    }
+
+    RS_InsertData d(name, RS_Vector(0.0, 0.0), RS_Vector(1.0, 1.0), 0.0,
+                    1, 1, RS_Vector(0.0, 0.0), &letterList, RS2::NoUpdate);
+    RS_Insert letter(nullptr, d);
+    letter.update();
+
+    auto glyph = std::make_unique<LC_FontGlyph>();
+    for (RS_Entity* e = letter.firstEntity(RS2::ResolveAll); e != nullptr;
+         e = letter.nextEntity(RS2::ResolveAll)) {
+        // the glyph is drawn with a single pen
+        if (glyph->strokes.empty()) {
+            glyph->pen = e->getPen(false);
+        } else if (e->getPen(false) != glyph->pen) {
+            RS_DEBUG->print("RS_Font::createGlyph: letter( %s ) is drawn from the letter block",
+                            qPrintable(name));
+            return nullptr;
+        }
+        switch (e->rtti()) {
+            case RS2::EntityLine:
+                addGlyphStroke(*glyph, {e->getStartpoint(), e->getEndpoint()});
+                break;
+            case RS2::EntityArc: {
+                auto arc = static_cast<RS_Arc*>(e);
+                double angleLength = arc->isReversed() ? -arc->getAngleLength() : arc->getAngleLength();
+                addGlyphStroke(*glyph, LC_BlockGeometry::flattenArc(arc->getCenter(), arc->getRadius(), arc->getAngle1(),
+                                                                     angleLength, glyphFlatteningTolerance));
+                break;
+            }
+            case RS2::EntityCircle: {
+                auto circle = static_cast<RS_Circle*>(e);
+                addGlyphStroke(*glyph, LC_BlockGeometry::flattenArc(circle->getCenter(), circle->getRadius(), 0., 2. * M_PI,
+                                                                     glyphFlatteningTolerance));
+                break;
+            }
+            default:
+                RS_DEBUG->print("RS_Font::createGlyph: letter( %s ) is drawn from the letter block",
+                                qPrintable(name));
+                return nullptr;
+        }
+    }
+    return glyph->strokes.empty() ? nullptr : std::move(glyph);
+}
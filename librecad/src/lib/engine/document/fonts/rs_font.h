@@ -28,13 +28,38 @@
 #ifndef RS_FONT_H
 #define RS_FONT_H
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <QMap>
 #include <QStringList>
 
 #include "rs_blocklist.h"
+#include "rs_pen.h"
+#include "rs_vector.h"
 
 
 class RS_BlockList;
+
+/**
+ * Geometry of a letter, shared by all texts using the font. Entities of the
+ * letter block are resolved and flattened to polylines, so texts may draw
+ * letters without cloning the letter block.
+ */
+struct LC_FontGlyph {
+    //! strokes of the letter in letter block coordinates
+    std::vector<std::vector<RS_Vector>> strokes;
+    //! endpoints of the atomic entities of the letter block
+    std::vector<RS_Vector> endpoints;
+    //! pen of the entities of the letter block, as set (not resolved)
+    RS_Pen pen;
+    RS_Vector minV{false};
+    RS_Vector maxV{false};
+};
+
 /**
  * Class for representing a font. This is implemented as a RS_Graphic
  * with a name (the font name) and several blocks, one for each letter
@@ -106,6 +131,11 @@ public:
     //	}
     unsigned countLetters() const;
     RS_Block* letterAt(unsigned i);
+    /**
+     * @brief findGlyph shared geometry of a letter, created on the first request.
+     * @return nullptr, if the letter is missing or can't be flattened
+     */
+    const LC_FontGlyph* findGlyph(const QString& name);
 
     friend std::ostream& operator << (std::ostream& os, const RS_Font& l);
 
@@ -115,6 +145,7 @@ private:
     void readCXF(const QString& path);
     void readLFF(const QString& path);
     RS_Block* generateLffFont(const QString& key);
+    std::unique_ptr<LC_FontGlyph> createGlyph(const QString& name);
 
 private:
     //raw lff font file list, not processed into blocks yet
@@ -123,6 +154,16 @@ private:
     //! block list (letters)
     RS_BlockList letterList;
 
+    //! results of findLetter() by code point of the letter, including missing letters
+    std::unordered_map<char32_t, RS_Block*> lettersByCode;
+
+    //! shared geometry of letters, by letter name
+    std::map<QString, std::unique_ptr<LC_FontGlyph>> glyphs;
+
+    //! guards the letter caches, fonts are shared by all documents and texts
+    //! may be laid out while other threads draw
+    std::recursive_mutex cacheMutex;
+
     //! Font file name
     QString m_fileName;
 
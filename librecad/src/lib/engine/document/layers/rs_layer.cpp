@@ -22,6 +22,7 @@
 
 #include <iostream>
 #include "rs_layer.h"
+#include "rs_layerlist.h"
 
 RS_LayerData::RS_LayerData(const QString& name,
 						   const RS_Pen& pen,
@@ -44,12 +45,17 @@ RS_Layer::RS_Layer(const QString& name):
 }
 
 RS_Layer* RS_Layer::clone() const{
-	return new RS_Layer(*this);
+	auto* clone = new RS_Layer(*this);
+	clone->layerList = nullptr;
+	return clone;
 }
 
 /** sets a new name for this layer. */
 void RS_Layer::setName(const QString& name) {
 	data.name = name;
+	if (layerList != nullptr) {
+		layerList->layerRenamed();
+	}
 }
 
 /** @return the name of this layer. */
@@ -129,6 +135,9 @@ void RS_Layer::togglePrint() {
  */
 void RS_Layer::toggleConstruction() {
 	data.construction = !data.construction;
+	if (layerList != nullptr) {
+		layerList->layerConstructionChanged();
+	}
 }
 
 /**
@@ -210,6 +219,9 @@ bool RS_Layer::isConstruction() const{
  * @param construction true: infinite lines, false: normal layer
  */
 bool RS_Layer::setConstruction( const bool construction){
+	if (layerList != nullptr && data.construction != construction) {
+		layerList->layerConstructionChanged();
+	}
 	data.construction = construction;
 	return construction;
 }
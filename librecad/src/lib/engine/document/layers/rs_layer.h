@@ -38,6 +38,7 @@
 #include "rs_pen.h"
 
 class QString;
+class RS_LayerList;
 
 /**
  * Holds the data that defines a layer.
@@ -198,8 +199,12 @@ public:
     friend std::ostream& operator << (std::ostream& os, const RS_Layer& l);
 
 private:
+    friend class RS_LayerList;
+
     //! Layer data
     RS_LayerData data;
+    //! layer list holding this layer, notified of renames and construction changes
+    RS_LayerList* layerList = nullptr;
 
 };
 
@@ -25,6 +25,7 @@
 **
 **********************************************************************/
 
+#include<algorithm>
 #include<iostream>
 
 #include "rs_debug.h"
@@ -44,7 +45,12 @@ RS_LayerList::RS_LayerList() {
  * Removes all layers in the layerlist.
  */
 void RS_LayerList::clear() {
+    for (auto l : m_layers) {
+        l->layerList = nullptr;
+    }
     m_layers.clear();
+    m_layersByName.clear();
+    m_sorted = true;
     setModified(true);
 }
 
@@ -117,6 +123,7 @@ void RS_LayerList::sort() {
     {
         return l0->getName() < l1->getName();
     });
+    m_sorted = true;
 }
 
 void RS_LayerList::fireLayerAdded(RS_Layer* layer) {
@@ -144,8 +151,19 @@ void RS_LayerList::add(RS_Layer* layerToAdd) {
     // check if layer already exists:
     RS_Layer* existingLayer = find(layerToAdd->getName());
     if (existingLayer == nullptr) {
-        m_layers.append(layerToAdd);
-        this->sort();
+        if (m_sorted) {
+            // same position as appending and sorting would give, without sorting of all layers
+            auto position = std::upper_bound(m_layers.begin(), m_layers.end(), layerToAdd,
+                                             [](const RS_Layer* l0, const RS_Layer* l1) {
+                                                 return l0->getName() < l1->getName();
+                                             });
+            m_layers.insert(position, layerToAdd);
+        } else {
+            m_layers.append(layerToAdd);
+            this->sort();
+        }
+        m_layersByName.insert(layerToAdd->getName(), layerToAdd);
+        layerToAdd->layerList = this;
         // notify listeners
         fireLayerAdded(layerToAdd);
         setModified(true);
@@ -194,6 +212,8 @@ void RS_LayerList::remove(RS_Layer* layerToRemove) {
 
     // here the layer is removed from the list but not deleted
     m_layers.removeOne(layerToRemove);
+    layerToRemove->layerList = nullptr;
+    m_nameIndexValid = false;
 
     fireLayerRemoved(layerToRemove);
 
@@ -217,7 +237,14 @@ void RS_LayerList::edit(RS_Layer* layer, const RS_Layer& source) {
     if (layer == nullptr) {
         return;
     }
+    bool constructionChanged = layer->isConstruction() != source.isConstruction();
     *layer = source;
+    layer->layerList = this;
+    if (constructionChanged) {
+        layerConstructionChanged();
+    }
+    m_nameIndexValid = false;
+    m_sorted = false;
     fireEdit(layer);
 }
 
@@ -233,14 +260,35 @@ void RS_LayerList::fireEdit(RS_Layer* layer) {
  * \p nullptr if no such layer was found.
  */
 RS_Layer* RS_LayerList::find(const QString& name) {
-    RS_Layer* ret = nullptr;
+    validateNameIndex();
+    return m_layersByName.value(name, nullptr);
+}
+
+/**
+ * Layers may be renamed directly, by RS_Layer::setName(), which invalidates
+ * the name index and the sort order of their list only.
+ */
+void RS_LayerList::layerRenamed() {
+    m_nameIndexValid = false;
+    m_sorted = false;
+}
+
+/**
+ * Rebuilds the name index if layers were removed or renamed since it was
+ * built.
+ */
+void RS_LayerList::validateNameIndex() {
+    if (m_nameIndexValid) {
+        return;
+    }
+    m_layersByName.clear();
     for (auto l : m_layers) {
-        if (l->getName() == name) {
-            ret = l;
-            break;
+        // the first layer of a name wins, as by the linear search
+        if (!m_layersByName.contains(l->getName())) {
+            m_layersByName.insert(l->getName(), l);
         }
     }
-    return ret;
+    m_nameIndexValid = true;
 }
 
 /**
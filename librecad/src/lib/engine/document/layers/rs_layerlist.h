@@ -29,7 +29,9 @@
 #ifndef RS_LAYERLIST_H
 #define RS_LAYERLIST_H
 
+#include <QHash>
 #include <QList>
+#include <QString>
 
 class RS_Layer;
 class RS_LayerListListener;
@@ -113,14 +115,39 @@ public:
      * @brief sort by layer names
      */
     void sort();
+    /**
+     * @return number of changes of the construction flag of layers of this list, lines on
+     * construction layers are drawn infinite, so spatial indexes compare it to rebuild
+     */
+    unsigned long getConstructionChanges() const {
+        return m_constructionChanges;
+    }
     void fireLayerAdded(RS_Layer* layer);
     void slotUpdateLayerList();
     friend std::ostream& operator << (std::ostream& os, RS_LayerList& l);
 
 private:
+    friend class RS_Layer;
+
     void fireLayerToggled();
+    void validateNameIndex();
+    /** called by RS_Layer::setName() for the layers of this list */
+    void layerRenamed();
+    /** called by RS_Layer for the layers of this list, if the construction flag changed */
+    void layerConstructionChanged() {
+        ++m_constructionChanges;
+    }
+
 	//! layers in the graphic
     QList<RS_Layer*> m_layers;
+    //! layers by name
+    QHash<QString, RS_Layer*> m_layersByName;
+    //! false, if the name index has to be rebuilt
+    bool m_nameIndexValid = true;
+    //! true, if the layers are known to be sorted by name
+    bool m_sorted = true;
+    //! number of changes of the construction flag of layers of this list
+    unsigned long m_constructionChanges = 0;
     //! List of registered LayerListListeners
     QList<RS_LayerListListener*> m_layerListListeners;
     RS_Layer *m_activeLayer = nullptr;
@@ -50,3 +50,82 @@ void RS_Document::endUndoCycle(){
     }
     RS_Undo::endUndoCycle();
 }
+
+void RS_Document::addEntity(RS_Entity* entity) {
+    RS_EntityContainer::addEntity(entity);
+    updateSelected(entity);
+}
+
+void RS_Document::appendEntity(RS_Entity* entity) {
+    RS_EntityContainer::appendEntity(entity);
+    updateSelected(entity);
+}
+
+void RS_Document::prependEntity(RS_Entity* entity) {
+    RS_EntityContainer::prependEntity(entity);
+    updateSelected(entity);
+}
+
+void RS_Document::insertEntity(int index, RS_Entity* entity) {
+    RS_EntityContainer::insertEntity(index, entity);
+    updateSelected(entity);
+}
+
+void RS_Document::setEntityAt(int index, RS_Entity* entity) {
+    RS_Entity* replaced = entityAt(index);
+    if (replaced != nullptr) {
+        m_selectedEntities.erase(replaced);
+        m_removalGeneration++;
+    }
+    RS_EntityContainer::setEntityAt(index, entity);
+    updateSelected(entity);
+}
+
+bool RS_Document::removeEntity(RS_Entity* entity) {
+    m_selectedEntities.erase(entity);
+    m_removalGeneration++;
+    return RS_EntityContainer::removeEntity(entity);
+}
+
+int RS_Document::removeEntities(const std::vector<RS_Entity*>& entities) {
+    if (!m_selectedEntities.empty()) {
+        for (RS_Entity* e: entities) {
+            m_selectedEntities.erase(e);
+        }
+    }
+    m_removalGeneration++;
+    return RS_EntityContainer::removeEntities(entities);
+}
+
+void RS_Document::clear() {
+    m_selectedEntities.clear();
+    m_removalGeneration++;
+    RS_EntityContainer::clear();
+}
+
+/**
+ * Entities are removed from the set when they are deselected or removed, a container
+ * stays in it after its nested entities are deselected.
+ */
+void RS_Document::selectionChanged(RS_Entity* topLevelEntity, bool selected) {
+    if (selected) {
+        m_selectedEntities.insert(topLevelEntity);
+    } else {
+        m_selectedEntities.erase(topLevelEntity);
+    }
+}
+
+std::vector<RS_Entity*> RS_Document::getSelectedEntities() const {
+    std::vector<RS_Entity*> selected(m_selectedEntities.cbegin(), m_selectedEntities.cend());
+    sortByContainerOrder(selected);
+    return selected;
+}
+
+/**
+ * Entities may be added with the selected flag already set, e.g. selected clones.
+ */
+void RS_Document::updateSelected(RS_Entity* entity) {
+    if (entity != nullptr && entity->getFlag(RS2::FlagSelected)) {
+        m_selectedEntities.insert(entity);
+    }
+}
@@ -29,6 +29,9 @@
 #ifndef RS_DOCUMENT_H
 #define RS_DOCUMENT_H
 
+#include <map>
+#include <unordered_set>
+
 #include "rs_entitycontainer.h"
 #include "rs_pen.h"
 #include "rs_undo.h"
@@ -76,6 +79,61 @@ public:
         }
     }
 
+    /**
+     * Removes all given entities from the entity container in a single pass.
+     * Implementation from RS_Undo.
+     */
+    void removeUndoables(const std::vector<RS_Undoable*>& undoables) override {
+        std::vector<RS_Entity*> entities;
+        for (RS_Undoable* u: undoables) {
+            if (u && u->undoRtti()==RS2::UndoableEntity && u->isUndone()) {
+                entities.push_back(static_cast<RS_Entity*>(u));
+            }
+        }
+        removeEntities(entities);
+    }
+
+    /**
+     * Overwritten to keep the set of selected entities in sync with the entity list.
+     */
+    void addEntity(RS_Entity* entity) override;
+    void appendEntity(RS_Entity* entity) override;
+    void prependEntity(RS_Entity* entity) override;
+    void insertEntity(int index, RS_Entity* entity) override;
+    void setEntityAt(int index, RS_Entity* entity) override;
+    bool removeEntity(RS_Entity* entity) override;
+    int removeEntities(const std::vector<RS_Entity*>& entities) override;
+    void clear() override;
+
+    /**
+     * @return Entities of this document (not nested ones) which are selected or contain
+     * selected entities, in the container order. Renderers use it to draw the selection
+     * without traversal of the whole document.
+     */
+    std::vector<RS_Entity*> getSelectedEntities() const;
+
+    /**
+     * Called by RS_Entity::setSelected() for entities of this document, with the entity
+     * itself or, for nested entities, the entity of this document containing it.
+     */
+    void selectionChanged(RS_Entity* topLevelEntity, bool selected);
+
+    /**
+     * @return counter of removals of entities from this document. Entities of the document
+     * are deleted only after their removal, so pointers to them (not to nested ones) stay
+     * valid while the counter is unchanged, and may be kept across events, e.g. for
+     * progressive rendering.
+     */
+    unsigned long getRemovalGeneration() const {return m_removalGeneration;}
+
+    /** intersections found by intersection snapping, keyed by ids of entity pairs */
+    using IntersectionCache = std::map<std::pair<unsigned long long, unsigned long long>, RS_VectorSolutions>;
+    /**
+     * @return intersections cached by RS_EntityContainer::getNearestIntersection() for entities
+     * of this document, cleared whenever one of its containers changes
+     */
+    IntersectionCache& getIntersectionCache() const {return m_intersectionCache;}
+
     /**
      * @return Currently active drawing pen.
      */
@@ -115,6 +173,12 @@ protected:
 
     //used to read/save current view
     RS_GraphicView * gv = nullptr; // fixme - sand -- REALLY BAD DEPENDANCE TO UI here, REWORK!
+private:
+    void updateSelected(RS_Entity* entity);
+
+    std::unordered_set<RS_Entity*> m_selectedEntities;
+    mutable IntersectionCache m_intersectionCache;
+    unsigned long m_removalGeneration = 0;
 
 };
 #endif
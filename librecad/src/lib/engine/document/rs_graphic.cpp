@@ -211,6 +211,16 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
                 e->setUndoState(true);
                 e->setLayer("0");
             }
+            // inserts drawn as instances refer to the layers of the block entities,
+            // update them before the layer is deleted
+            if (!toRemove.empty()) {
+                for (RS_Block *blk: blockList) {
+                    if (blk != nullptr) {
+                        blk->updateInserts();
+                    }
+                }
+                updateInserts();
+            }
 
             layerList.remove(layer);
         }
@@ -698,7 +708,7 @@ bool RS_Graphic::isBiggerThanPaper() {
 }
 
 void RS_Graphic::addEntity(RS_Entity *entity) {
-    RS_EntityContainer::addEntity(entity);
+    RS_Document::addEntity(entity);
     if (entity->rtti() == RS2::EntityBlock ||
         entity->rtti() == RS2::EntityContainer) {
         auto *e = dynamic_cast<RS_EntityContainer *>(entity);
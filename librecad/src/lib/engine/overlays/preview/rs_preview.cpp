@@ -27,8 +27,10 @@
 #include "rs_preview.h"
 
 #include "lc_graphicviewport.h"
+#include "lc_rect.h"
 #include "rs_color.h"
 #include "rs_line.h"
+#include "rs_painter.h"
 #include "rs_pen.h"
 #include "rs_settings.h"
 
@@ -153,6 +155,8 @@ void RS_Preview::calcRectCorners(const RS_Vector &worldCorner1, const RS_Vector
 }
 
 void RS_Preview::clear() {
+    // the recorded rendering of transformed entities is kept for the next preview
+    m_transforms.clear();
     if (isOwner()) {
         while (!m_referenceEntities.isEmpty()) {
             delete m_referenceEntities.takeFirst();
@@ -234,6 +238,103 @@ void RS_Preview::addStretchablesFrom(RS_EntityContainer& container, [[maybe_unus
     }
 }
 
+/**
+ * @return true, if the given original entities are too many to be previewed by clones, so they
+ * should be previewed by addTransformed().
+ */
+bool RS_Preview::isPreviewedTransformed(const std::vector<RS_Entity*>& entities) {
+    setTransformedEntities(entities);
+    return m_previewTransformed;
+}
+
+/**
+ * Adds a preview of the original entities, transformed by the given affine transformation
+ * of world coordinates. The entities are not cloned: their rendering is recorded once and
+ * replayed for each transformation, so the cost of preview doesn't depend on the amount of
+ * entities and all of them are shown.
+ */
+void RS_Preview::addTransformed(const std::vector<RS_Entity*>& entities, const QTransform& wcsTransform) {
+    setTransformedEntities(entities);
+    m_transforms.push_back(wcsTransform);
+}
+
+/**
+ * Drops the original entities and their recorded rendering, should be called once the
+ * entities may be modified.
+ */
+void RS_Preview::resetTransformed() {
+    m_transformedEntities.clear();
+    m_transforms.clear();
+    m_previewTransformed = false;
+    m_transformedPicture = QPicture();
+    m_pictureValid = false;
+}
+
+void RS_Preview::setTransformedEntities(const std::vector<RS_Entity*>& entities) {
+    if (entities == m_transformedEntities) {
+        return;
+    }
+    m_transformedEntities = entities;
+    m_pictureValid = false;
+
+    unsigned int count = 0;
+    for (RS_Entity* e: entities) {
+        count += e->countDeep();
+        if (count > m_maxEntities) {
+            break;
+        }
+    }
+    m_previewTransformed = count > m_maxEntities;
+}
+
+void RS_Preview::recordTransformedEntities(RS_Painter* painter, const QTransform& guiTransform) {
+    RS_Vector minV{false};
+    RS_Vector maxV{false};
+    for (RS_Entity* e: m_transformedEntities) {
+        minV = RS_Vector::minimum(minV, e->getMin());
+        maxV = RS_Vector::maximum(maxV, e->getMax());
+    }
+
+    m_transformedPicture = QPicture();
+    {
+        RS_Painter recorder(&m_transformedPicture);
+        recorder.copyRenderingSetup(*painter);
+        // entities out of view may be moved into it, so they are rendered as a whole
+        LC_Rect boundingRect{minV, maxV};
+        recorder.setWorldBoundingRect(boundingRect);
+        for (RS_Entity* e: m_transformedEntities) {
+            if (e->isUndone()) {
+                continue;
+            }
+            // entities are drawn by the pen of the preview, as children
+            if (e->rtti() == RS2::EntityImage) {
+                e->drawDraft(&recorder);
+            } else {
+                e->drawAsChild(&recorder);
+            }
+        }
+        recorder.end();
+    }
+    m_pictureGuiTransform = guiTransform;
+    m_picturePen = painter->QPainter::pen();
+    m_pictureValid = true;
+}
+
+void RS_Preview::drawTransformed(RS_Painter* painter) {
+    const QTransform guiTransform = painter->getWorldToGuiTransform();
+    if (!m_pictureValid || m_pictureGuiTransform != guiTransform || m_picturePen != painter->QPainter::pen()) {
+        recordTransformedEntities(painter, guiTransform);
+    }
+    // the recording is in UI coordinates, so each transformation is applied as guiTransform^-1 * transform * guiTransform
+    const QTransform guiInverted = guiTransform.inverted();
+    for (const QTransform& transform: m_transforms) {
+        painter->save();
+        painter->setWorldTransform(guiInverted * transform * guiTransform, true);
+        painter->drawPicture(0, 0, m_transformedPicture);
+        painter->restore();
+    }
+}
+
 void RS_Preview::draw(RS_Painter* painter) {
 //    bool drawTextsAsDraftsForPreview = view->isDrawTextsAsDraftForPreview();
 // fixme - ucs - achieve view - store as field? This temporary for compilation...
@@ -260,6 +361,9 @@ void RS_Preview::draw(RS_Painter* painter) {
                 e->draw(painter);
         }
     }
+    if (!m_transforms.empty()) {
+        drawTransformed(painter);
+    }
 }
 
 void RS_Preview::addReferenceEntitiesToContainer(RS_EntityContainer *container){
@@ -28,6 +28,10 @@
 #ifndef RS_PREVIEW_H
 #define RS_PREVIEW_H
 
+#include <QPen>
+#include <QPicture>
+#include <QTransform>
+
 #include "rs_entitycontainer.h"
 
 class LC_GraphicViewport;
@@ -53,13 +57,36 @@ public:
     void addAllFrom(RS_EntityContainer& container, LC_GraphicViewport* view);
     void addStretchablesFrom(RS_EntityContainer& container, LC_GraphicViewport* view,
                                      const RS_Vector& v1, const RS_Vector& v2);
+    bool isPreviewedTransformed(const std::vector<RS_Entity*>& entities);
+    void addTransformed(const std::vector<RS_Entity*>& entities, const QTransform& wcsTransform);
+    void resetTransformed();
     void draw(RS_Painter* painter) override;
     void addReferenceEntitiesToContainer(RS_EntityContainer* container);
     void clear() override;
     int getMaxAllowedEntities();
 private:
+    void setTransformedEntities(const std::vector<RS_Entity*>& entities);
+    void recordTransformedEntities(RS_Painter* painter, const QTransform& guiTransform);
+    void drawTransformed(RS_Painter* painter);
+
     unsigned int m_maxEntities {0};
     QList<RS_Entity*> m_referenceEntities;
     LC_GraphicViewport* m_viewport {nullptr};
+
+    /**
+     * Original entities (not owned) of a large selection, previewed by drawing through
+     * the transformations of the modification instead of by transformed clones
+     */
+    std::vector<RS_Entity*> m_transformedEntities;
+    std::vector<QTransform> m_transforms;
+    bool m_previewTransformed = false;
+    /**
+     * Rendering of the transformed entities, recorded once and replayed for each
+     * transformation while the viewport and the pen are the same
+     */
+    QPicture m_transformedPicture;
+    QTransform m_pictureGuiTransform;
+    QPen m_picturePen;
+    bool m_pictureValid = false;
 };
 #endif
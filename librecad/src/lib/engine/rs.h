@@ -173,6 +173,7 @@ namespace RS2 {
         EntityRefArc,
         EntityRefCircle,
         EntityRefEllipse,
+        EntityPointCloud,   /**< Point cloud */
     };
 
 
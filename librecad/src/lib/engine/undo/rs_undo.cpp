@@ -105,11 +105,13 @@ void RS_Undo::startUndoCycle(){
         }
 
         // delete obsolete undoables which are not in keep list
+        std::vector<RS_Undoable*> removed;
         for (RS_Undoable* undoable: obsolete) {
             if (keep.end() == keep.find(undoable)) {
-                removeUndoable(undoable);
+                removed.push_back(undoable);
             }
         }
+        removeUndoables(removed);
         // clean up obsolete undoCycles
         undoList.erase(m_redoPointer, undoList.cend());
         m_redoPointer = undoList.cend();
@@ -119,6 +121,12 @@ void RS_Undo::startUndoCycle(){
     currentCycle = std::make_shared<RS_UndoCycle>();
 }
 
+void RS_Undo::removeUndoables(const std::vector<RS_Undoable*>& undoables) {
+    for (RS_Undoable* undoable: undoables) {
+        removeUndoable(undoable);
+    }
+}
+
 /**
  * Adds an undoable to the current undo cycle.
  */
@@ -65,6 +65,13 @@ public:
      */
     virtual void removeUndoable(RS_Undoable* u) = 0;
 
+    /**
+     * Deletes the given Undoables, which are no longer in the undo buffer.
+     * By default, removeUndoable() is called for each of them; may be
+     * overwritten to delete them at once.
+     */
+    virtual void removeUndoables(const std::vector<RS_Undoable*>& undoables);
+
     /**
 	  *\brief enable/disable redo/undo buttons in main application window
 	  *\author: Dongxu Li
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+
+#include "lc_parallel.h"
+
+namespace LC_Parallel {
+
+WorkerPool& WorkerPool::instance() {
+    static WorkerPool pool;
+    return pool;
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_changed.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::run(size_t count, const std::function<void(size_t)>& task) {
+    // the calling thread takes part in the work
+    ensureWorkers(count - 1);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    size_t pending = count;
+    for (size_t index = 0; index < count; ++index) {
+        m_queue.push_back({&task, index, &pending});
+    }
+    m_changed.notify_all();
+    while (pending > 0) {
+        if (!runQueued(lock)) {
+            m_changed.wait(lock);
+        }
+    }
+}
+
+void WorkerPool::ensureWorkers(size_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (m_workers.size() < count) {
+        m_workers.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+void WorkerPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        if (!runQueued(lock)) {
+            m_changed.wait(lock);
+        }
+    }
+}
+
+bool WorkerPool::runQueued(std::unique_lock<std::mutex>& lock) {
+    if (m_queue.empty()) {
+        return false;
+    }
+    Task task = m_queue.front();
+    m_queue.pop_front();
+    lock.unlock();
+    (*task.function)(task.index);
+    lock.lock();
+    if (--*task.pending == 0) {
+        m_changed.notify_all();
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,135 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#ifndef LC_PARALLEL_H
+#define LC_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Minimalistic helpers for splitting CPU-bound geometry work over worker threads.
+ * The work is split into contiguous chunks, so the results collected per chunk
+ * may be merged in the original order.
+ */
+namespace LC_Parallel {
+    /**
+     * Worker threads shared by all parallel work of the process. Threads are started on
+     * demand and kept until the process exits, so frequent work, like rendering of each
+     * frame, doesn't pay for starting threads.
+     */
+    class WorkerPool {
+    public:
+        static WorkerPool& instance();
+
+        ~WorkerPool();
+
+        /**
+         * Calls task(index) for each index of range [0, count) on the workers, and waits for
+         * completion. The task must not throw. The calling thread runs queued tasks while
+         * waiting, so waiting from within a task doesn't block the workers.
+         */
+        void run(size_t count, const std::function<void(size_t)>& task);
+
+    private:
+        struct Task {
+            const std::function<void(size_t)>* function = nullptr;
+            size_t index = 0;
+            //! tasks of the run not completed yet
+            size_t* pending = nullptr;
+        };
+
+        WorkerPool() = default;
+        void ensureWorkers(size_t count);
+        void workerLoop();
+        //! runs the first queued task, if any; the lock is released meanwhile
+        bool runQueued(std::unique_lock<std::mutex>& lock);
+
+        std::mutex m_mutex;
+        //! notified when tasks are queued or completed, and on stopping
+        std::condition_variable m_changed;
+        std::deque<Task> m_queue;
+        std::vector<std::thread> m_workers;
+        bool m_stopping = false;
+    };
+
+    /**
+     * @return number of chunks the range of given size is split into, 1 if the range
+     * is too small to benefit from threads
+     */
+    inline size_t chunksCount(size_t count, size_t minChunkSize) {
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t chunks = count / std::max<size_t>(1, minChunkSize);
+        return std::max<size_t>(1, std::min(threads, chunks));
+    }
+
+    /**
+     * Calls chunkFunction(chunkIndex, begin, end) for each of given number of chunks of range [0, count).
+     * Chunks are processed by the shared workers and the calling thread, which waits for completion
+     * of all of them. An exception thrown by any chunk is re-thrown to the caller.
+     */
+    template<typename ChunkFunction>
+    void forEachChunk(size_t count, size_t chunks, ChunkFunction&& chunkFunction) {
+        if (chunks <= 1) {
+            chunkFunction(0, 0, count);
+            return;
+        }
+        std::vector<std::exception_ptr> errors(chunks);
+        WorkerPool::instance().run(chunks, [&chunkFunction, &errors, count, chunks](size_t chunk) {
+            try {
+                chunkFunction(chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        });
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    /**
+     * Calls itemFunction(index) for each index of range [0, count) on given number of threads.
+     * Indices are handed out one at a time, so a long item does not hold up the items
+     * behind it; suitable for items of very different cost, like whole files.
+     */
+    template<typename ItemFunction>
+    void forEachItem(size_t count, size_t threads, ItemFunction&& itemFunction) {
+        std::atomic<size_t> next{0};
+        threads = std::max<size_t>(1, std::min(threads, count));
+        forEachChunk(threads, threads, [&itemFunction, &next, count](size_t, size_t, size_t) {
+            for (size_t index = next++; index < count; index = next++) {
+                itemFunction(index);
+            }
+        });
+    }
+}
+
+#endif // LC_PARALLEL_H
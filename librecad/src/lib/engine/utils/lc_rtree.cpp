@@ -28,9 +28,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <boost/geometry/geometries/register/point.hpp>
 #include <boost/geometry/index/rtree.hpp>
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "lc_rect.h"
 #include "lc_rtree.h"
 #include "rs.h"
+#include "rs_entity.h"
 #include "rs_vector.h"
 
 namespace bg = boost::geometry;
@@ -39,6 +43,63 @@ using BPoint = bg::model::point<double, 2, bg::cs::cartesian> ;
 using BBox = bg::model::box<BPoint>;
 using TreeValue = std::pair<BBox, unsigned>;
 
+namespace {
+struct EntityNode {
+    RS_Entity* entity = nullptr;
+    long long order = 0;
+    // entity borders when indexed
+    RS_Vector minV{false};
+    RS_Vector maxV{false};
+
+    bool operator == (const EntityNode& other) const
+    {
+        return entity == other.entity;
+    }
+};
+using EntityTreeValue = std::pair<BBox, EntityNode>;
+
+/**
+ * @brief addToBox extend the box by a point
+ */
+void addToBox(BBox& box, bool& hasBox, const RS_Vector& point)
+{
+    if (!point.valid || point.x <= RS_MINDOUBLE || point.x >= RS_MAXDOUBLE
+        || point.y <= RS_MINDOUBLE || point.y >= RS_MAXDOUBLE)
+        return;
+    BPoint bPoint{point.x, point.y};
+    if (hasBox) {
+        bg::expand(box, bPoint);
+    } else {
+        box = BBox{bPoint, bPoint};
+        hasBox = true;
+    }
+}
+
+/**
+ * @brief toEntityBox find the box enclosing entity borders and reference points
+ * @return false, if the entity has no finite extent, e.g. construction lines, or lines
+ * on construction layers, which are drawn infinite
+ */
+bool toEntityBox(const RS_Entity& entity, BBox& box)
+{
+    if (entity.rtti() == RS2::EntityConstructionLine)
+        return false;
+    if (entity.rtti() == RS2::EntityLine && entity.isConstruction())
+        return false;
+    bool hasBox = false;
+    const RS_Vector minV = entity.getMin();
+    const RS_Vector maxV = entity.getMax();
+    if (minV.x <= maxV.x && minV.y <= maxV.y) {
+        addToBox(box, hasBox, minV);
+        addToBox(box, hasBox, maxV);
+    }
+    for (const RS_Vector& ref: entity.getRefPoints())
+        addToBox(box, hasBox, ref);
+    addToBox(box, hasBox, entity.getCenter());
+    return hasBox;
+}
+}
+
 namespace lc {
 
 namespace geo {
@@ -165,6 +226,163 @@ RS_VectorSolutions RTree::PointsInBox(const Area& area) const
     return m_pRTree->Intersects(box);
 }
 
+struct EntityRTree::EntityRTreeImpl: public bgi::rtree< EntityTreeValue, bgi::quadratic<16> >
+{
+    using Base = bgi::rtree< EntityTreeValue, bgi::quadratic<16> >;
+
+    void Add(RS_Entity* entity, long long order)
+    {
+        EntityTreeValue value{BBox{}, EntityNode{entity, order, entity->getMin(), entity->getMax()}};
+        if (toEntityBox(*entity, value.first)) {
+            insert(value);
+            m_values.emplace(entity, value);
+        } else {
+            m_unbounded.push_back(value.second);
+        }
+    }
+
+    // node values of indexed entities, needed to remove nodes
+    std::unordered_map<RS_Entity*, EntityTreeValue> m_values;
+    // entities without a finite extent, always visited
+    std::vector<EntityNode> m_unbounded;
+};
+
+EntityRTree::EntityRTree():
+    m_pRTree{std::make_unique<EntityRTreeImpl>()}
+{}
+
+EntityRTree::~EntityRTree() = default;
+
+void EntityRTree::Build(const std::vector<RS_Entity*>& entities)
+{
+    Clear();
+    std::vector<EntityTreeValue> values;
+    values.reserve(entities.size());
+    m_pRTree->m_values.reserve(entities.size());
+    for (size_t i = 0; i < entities.size(); ++i) {
+        RS_Entity* entity = entities[i];
+        if (entity == nullptr)
+            continue;
+        EntityTreeValue value{BBox{}, EntityNode{entity, static_cast<long long>(i), entity->getMin(), entity->getMax()}};
+        if (toEntityBox(*entity, value.first)) {
+            values.push_back(value);
+            m_pRTree->m_values.emplace(entity, value);
+        } else {
+            m_pRTree->m_unbounded.push_back(value.second);
+        }
+    }
+    // bulk loading by the packing algorithm
+    EntityRTreeImpl::Base packed{values.cbegin(), values.cend()};
+    m_pRTree->swap(packed);
+}
+
+void EntityRTree::Insert(RS_Entity* entity, long long order)
+{
+    if (entity == nullptr)
+        return;
+    Remove(entity);
+    m_pRTree->Add(entity, order);
+}
+
+bool EntityRTree::Update(RS_Entity* entity)
+{
+    auto it = m_pRTree->m_values.find(entity);
+    if (it == m_pRTree->m_values.end())
+        return false;
+    const EntityNode& node = it->second.second;
+    if (node.minV == entity->getMin() && node.maxV == entity->getMax())
+        return false;
+    const long long order = node.order;
+    m_pRTree->remove(it->second);
+    m_pRTree->m_values.erase(it);
+    m_pRTree->Add(entity, order);
+    return true;
+}
+
+bool EntityRTree::Remove(RS_Entity* entity)
+{
+    auto it = m_pRTree->m_values.find(entity);
+    if (it != m_pRTree->m_values.end()) {
+        m_pRTree->remove(it->second);
+        m_pRTree->m_values.erase(it);
+        return true;
+    }
+    auto& unbounded = m_pRTree->m_unbounded;
+    auto uit = std::find_if(unbounded.begin(), unbounded.end(), [entity](const EntityNode& node) {
+        return node.entity == entity;
+    });
+    if (uit != unbounded.end()) {
+        unbounded.erase(uit);
+        return true;
+    }
+    return false;
+}
+
+void EntityRTree::Clear()
+{
+    m_pRTree->clear();
+    m_pRTree->m_values.clear();
+    m_pRTree->m_unbounded.clear();
+}
+
+size_t EntityRTree::Size() const
+{
+    return m_pRTree->size() + m_pRTree->m_unbounded.size();
+}
+
+bool EntityRTree::Order(RS_Entity* entity, long long& order) const
+{
+    auto it = m_pRTree->m_values.find(entity);
+    if (it != m_pRTree->m_values.end()) {
+        order = it->second.second.order;
+        return true;
+    }
+    for (const EntityNode& node: m_pRTree->m_unbounded) {
+        if (node.entity == entity) {
+            order = node.order;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<RS_Entity*> EntityRTree::EntitiesInBox(const Area& area) const
+{
+    BBox box{{area.minP().x, area.minP().y}, {area.maxP().x, area.maxP().y}};
+    std::vector<EntityTreeValue> result_s;
+    m_pRTree->query(bgi::intersects(box), std::back_inserter(result_s));
+    std::vector<EntityNode> nodes;
+    nodes.reserve(result_s.size() + m_pRTree->m_unbounded.size());
+    nodes.insert(nodes.end(), m_pRTree->m_unbounded.cbegin(), m_pRTree->m_unbounded.cend());
+    for (const auto& [nodeBox, node]: result_s)
+        nodes.push_back(node);
+    std::sort(nodes.begin(), nodes.end(), [](const EntityNode& a, const EntityNode& b) {
+        return a.order < b.order;
+    });
+    std::vector<RS_Entity*> ret;
+    ret.reserve(nodes.size());
+    for (const EntityNode& node: nodes)
+        ret.push_back(node.entity);
+    return ret;
+}
+
+void EntityRTree::VisitNearest(const RS_Vector& point, const NearestVisitor& visitor) const
+{
+    for (const EntityNode& node: m_pRTree->m_unbounded)
+        if (!visitor(node.entity, node.order, 0.))
+            return;
+    if (m_pRTree->empty())
+        return;
+
+    BPoint bPoint{point.x, point.y};
+    // the incremental nearest query visits nodes by increasing box distance
+    for (auto it = m_pRTree->qbegin(bgi::nearest(bPoint, static_cast<unsigned>(m_pRTree->size())));
+         it != m_pRTree->qend(); ++it) {
+        if (!visitor(it->second.entity, it->second.order, bg::distance(bPoint, it->first)))
+            return;
+    }
+}
+
 } // namespace geo
 } // namespace lc
 //EOF
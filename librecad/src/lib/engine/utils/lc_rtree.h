@@ -24,8 +24,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #ifndef LC_RTree_H
 #define LC_RTree_H
 
+#include <functional>
 #include <memory>
+#include <vector>
 
+class RS_Entity;
 class RS_Vector;
 class RS_VectorSolutions;
 
@@ -83,10 +86,76 @@ private:
     struct RTreeImpl;
     std::unique_ptr<RTreeImpl> m_pRTree;
 };
+
+/**
+ * @brief Provide the R-Tree container of entities
+ *        Each node is a value pair of {Rect, {entity, order}}, with the Rect
+ *        as the box enclosing the entity borders and all its reference points,
+ *        and order the position of the entity in its container. The distance
+ *        from a point to a node box is therefore a lower bound of any distance
+ *        measured to the entity (nearest point, endpoint, center, reference).
+ *        The implemented query methods:
+ *          EntitiesInBox: return all entities with boxes intersecting a given box
+ *          VisitNearest: visit entities by increasing box distance to a point
+ */
+class EntityRTree {
+public:
+    /**
+     * @brief visitor of nearest entities
+     * @param entity - the entity visited
+     * @param order - the container order of the entity
+     * @param boxDistance - the distance from the query point to the entity box
+     * @return false to stop the search
+     */
+    using NearestVisitor = std::function<bool(RS_Entity* entity, long long order, double boxDistance)>;
+
+    EntityRTree();
+    ~EntityRTree();
+
+    /**
+     * @brief Build rebuild the tree from the given entities by bulk loading,
+     *        the order of each entity is its index in the vector
+     */
+    void Build(const std::vector<RS_Entity*>& entities);
+    /**
+     * @brief Insert insert an entity with its current borders
+     * @param order - container order, used to resolve ties of equal distance
+     */
+    void Insert(RS_Entity* entity, long long order);
+    /**
+     * @brief Update update the node of an entity, if its borders have been changed
+     * @return true, if the node is updated
+     */
+    bool Update(RS_Entity* entity);
+    /**
+     * @brief Remove remove an entity
+     * @return true, if the entity was found in the tree
+     */
+    bool Remove(RS_Entity* entity);
+    void Clear();
+    size_t Size() const;
+    /**
+     * @brief Order find the container order of an entity
+     * @return false, if the entity isn't in the tree
+     */
+    bool Order(RS_Entity* entity, long long& order) const;
+
+    /**
+     * @brief EntitiesInBox find entities with boxes intersecting the given box
+     * @return entities sorted by their container order
+     */
+    std::vector<RS_Entity*> EntitiesInBox(const Area& area) const;
+    void VisitNearest(const RS_Vector& point, const NearestVisitor& visitor) const;
+
+private:
+    struct EntityRTreeImpl;
+    std::unique_ptr<EntityRTreeImpl> m_pRTree;
+};
 } // geo
 } // lc
 
 using LC_RTree = lc::geo::RTree;
+using LC_EntityRTree = lc::geo::EntityRTree;
 
 #endif
 //EOF
@@ -34,6 +34,7 @@
 #include <QFileInfo>
 
 #include "lc_parabola.h"
+#include "lc_pointcloud.h"
 #include "rs_arc.h"
 #include "rs_circle.h"
 #include "rs_dimaligned.h"
@@ -51,6 +52,7 @@
 #include "rs_mtext.h"
 #include "rs_point.h"
 #include "rs_polyline.h"
+#include "rs_settings.h"
 #include "rs_solid.h"
 #include "rs_spline.h"
 #include "lc_splinepoints.h"
@@ -164,6 +166,7 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unus
     graphic = &g;
     currentContainer = graphic;
 	dummyContainer = new RS_EntityContainer(nullptr, true);
+    pointClouds.clear();
 
     this->file = file;
     // add some variables that need to be there for DXF drawings:
@@ -181,6 +184,9 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unus
         RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading DWG file");
         if (RS_DEBUG->getLevel()== RS_Debug::D_DEBUGGING)
             dwgr.setDebug(DRW::DebugLevel::Debug);
+        // entities of 2004+ files are decoded sequentially by default, 0 - on all cores
+        int decodingThreads = LC_GET_ONE_INT("Defaults", "DwgDecodingThreads", 1);
+        dwgr.setDecodingThreads(decodingThreads > 0 ? unsigned(decodingThreads) : 0u);
         bool success = dwgr.read(this, true);
         RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading DWG file: OK");
         RS_DIALOGFACTORY->commandMessage(QObject::tr("Opened dwg file version %1.").arg(printDwgVersion(dwgr.getVersion())));
@@ -214,6 +220,7 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unus
     }
 #endif
 
+    addPointClouds();
     delete dummyContainer;
     /*set current layer */
     RS_Layer* cl = graphic->findLayer(graphic->getVariableString("$CLAYER", "0"));
@@ -489,6 +496,9 @@ void RS_FilterDXFRW::endBlock() {
  * Implementation of the method which handles point entities.
  */
 void RS_FilterDXFRW::addPoint(const DRW_Point& data) {
+    if (addPointCloudPoint(data)) {
+        return;
+    }
     RS_Vector v(data.basePoint.x, data.basePoint.y);
 
     RS_Point* entity = new RS_Point(currentContainer,
@@ -500,6 +510,72 @@ void RS_FilterDXFRW::addPoint(const DRW_Point& data) {
 
 
 
+/**
+ * Adds the point to its point cloud, if the point has the extended data written by
+ * writePointCloud().
+ * @return true if the point belongs to a point cloud
+ */
+bool RS_FilterDXFRW::addPointCloudPoint(const DRW_Point& data) {
+    bool isLCdata = false;
+    bool isCloud = false;
+    int integers = 0;
+    int id = 0;
+    int number = 0;
+    QString code;
+    for (const auto& variant: data.extData) {
+        switch (variant->code()) {
+            case 1001:
+                isLCdata = *variant->content.s == std::string("LibreCad");
+                break;
+            case 1000:
+                if (isLCdata && !isCloud) {
+                    isCloud = *variant->content.s == std::string("PointCloud");
+                } else if (isLCdata) {
+                    code = QString::fromUtf8(variant->content.s->c_str());
+                }
+                break;
+            case 1071:
+                if (isLCdata && isCloud) {
+                    if (integers++ == 0) {
+                        id = variant->content.i;
+                    } else {
+                        number = variant->content.i;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    if (!isCloud || integers == 0) {
+        return false;
+    }
+
+    auto it = pointClouds.find(id);
+    if (it == pointClouds.end()) {
+        // attributes of the cloud are taken from its first point
+        PointCloudImport& cloud = pointClouds[id];
+        cloud.container = currentContainer;
+        cloud.attributes = data;
+        cloud.attributes.extData.clear();
+        it = pointClouds.find(id);
+    }
+    it->second.data.append(data.basePoint.x, data.basePoint.y, data.basePoint.z, number, code);
+    return true;
+}
+
+/**
+ * Creates entities of point clouds read by addPointCloudPoint().
+ */
+void RS_FilterDXFRW::addPointClouds() {
+    for (auto& [id, cloud]: pointClouds) {
+        auto* entity = new LC_PointCloud(cloud.container, std::move(cloud.data));
+        setEntityAttributes(entity, &cloud.attributes);
+        cloud.container->addEntity(entity);
+    }
+    pointClouds.clear();
+}
+
 /**
  * Implementation of the method which handles line entities.
  */
@@ -1592,6 +1668,7 @@ bool RS_FilterDXFRW::fileExport(RS_Graphic& g, const QString& file, RS2::FormatT
 
     // set version for DXF filter:
     exactColor = false;
+    pointCloudId = 0;
     DRW::Version exportVersion;
     if (type==RS2::FormatDXFRW12) {
         exportVersion = DRW::AC1009;
@@ -2366,6 +2443,9 @@ void RS_FilterDXFRW::writeEntity(RS_Entity* e){
     case RS2::EntityPoint:
         writePoint((RS_Point*)e);
         break;
+    case RS2::EntityPointCloud:
+        writePointCloud((LC_PointCloud*)e);
+        break;
     case RS2::EntityLine:
         writeLine((RS_Line*)e);
         break;
@@ -2437,6 +2517,35 @@ void RS_FilterDXFRW::writePoint(RS_Point* p) {
 }
 
 
+/**
+ * Writes the given point cloud as POINT entities. Points are tagged by extended data of
+ * the cloud (id, optional number and code), so the cloud is restored on import, while other
+ * applications read ordinary points.
+ */
+void RS_FilterDXFRW::writePointCloud(LC_PointCloud* p) {
+    const LC_PointCloudData& data = p->getData();
+    DRW_Point point;
+    getEntityAttributes(&point, p);
+    pointCloudId++;
+    for (size_t i = 0; i < data.size(); i++) {
+        point.basePoint.x = data.x[i];
+        point.basePoint.y = data.y[i];
+        point.basePoint.z = data.getElevation(i);
+        point.extData.clear();
+        point.extData.push_back(std::make_shared<DRW_Variant>(1001, "LibreCad"));
+        point.extData.push_back(std::make_shared<DRW_Variant>(1000, "PointCloud"));
+        point.extData.push_back(std::make_shared<DRW_Variant>(1071, pointCloudId));
+        if (data.hasNumbers()) {
+            point.extData.push_back(std::make_shared<DRW_Variant>(1071, data.numbers[i]));
+        }
+        if (data.hasCodes()) {
+            point.extData.push_back(std::make_shared<DRW_Variant>(1000, data.codes[i].toUtf8().toStdString()));
+        }
+        dxfW->writePoint(&point);
+    }
+}
+
+
 /**
  * Writes the given Line( entity to the file.
  */
@@ -27,12 +27,15 @@
 #ifndef RS_FILTERDXFRW_H
 #define RS_FILTERDXFRW_H
 
+#include <map>
+
 #include "rs_filterinterface.h"
 
 #include "rs_color.h"
 #include "rs_dimension.h"
 #include "drw_interface.h"
 #include "libdxfrw.h"
+#include "lc_pointcloud.h"
 
 class LC_DimStyle;
 class RS_Point;
@@ -151,6 +154,7 @@ public:
     void writeAppId() override;
 
     void writePoint(RS_Point* p);
+    void writePointCloud(LC_PointCloud* p);
     void writeLine(RS_Line* l);
     void writeCircle(RS_Circle* c);
     void writeArc(RS_Arc* a);
@@ -204,6 +208,8 @@ public:
     static RS_FilterInterface* createFilter(){return new RS_FilterDXFRW();}
 
 private:
+    bool addPointCloudPoint(const DRW_Point& data);
+    void addPointClouds();
     void prepareBlocks();
     void writeEntity(RS_Entity* e);
 #ifdef DWGSUPPORT
@@ -242,6 +248,15 @@ private:
     QHash<int, RS_EntityContainer*> blockHash;
     /** Pointer to entity container to store possible orphan entities like paper space */
     RS_EntityContainer* dummyContainer;
+    /** Points of point clouds read from POINT entities, by cloud id. Entities are created at the end of import */
+    struct PointCloudImport {
+        RS_EntityContainer* container = nullptr;
+        DRW_Point attributes;
+        LC_PointCloudData data;
+    };
+    std::map<int, PointCloudImport> pointClouds;
+    /** Id of the last point cloud written */
+    int pointCloudId = 0;
     LC_DimStyle *createDimStyle(const DRW_Dimstyle &s);
 };
 
@@ -403,6 +403,13 @@ void LC_GraphicViewport::fireRedrawNeeded(){
     }
 }
 
+void LC_GraphicViewport::fireSelectionChanged(){
+    for (int i=0; i<viewportListeners.size(); ++i) {
+        LC_GraphicViewPortListener* l = viewportListeners.at(i);
+        l->onViewportSelectionChanged();
+    }
+}
+
 void LC_GraphicViewport::fireUcsChanged(LC_UCS *ucs) {
     invalidateGrid();
     for (int i=0; i<viewportListeners.size(); ++i) {
@@ -164,6 +164,7 @@ public:
     void addViewportListener(LC_GraphicViewPortListener* listener);
     void removeViewportListener(LC_GraphicViewPortListener* listener);
     void notifyChanged(){ fireRedrawNeeded();}
+    void notifySelectionChanged(){ fireSelectionChanged();}
 
     bool areAnglesCounterClockwise();
     double getAnglesBaseAngle();
@@ -224,6 +225,7 @@ protected:
     void fireViewportChanged();
     void fireUcsChanged(LC_UCS* ucs);
     void fireRedrawNeeded();
+    void fireSelectionChanged();
     void firePreviousZoomChanged(bool value);
     void fireRelativeZeroChanged(const RS_Vector &pos);
 
@@ -30,6 +30,7 @@ class LC_GraphicViewPortListener{
 public:
     virtual void onViewportChanged() {}
     virtual void onViewportRedrawNeeded() {}
+    virtual void onViewportSelectionChanged() {onViewportRedrawNeeded();}
     virtual void previousZoomChanged([[maybe_unused]]bool value) {}
     virtual void onRelativeZeroChanged([[maybe_unused]]const RS_Vector& pos) {}
     virtual void onUCSChanged([[maybe_unused]]LC_UCS* ucs) {}
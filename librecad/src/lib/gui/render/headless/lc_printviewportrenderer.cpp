@@ -24,6 +24,8 @@
 
 #include "lc_graphicviewport.h"
 #include "rs_entitycontainer.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
 #include "rs_math.h"
 #include "rs_painter.h"
 
@@ -40,51 +42,58 @@ LC_PrintViewportRenderer::LC_PrintViewportRenderer(LC_GraphicViewport *viewport,
 void LC_PrintViewportRenderer::doRender() {
     setupPainter(painter);
     RS_EntityContainer *container = viewport->getContainer();
-    container->draw(painter);
+    renderContainer(painter, container);
 }
 
 
 void LC_PrintViewportRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    isVisibleTimer.start();
-#endif
+    m_renderStats.entitiesVisited++;
     // entity is not visible:
     bool visible = e->isVisible();
-#ifdef DEBUG_RENDERING
-    isVisibleTime += isVisibleTimer.nsecsElapsed();
-#endif
     if (!visible) {
+        m_renderStats.entitiesCulled++;
         return;
     }
 
-#ifdef DEBUG_RENDERING
-    isConstructionTimer.start();
-#endif
     bool constructionEntity = e->isConstruction();
-#ifdef DEBUG_RENDERING
-    isConstructionTime += isConstructionTimer.nsecsElapsed();
-#endif
     // do not draw construction layer on print preview or print
-    if (!e->isPrint() || constructionEntity)
+    if (!e->isPrint() || constructionEntity) {
+        m_renderStats.entitiesCulled++;
         return;
+    }
 
     if (isOutsideOfBoundingClipRect(e, constructionEntity)) {
+        m_renderStats.entitiesCulled++;
         return;
     }
     setPenForPrintingEntity(painter, e);
     justDrawEntity(painter, e);
 }
 
+bool LC_PrintViewportRenderer::prepareInstancePart(RS_Painter *painter, const RS_Insert *insert, const RS_Pen &pen,
+                                                   const RS_Layer *layer, const RS_Vector &wcsMin, const RS_Vector &wcsMax) {
+    // as by renderEntity(), construction layers aren't printed
+    if (layer != nullptr && (layer->isFrozen() || !layer->isPrint() || layer->isConstruction())) {
+        return false;
+    }
+    if (isOutsideOfBoundingClipRect(wcsMin, wcsMax)) {
+        return false;
+    }
+    setPenForPrintingEntity(painter, pen, insert);
+    return true;
+}
+
 void LC_PrintViewportRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    setPenTimer.start();
-#endif
     // Getting pen from entity (or layer)
-    RS_Pen pen = e->getPenResolved();
+    setPenForPrintingEntity(painter, e->getPenResolved(), e);
+}
+
+void LC_PrintViewportRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_Pen pen, const RS_Entity *e) {
     RS_Pen originalPen = pen;
 
     double patternOffset = painter->currentDashOffset();
     if (lastPaintEntityPen.isSameAs(pen, patternOffset)) {
+        m_renderStats.penReuses++;
         return;
     }
     // Avoid negative widths
@@ -149,9 +158,7 @@ void LC_PrintViewportRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_E
     // we store original pen as last painted, not resolved one - since original pen lead to resulting resolved and may be used by the next entity
     lastPaintEntityPen.updateBy(originalPen);
     painter->setPen(pen);
-#ifdef DEBUG_RENDERING
-    setPenTime += setPenTimer.nsecsElapsed();
-#endif
+    m_renderStats.penSwitches++;
 }
 
 
@@ -31,6 +31,8 @@ class LC_PrintViewportRenderer :public LC_GraphicViewportRenderer{
 public:
     explicit LC_PrintViewportRenderer(LC_GraphicViewport *viewport, RS_Painter* painter);
     void renderEntity(RS_Painter *painter, RS_Entity *entity) override;
+    bool prepareInstancePart(RS_Painter *painter, const RS_Insert *insert, const RS_Pen &pen,
+                             const RS_Layer *layer, const RS_Vector &wcsMin, const RS_Vector &wcsMax) override;
     RS2::DrawingMode getDrawingMode() {
         return drawingMode;
     }
@@ -49,6 +51,7 @@ protected:
     double paperScale = 1.0;
     RS2::DrawingMode drawingMode = RS2::DrawingMode::ModeAuto;
     void setPenForPrintingEntity(RS_Painter *painter, RS_Entity *e);
+    void setPenForPrintingEntity(RS_Painter *painter, RS_Pen pen, const RS_Entity *e);
     void doRender() override;
 };
 
@@ -22,10 +22,13 @@
 
 #include "lc_graphicviewportrenderer.h"
 
+#include <QElapsedTimer>
+
 #include "lc_defaults.h"
 #include "lc_graphicviewport.h"
 #include "lc_linemath.h"
 #include "rs_entity.h"
+#include "rs_entitycontainer.h"
 #include "rs_graphic.h"
 #include "rs_painter.h"
 #include "rs_units.h"
@@ -37,21 +40,35 @@ LC_GraphicViewportRenderer::LC_GraphicViewportRenderer(LC_GraphicViewport* v, QP
 {
 }
 
+/**
+ * Renders a frame. If profiling is enabled, counters of the frame are submitted to the profiler.
+ */
 void LC_GraphicViewportRenderer::render() {
+    LC_RenderProfiler *profiler = LC_RenderProfiler::instance();
+    m_profiling = profiler->isEnabled();
+    m_renderStats = {};
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+
     renderBoundingClipRect = prepareBoundingClipRect();
     doRender();
+
+    if (m_profiling) {
+        m_renderStats.frameTime = frameTimer.nsecsElapsed();
+        profiler->addFrame(m_renderStats);
+    }
 }
 
 void LC_GraphicViewportRenderer::renderEntityAsChild(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    drawEntityCount++;
-    drawTimer.start();
-#endif
-    e->drawAsChild(painter);
-#ifdef DEBUG_RENDERING
-    qint64 elapsed = drawTimer.nsecsElapsed();
-    entityDrawTime+= elapsed;
-#endif
+    if (m_profiling) {
+        QElapsedTimer timer;
+        timer.start();
+        e->drawAsChild(painter);
+        m_renderStats.addEntityTime(e->rtti(), timer.nsecsElapsed());
+    }
+    else {
+        e->drawAsChild(painter);
+    }
 }
 
 void LC_GraphicViewportRenderer::loadSettings() {
@@ -62,10 +79,15 @@ void LC_GraphicViewportRenderer::loadSettings() {
 }
 
 LC_Rect LC_GraphicViewportRenderer::prepareBoundingClipRect(){
-    int width = viewport->getWidth();
-    int height = viewport->getHeight();
-    const RS_Vector ucsViewportLeftBottom = viewport->toUCSFromGui(0, 0);
-    const RS_Vector ucsViewportRightTop = viewport->toUCSFromGui(width, height);
+    return prepareBoundingClipRect(0, 0, viewport->getWidth(), viewport->getHeight());
+}
+
+/**
+ * @return bounding clip rect in world coordinates for the given rect of the screen
+ */
+LC_Rect LC_GraphicViewportRenderer::prepareBoundingClipRect(int guiLeft, int guiTop, int guiRight, int guiBottom){
+    const RS_Vector ucsViewportLeftBottom = viewport->toUCSFromGui(guiLeft, guiTop);
+    const RS_Vector ucsViewportRightTop = viewport->toUCSFromGui(guiRight, guiBottom);
 
     if (viewport->hasUCS()){
         // here were extend (enlarge) clipping rect to ensure that if there is shift/rotation in ucs, resulting bounding box cover the entire screen
@@ -96,36 +118,119 @@ bool LC_GraphicViewportRenderer::isOutsideOfBoundingClipRect(RS_Entity* e, bool
                 }
             }
             else{ // normal line
-                if (e->getMax().x < renderBoundingClipRect.minP().x || e->getMin().x > renderBoundingClipRect.maxP().x ||
-                    e->getMin().y > renderBoundingClipRect.maxP().y || e->getMax().y < renderBoundingClipRect.minP().y){
-                    return true;
-                }
+                return isOutsideOfBoundingClipRect(e->getMin(), e->getMax());
             }
             break;
         }
         default:
-            if (e->getMax().x < renderBoundingClipRect.minP().x || e->getMin().x > renderBoundingClipRect.maxP().x ||
-                e->getMin().y > renderBoundingClipRect.maxP().y || e->getMax().y < renderBoundingClipRect.minP().y){
-                return true;
-            }
+            return isOutsideOfBoundingClipRect(e->getMin(), e->getMax());
     }
     return false;
 }
 
+bool LC_GraphicViewportRenderer::isOutsideOfBoundingClipRect(const RS_Vector &wcsMin, const RS_Vector &wcsMax) const{
+    return wcsMax.x < renderBoundingClipRect.minP().x || wcsMin.x > renderBoundingClipRect.maxP().x ||
+           wcsMin.y > renderBoundingClipRect.maxP().y || wcsMax.y < renderBoundingClipRect.minP().y;
+}
+
+namespace {
+// entities with id 0 aren't drawn, as by RS_EntityContainer::draw()
+bool isDrawable(const RS_Entity *e) {
+    return e != nullptr && e->getId() != 0;
+}
+}
+
+/**
+ * Collects entities of the document container with bounding boxes intersecting the bounding clip rect, by the
+ * spatial index of the container, in the container order. Entities without a finite extent (construction lines,
+ * lines on construction layers) are always collected, and clipped as they are drawn.
+ * @return false, if the index isn't used, so all entities of the container should be drawn
+ */
+bool LC_GraphicViewportRenderer::collectCulledEntities(RS_EntityContainer *container, std::vector<RS_Entity *> &entities) {
+    entities.clear();
+    if (!m_spatialIndexCulling || !container->isDocument()) {
+        return false;
+    }
+    const LC_Rect containerRect{container->getMin(), container->getMax()};
+    // no gain from the index if the whole drawing is visible
+    if (containerRect.inArea(renderBoundingClipRect)) {
+        return false;
+    }
+    std::vector<RS_Entity *> candidates;
+    if (!container->getEntitiesInWindow(renderBoundingClipRect, candidates)) {
+        return false;
+    }
+    for (RS_Entity *e: candidates) {
+        if (isDrawable(e)) {
+            entities.push_back(e);
+        }
+    }
+    return true;
+}
+
+/**
+ * Draws entities of the document container. If the container has a spatial index, only entities with bounding
+ * boxes intersecting the bounding clip rect are visited (in the container order), so the rendering cost depends
+ * on the visible part of the drawing. Otherwise, falls back to drawing the entire container.
+ */
+void LC_GraphicViewportRenderer::renderContainer(RS_Painter *painter, RS_EntityContainer *container) {
+    std::vector<RS_Entity *> entities;
+    if (collectCulledEntities(container, entities)) {
+        for (RS_Entity *e: entities) {
+            painter->drawEntity(e);
+        }
+        return;
+    }
+    // entities of the container are counted, not the container itself
+    container->draw(painter);
+}
+
+/**
+ * Collects entities renderContainer() would draw, in the container order.
+ */
+void LC_GraphicViewportRenderer::collectEntitiesToRender(RS_EntityContainer *container, std::vector<RS_Entity *> &entities) {
+    if (collectCulledEntities(container, entities)) {
+        return;
+    }
+    entities.reserve(container->count());
+    for (RS_Entity *e: *container) {
+        if (isDrawable(e)) {
+            entities.push_back(e);
+        }
+    }
+}
+
 /**
  * Draws an entity.
  * The painter must be initialized and all the attributes (pen) must be set.
  */
 void LC_GraphicViewportRenderer::justDrawEntity(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    drawEntityCount++;
-    drawTimer.start();
-#endif
-    e->draw(painter);
-#ifdef DEBUG_RENDERING
-    qint64 elapsed = drawTimer.nsecsElapsed();
-    entityDrawTime+= elapsed;
-#endif
+    m_renderStats.entitiesDrawn++;
+    if (m_profiling) {
+        QElapsedTimer timer;
+        timer.start();
+        e->draw(painter);
+        m_renderStats.addEntityTime(e->rtti(), timer.nsecsElapsed());
+    }
+    else {
+        e->draw(painter);
+    }
+}
+
+/**
+ * Draws an entity in draft mode, the same way as justDrawEntity().
+ */
+void LC_GraphicViewportRenderer::justDrawEntityDraft(RS_Painter *painter, RS_Entity *e) {
+    m_renderStats.entitiesDrawn++;
+    if (m_profiling) {
+        QElapsedTimer timer;
+        timer.start();
+        e->drawDraft(painter);
+        m_renderStats.addEntityTime(e->rtti(), timer.nsecsElapsed());
+    }
+    else {
+        e->drawDraft(painter);
+    }
 }
 
 void LC_GraphicViewportRenderer::updateEndCapsStyle(const RS_Graphic *graphic) {//        Lineweight endcaps setting for new objects:
@@ -23,21 +23,20 @@
 #ifndef LC_GRAPHICVIEWPORTRENDERER_H
 #define LC_GRAPHICVIEWPORTRENDERER_H
 
+#include <vector>
+
 #include "lc_rect.h"
+#include "lc_renderprofiler.h"
 #include "rs_color.h"
 #include "rs_pen.h"
 
-#define DEBUG_RENDERING_
-
-#ifdef DEBUG_RENDERING
-#include <QElapsedTimer>
-
-#define DEBUG_RENDERING_DETAILS
-#endif
-
 class LC_GraphicViewport;
 class RS_Entity;
+class RS_EntityContainer;
+class RS_Insert;
+class RS_Layer;
 class RS_Painter;
+class RS_Vector;
 class RS_Graphic;
 class QPaintDevice;
 
@@ -49,7 +48,19 @@ class LC_GraphicViewportRenderer{
     void render();
     virtual void renderEntity(RS_Painter* painter, RS_Entity* entity)  = 0;
     void renderEntityAsChild(RS_Painter *painter, RS_Entity *e);
+    /**
+     * Sets the pen of the painter for strokes of a part of an instanced insert (a glyph or a part
+     * of the shared block geometry), which has no entity of its own. Flags are taken from the insert.
+     *
+     * @param pen pen of the part, resolved against the insert and the layer
+     * @param layer layer of the part
+     * @param wcsMin, wcsMax borders of the part
+     * @return false if the part isn't drawn
+     */
+    virtual bool prepareInstancePart(RS_Painter *painter, const RS_Insert *insert, const RS_Pen &pen,
+                                     const RS_Layer *layer, const RS_Vector &wcsMin, const RS_Vector &wcsMax) = 0;
     void justDrawEntity(RS_Painter *painter, RS_Entity *e);
+    void justDrawEntityDraft(RS_Painter *painter, RS_Entity *e);
     void setBackground(const RS_Color &bg);
     const LC_Rect &getBoundingClipRect() const {return renderBoundingClipRect;}
 
@@ -62,6 +73,10 @@ class LC_GraphicViewportRenderer{
     bool getLineWidthScaling() const{
         return m_scaleLineWidth;
     }
+
+    void setSpatialIndexCulling(bool state){
+        m_spatialIndexCulling = state;
+    }
 protected:
     QPaintDevice* pd = nullptr;
     LC_GraphicViewport* viewport = nullptr;
@@ -77,6 +92,7 @@ protected:
     RS_Pen lastPaintEntityPen = {};
 
     LC_Rect prepareBoundingClipRect();
+    LC_Rect prepareBoundingClipRect(int guiLeft, int guiTop, int guiRight, int guiBottom);
     virtual void doRender() = 0;
 
     // painting cached values
@@ -85,6 +101,8 @@ protected:
     double defaultWidthFactor = 1.0;
 
     bool m_scaleLineWidth = true;
+    // use spatial index of the container to visit only entities within the clip rect
+    bool m_spatialIndexCulling = true;
 
     Qt::PenJoinStyle penJoinStyle = Qt::RoundJoin;
     Qt::PenCapStyle penCapStyle = Qt::RoundCap;
@@ -103,26 +121,16 @@ protected:
     void updatePointEntitiesStyle(RS_Graphic *graphic);
     void updateUnitAndDefaultWidthFactors(const RS_Graphic *g);
     bool isOutsideOfBoundingClipRect(RS_Entity *e, bool constructionEntity);
+    bool isOutsideOfBoundingClipRect(const RS_Vector &wcsMin, const RS_Vector &wcsMax) const;
+    void renderContainer(RS_Painter *painter, RS_EntityContainer *container);
+    void collectEntitiesToRender(RS_EntityContainer *container, std::vector<RS_Entity*> &entities);
+    bool collectCulledEntities(RS_EntityContainer *container, std::vector<RS_Entity*> &entities);
 
     RS_Graphic* getGraphic(){return graphic;}
 
-#ifdef DEBUG_RENDERING
-    QElapsedTimer drawTimer;
-    QElapsedTimer isVisibleTimer;
-    QElapsedTimer setPenTimer;
-    QElapsedTimer painterSetPenTimer;
-    QElapsedTimer getPenTimer;
-    QElapsedTimer isConstructionTimer;
-
-    // painting debug
-    int drawEntityCount = 1;
-    long long entityDrawTime = 0;
-    long long isVisibleTime = 0;
-    long long isConstructionTime = 0;
-    long long setPenTime = 0;
-    long long painterSetPenTime = 0;
-    long long getPenTime = 0;
-#endif
+    // counters of the current frame, timings are collected if profiling is enabled
+    bool m_profiling = false;
+    LC_RenderStats m_renderStats;
 
 
     void updateAnglesBasis(RS_Graphic *g);
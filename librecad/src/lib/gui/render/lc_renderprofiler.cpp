@@ -0,0 +1,252 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#include "lc_renderprofiler.h"
+
+#include <algorithm>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace {
+    // units of histograms, in nanoseconds
+    constexpr qint64 FRAME_TIME_UNIT = 1000000;
+    constexpr qint64 ENTITY_TIME_UNIT = 128;
+
+    QString entityTypeName(RS2::EntityType type) {
+        switch (type) {
+            case RS2::EntityContainer: return "Container";
+            case RS2::EntityBlock: return "Block";
+            case RS2::EntityFontChar: return "FontChar";
+            case RS2::EntityInsert: return "Insert";
+            case RS2::EntityGraphic: return "Graphic";
+            case RS2::EntityPoint: return "Point";
+            case RS2::EntityLine: return "Line";
+            case RS2::EntityPolyline: return "Polyline";
+            case RS2::EntityArc: return "Arc";
+            case RS2::EntityCircle: return "Circle";
+            case RS2::EntityEllipse: return "Ellipse";
+            case RS2::EntityHyperbola: return "Hyperbola";
+            case RS2::EntitySolid: return "Solid";
+            case RS2::EntityConstructionLine: return "ConstructionLine";
+            case RS2::EntityMText: return "MText";
+            case RS2::EntityText: return "Text";
+            case RS2::EntityDimAligned: return "DimAligned";
+            case RS2::EntityDimLinear: return "DimLinear";
+            case RS2::EntityDimRadial: return "DimRadial";
+            case RS2::EntityDimDiametric: return "DimDiametric";
+            case RS2::EntityDimAngular: return "DimAngular";
+            case RS2::EntityDimArc: return "DimArc";
+            case RS2::EntityDimLeader: return "DimLeader";
+            case RS2::EntityDimOrdinate: return "DimOrdinate";
+            case RS2::EntityTolerance: return "Tolerance";
+            case RS2::EntityHatch: return "Hatch";
+            case RS2::EntityImage: return "Image";
+            case RS2::EntitySpline: return "Spline";
+            case RS2::EntitySplinePoints: return "SplinePoints";
+            case RS2::EntityParabola: return "Parabola";
+            case RS2::EntityPointCloud: return "PointCloud";
+            default:
+                return QString("Type%1").arg(static_cast<unsigned>(type));
+        }
+    }
+
+    double toMs(qint64 nsecs) {
+        return nsecs * 1e-6;
+    }
+}
+
+void LC_RenderHistogram::add(qint64 duration, qint64 unit) {
+    int bucket = 0;
+    for (qint64 limit = unit; bucket < BUCKETS - 1 && duration >= limit; limit *= 2) {
+        bucket++;
+    }
+    counts[bucket]++;
+}
+
+void LC_RenderHistogram::merge(const LC_RenderHistogram &other) {
+    for (int i = 0; i < BUCKETS; i++) {
+        counts[i] += other.counts[i];
+    }
+}
+
+/**
+ * @return buckets as "below" limits (in the given unit) and counts, the limit of the last bucket is null
+ */
+QJsonObject LC_RenderHistogram::toJson(qint64 unit, const QString &unitName) const {
+    QJsonArray limits;
+    QJsonArray values;
+    qint64 limit = unit;
+    for (int i = 0; i < BUCKETS; i++) {
+        limits.append(i < BUCKETS - 1 ? QJsonValue(double(limit)) : QJsonValue());
+        values.append(double(counts[i]));
+        limit *= 2;
+    }
+    return {{"unit", unitName}, {"below", limits}, {"counts", values}};
+}
+
+void LC_RenderStats::addEntityTime(RS2::EntityType type, qint64 time) {
+    EntityTypeStats &stats = entityTypes[type];
+    stats.count++;
+    stats.time += time;
+    stats.histogram.add(time, ENTITY_TIME_UNIT);
+}
+
+void LC_RenderStats::merge(const LC_RenderStats &other) {
+    frameTime += other.frameTime;
+    backgroundTime += other.backgroundTime;
+    drawingTime += other.drawingTime;
+    overlaysTime += other.overlaysTime;
+    tilesSetupTime += other.tilesSetupTime;
+    entitiesVisited += other.entitiesVisited;
+    entitiesCulled += other.entitiesCulled;
+    entitiesDrawn += other.entitiesDrawn;
+    entitiesAggregated += other.entitiesAggregated;
+    penSwitches += other.penSwitches;
+    penReuses += other.penReuses;
+    pixmapCopies += other.pixmapCopies;
+    for (const auto &[type, typeStats]: other.entityTypes) {
+        EntityTypeStats &stats = entityTypes[type];
+        stats.count += typeStats.count;
+        stats.time += typeStats.time;
+        stats.histogram.merge(typeStats.histogram);
+    }
+}
+
+QJsonObject LC_RenderStats::toJson() const {
+    QJsonObject types;
+    for (const auto &[type, stats]: entityTypes) {
+        types.insert(entityTypeName(type), QJsonObject{
+            {"count", double(stats.count)},
+            {"timeMs", toMs(stats.time)},
+            {"histogram", stats.histogram.toJson(ENTITY_TIME_UNIT, "ns")}
+        });
+    }
+    return {
+        {"frameMs", toMs(frameTime)},
+        {"backgroundMs", toMs(backgroundTime)},
+        {"drawingMs", toMs(drawingTime)},
+        {"overlaysMs", toMs(overlaysTime)},
+        {"tilesSetupMs", toMs(tilesSetupTime)},
+        {"entitiesVisited", double(entitiesVisited)},
+        {"entitiesCulled", double(entitiesCulled)},
+        {"entitiesDrawn", double(entitiesDrawn)},
+        {"entitiesAggregated", double(entitiesAggregated)},
+        {"penSwitches", double(penSwitches)},
+        {"penReuses", double(penReuses)},
+        {"pixmapCopies", double(pixmapCopies)},
+        {"entityTypes", types}
+    };
+}
+
+LC_RenderProfiler *LC_RenderProfiler::instance() {
+    struct LC_RenderProfilerMaker : public LC_RenderProfiler {
+        using LC_RenderProfiler::LC_RenderProfiler;
+    };
+    static LC_RenderProfilerMaker profiler;
+    return &profiler;
+}
+
+void LC_RenderProfiler::setEnabled(bool enabled) {
+    m_enabled = enabled;
+}
+
+void LC_RenderProfiler::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_frameCount = 0;
+    m_maxFrameTime = 0;
+    m_frameHistogram = {};
+    m_totals = {};
+    m_lastFrame = {};
+}
+
+void LC_RenderProfiler::addFrame(const LC_RenderStats &frame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_frameCount++;
+    m_maxFrameTime = std::max(m_maxFrameTime, frame.frameTime);
+    m_frameHistogram.add(frame.frameTime, FRAME_TIME_UNIT);
+    m_totals.merge(frame);
+    m_lastFrame = frame;
+}
+
+qint64 LC_RenderProfiler::getFrameCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frameCount;
+}
+
+QString LC_RenderProfiler::toText() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    QString text;
+    const qint64 frames = std::max<qint64>(1, m_frameCount);
+    text += QString("Frames: %1, average %2 ms, max %3 ms\n")
+        .arg(m_frameCount).arg(toMs(m_totals.frameTime) / frames, 0, 'f', 2).arg(toMs(m_maxFrameTime), 0, 'f', 2);
+    text += QString("Layers (average ms): background %1, drawing %2 (tiles setup %3), overlays %4\n")
+        .arg(toMs(m_totals.backgroundTime) / frames, 0, 'f', 2)
+        .arg(toMs(m_totals.drawingTime) / frames, 0, 'f', 2)
+        .arg(toMs(m_totals.tilesSetupTime) / frames, 0, 'f', 2)
+        .arg(toMs(m_totals.overlaysTime) / frames, 0, 'f', 2);
+
+    text += "\nFrame times:\n";
+    qint64 limit = 1;
+    for (int i = 0; i < LC_RenderHistogram::BUCKETS; i++) {
+        if (m_frameHistogram.counts[i] > 0) {
+            QString range = i < LC_RenderHistogram::BUCKETS - 1 ? QString("< %1 ms").arg(limit) : QString(">= %1 ms").arg(limit / 2);
+            text += QString("  %1 %2\n").arg(range, 12).arg(m_frameHistogram.counts[i]);
+        }
+        limit *= 2;
+    }
+
+    text += "\nLast frame:\n";
+    text += QString("  time %1 ms\n").arg(toMs(m_lastFrame.frameTime), 0, 'f', 2);
+    text += QString("  entities visited %1, culled %2, drawn %3, aggregated %4\n")
+        .arg(m_lastFrame.entitiesVisited).arg(m_lastFrame.entitiesCulled)
+        .arg(m_lastFrame.entitiesDrawn).arg(m_lastFrame.entitiesAggregated);
+    text += QString("  pen switches %1, reused %2, pixmap copies %3\n")
+        .arg(m_lastFrame.penSwitches).arg(m_lastFrame.penReuses).arg(m_lastFrame.pixmapCopies);
+
+    text += "\nEntity types (all frames):\n";
+    for (const auto &[type, stats]: m_totals.entityTypes) {
+        text += QString("  %1 %2 drawn, %3 ms, %4 us each\n")
+            .arg(entityTypeName(type), -16).arg(stats.count)
+            .arg(toMs(stats.time), 0, 'f', 2).arg(stats.time * 1e-3 / std::max<qint64>(1, stats.count), 0, 'f', 2);
+    }
+    return text;
+}
+
+QJsonObject LC_RenderProfiler::toJson() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return {
+        {"frames", double(m_frameCount)},
+        {"maxFrameMs", toMs(m_maxFrameTime)},
+        {"frameHistogram", m_frameHistogram.toJson(FRAME_TIME_UNIT, "ns")},
+        {"totals", m_totals.toJson()},
+        {"lastFrame", m_lastFrame.toJson()}
+    };
+}
+
+bool LC_RenderProfiler::saveJson(const QString &fileName) const {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return file.write(QJsonDocument(toJson()).toJson()) >= 0;
+}
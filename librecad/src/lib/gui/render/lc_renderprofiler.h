@@ -0,0 +1,125 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#ifndef LC_RENDERPROFILER_H
+#define LC_RENDERPROFILER_H
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+
+#include <QJsonObject>
+#include <QString>
+
+#include "rs.h"
+
+/**
+ * Histogram of durations by binary order: bucket i counts durations below unit * 2^i,
+ * the last bucket counts the rest.
+ */
+struct LC_RenderHistogram {
+    static constexpr int BUCKETS = 16;
+    std::array<qint64, BUCKETS> counts{};
+
+    void add(qint64 duration, qint64 unit);
+    void merge(const LC_RenderHistogram& other);
+    QJsonObject toJson(qint64 unit, const QString& unitName) const;
+};
+
+/**
+ * Counters of a single frame, collected by a renderer. Times are in nanoseconds.
+ */
+struct LC_RenderStats {
+    struct EntityTypeStats {
+        qint64 count = 0;
+        qint64 time = 0;
+        LC_RenderHistogram histogram;
+    };
+
+    qint64 frameTime = 0;
+    qint64 backgroundTime = 0;
+    qint64 drawingTime = 0;
+    qint64 overlaysTime = 0;
+    // part of the drawing time spent on the GUI thread before tiles are rendered by workers
+    qint64 tilesSetupTime = 0;
+
+    // entities passed to the renderer, by the spatial index query or by containers
+    qint64 entitiesVisited = 0;
+    // entities skipped as invisible or outside the bounding clip rect
+    qint64 entitiesCulled = 0;
+    qint64 entitiesDrawn = 0;
+    // sub-pixel entities aggregated into the coverage image instead of drawing
+    qint64 entitiesAggregated = 0;
+    qint64 penSwitches = 0;
+    qint64 penReuses = 0;
+    qint64 pixmapCopies = 0;
+
+    // draw time of entities by type; time of an insert includes time of its entities
+    std::map<RS2::EntityType, EntityTypeStats> entityTypes;
+
+    void addEntityTime(RS2::EntityType type, qint64 time);
+    void merge(const LC_RenderStats& other);
+    QJsonObject toJson() const;
+};
+
+/**
+ * Collects counters of rendered frames of all views, if enabled at runtime. Renderers check
+ * whether profiling is enabled at the start of a frame and submit the counters of the frame
+ * at its end, so the profiler is thread safe. Disabled profiling costs renderers a few
+ * integer increments per entity.
+ * Implemented as singleton.
+ */
+class LC_RenderProfiler {
+public:
+    static LC_RenderProfiler* instance();
+
+    bool isEnabled() const {return m_enabled;}
+    void setEnabled(bool enabled);
+    void reset();
+    void addFrame(const LC_RenderStats& frame);
+
+    qint64 getFrameCount() const;
+    /**
+     * @return report of the collected counters, as plain text
+     */
+    QString toText() const;
+    QJsonObject toJson() const;
+    /**
+     * Writes the collected counters as JSON document.
+     * @return false, if the file can't be written
+     */
+    bool saveJson(const QString& fileName) const;
+
+protected:
+    LC_RenderProfiler() = default;
+
+private:
+    std::atomic<bool> m_enabled{false};
+    mutable std::mutex m_mutex;
+    qint64 m_frameCount = 0;
+    qint64 m_maxFrameTime = 0;
+    LC_RenderHistogram m_frameHistogram;
+    LC_RenderStats m_totals;
+    LC_RenderStats m_lastFrame;
+};
+
+#endif // LC_RENDERPROFILER_H
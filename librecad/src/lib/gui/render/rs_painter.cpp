@@ -22,6 +22,8 @@
 
 #include "rs_painter.h"
 
+#include <array>
+
 #include <QPainterPath>
 
 #include "dxf_format.h"
@@ -181,6 +183,91 @@ void RS_Painter::drawPointEntityWCS(const RS_Vector& wcsPos) {
     drawPointEntityUI(uiPos, pointsMode, screenPointsSize);
 }
 
+/**
+ * Draws point entities at the given coordinates, with the same symbol as drawPointEntityWCS().
+ * Points outside of the view are culled, and symbols of points are drawn by batches of lines,
+ * so large sets of points don't cost a painter call per point.
+ */
+void RS_Painter::drawPointEntitiesWCS(const std::vector<double> &wcsX, const std::vector<double> &wcsY) {
+    const int halfPDSize = screenPointsSize / 2;
+    // lines of the symbol, relative to the point
+    std::vector<QLineF> symbol;
+    switch (DXF_FORMAT_PDMode_getCentre(pointsMode)) {
+        case DXF_FORMAT_PDMode_CentreDot:
+        default:
+            symbol.emplace_back(-1., 0., 1., 0.);
+            symbol.emplace_back(0., -1., 0., 1.);
+            break;
+        case DXF_FORMAT_PDMode_CentreBlank:
+            break;
+        case DXF_FORMAT_PDMode_CentrePlus:
+            symbol.emplace_back(-screenPointsSize, 0., screenPointsSize, 0.);
+            symbol.emplace_back(0., -screenPointsSize, 0., screenPointsSize);
+            break;
+        case DXF_FORMAT_PDMode_CentreCross:
+            symbol.emplace_back(-screenPointsSize, -screenPointsSize, screenPointsSize, screenPointsSize);
+            symbol.emplace_back(-screenPointsSize, screenPointsSize, screenPointsSize, -screenPointsSize);
+            break;
+        case DXF_FORMAT_PDMode_CentreTick:
+            symbol.emplace_back(0., -halfPDSize, 0., 0.);
+            break;
+    }
+    if (DXF_FORMAT_PDMode_hasEncloseCircle(pointsMode)) {
+        // same octagon as drawOctagon()
+        const double side = std::sin(M_PI / 8.) * halfPDSize;
+        const std::array<QPointF, 8> vertices{{
+            {double(halfPDSize), side}, {side, double(halfPDSize)}, {-side, double(halfPDSize)}, {-double(halfPDSize), side},
+            {-double(halfPDSize), -side}, {-side, -double(halfPDSize)}, {side, -double(halfPDSize)}, {double(halfPDSize), -side}
+        }};
+        for (size_t i = 0; i < vertices.size(); i++) {
+            symbol.emplace_back(vertices[i], vertices[(i + 1) % vertices.size()]);
+        }
+    }
+    if (DXF_FORMAT_PDMode_hasEncloseSquare(pointsMode)) {
+        const double h = halfPDSize;
+        symbol.emplace_back(h, h, -h, h);
+        symbol.emplace_back(-h, h, -h, -h);
+        symbol.emplace_back(-h, -h, h, -h);
+        symbol.emplace_back(h, -h, h, h);
+    }
+    if (symbol.empty()) {
+        return;
+    }
+
+    // points whose symbol may overlap the view
+    const double uiFactor = std::max(std::abs(toGuiDX(1.)), RS_TOLERANCE);
+    const double wcsMargin = (screenPointsSize + 1) / uiFactor;
+    const double minX = wcsBoundingRect.minP().x - wcsMargin;
+    const double minY = wcsBoundingRect.minP().y - wcsMargin;
+    const double maxX = wcsBoundingRect.maxP().x + wcsMargin;
+    const double maxY = wcsBoundingRect.maxP().y + wcsMargin;
+
+    // lines are passed to the painter by chunks, to limit the memory used for large sets
+    constexpr size_t CHUNK_SIZE = 8192;
+    const QTransform transform = getWorldToGuiTransform();
+    const size_t count = std::min(wcsX.size(), wcsY.size());
+    QVector<QLineF> lines;
+    lines.reserve(int(std::min(count * symbol.size(), CHUNK_SIZE + symbol.size())));
+    for (size_t i = 0; i < count; i++) {
+        const double x = wcsX[i];
+        const double y = wcsY[i];
+        if (x < minX || x > maxX || y < minY || y > maxY) {
+            continue;
+        }
+        const QPointF uiPos = transform.map(QPointF(x, y));
+        for (const QLineF &line: symbol) {
+            lines.append(line.translated(uiPos));
+        }
+        if (size_t(lines.size()) >= CHUNK_SIZE) {
+            QPainter::drawLines(lines);
+            lines.clear();
+        }
+    }
+    if (!lines.isEmpty()) {
+        QPainter::drawLines(lines);
+    }
+}
+
 void RS_Painter::drawRefPointEntityWCS(const RS_Vector &wcsPos, int pdMode, double pdSize){
     // fixme - sand - may we cache size of refPoints? It's hardly possible that they will have different size during the same point run...
     int screenPDSize = determinePointScreenSize(pdSize);
@@ -284,6 +371,33 @@ void RS_Painter::drawLineUISimple(double x1, double y1, double x2, double y2){
     QPainter::drawLine(QPointF(x1, y1),QPointF(x2, y2));
 }
 
+/**
+ * Draws a polyline, skipping vertices closer than the minimal line length to the
+ * previous drawn vertex. A polyline shorter than the minimal line length is drawn
+ * as a point, as drawLineUI() does for lines.
+ */
+void RS_Painter::drawPolylineUI(const QPolygonF& uiPolyline){
+    if (uiPolyline.isEmpty()) {
+        return;
+    }
+    QPolygonF visible;
+    visible.reserve(uiPolyline.size());
+    visible.append(uiPolyline.first());
+    for (const QPointF& p: uiPolyline) {
+        if ((p - visible.last()).manhattanLength() > minLineDrawingLen) {
+            visible.append(p);
+        }
+    }
+    if (visible.size() > 1) {
+        // end at the last vertex, even if it's close to the previous one
+        visible.last() = uiPolyline.last();
+        QPainter::drawPolyline(visible);
+    }
+    else {
+        QPainter::drawPoint(uiPolyline.boundingRect().center());
+    }
+}
+
 void RS_Painter::drawLineUI(const QPointF& startPoint, const QPointF& endPoint)
 {
     if((startPoint - endPoint).manhattanLength() > minLineDrawingLen) {
@@ -1030,7 +1144,8 @@ void RS_Painter::drawImgUI(QImage& img, const RS_Vector& uiInsert,
     }
 
     wm->scale(factor.x, factor.y);
-    setWorldTransform(*wm);
+    // combined, as the painter may be translated (rendering of tiles)
+    setWorldTransform(*wm, true);
 
     drawImage(0,-img.height(), img);
 }
@@ -1440,11 +1555,60 @@ void RS_Painter::drawAsChild(RS_Entity* entity)
     renderer->renderEntityAsChild(this, entity);
 }
 
+/**
+ * Sets the pen for strokes of a part of an instanced insert, drawn by the insert itself.
+ * @return false if the part isn't drawn
+ */
+bool RS_Painter::prepareInstancePart(const RS_Insert* insert, const RS_Pen& pen, const RS_Layer* layer,
+                                     const RS_Vector& wcsMin, const RS_Vector& wcsMax)
+{
+    return renderer->prepareInstancePart(this, insert, pen, layer, wcsMin, wcsMax);
+}
+
 bool RS_Painter::isTextLineNotRenderable(double wcsLineHeight) const {
     double uiHeight = toGuiDY(wcsLineHeight);
     return renderer->isTextLineNotRenderable(uiHeight);
 }
 
+/**
+ * Copies viewport mapping, renderer, current pen and rendering settings of the source painter, so entities are
+ * rendered by this painter (say, to a QPicture) the same way as by the source one.
+ */
+void RS_Painter::copyRenderingSetup(RS_Painter& source) {
+    setRenderer(source.renderer);
+    setViewPort(source.viewport);
+    // ucs might be disabled for the source painter
+    apply(&source);
+    cachedDpmm = source.cachedDpmm;
+    drawingMode = source.drawingMode;
+    drawSelectedEntities = source.drawSelectedEntities;
+    penJoinStyle = source.penJoinStyle;
+    penCapStyle = source.penCapStyle;
+    minCircleDrawingRadius = source.minCircleDrawingRadius;
+    minArcDrawingRadius = source.minArcDrawingRadius;
+    minEllipseMajorRadius = source.minEllipseMajorRadius;
+    minEllipseMinorRadius = source.minEllipseMinorRadius;
+    minLineDrawingLen = source.minLineDrawingLen;
+    arcRenderInterpolate = source.arcRenderInterpolate;
+    arcRenderInterpolationAngleFixed = source.arcRenderInterpolationAngleFixed;
+    arcRenderInterpolationAngleValue = source.arcRenderInterpolationAngleValue;
+    arcRenderInterpolationMaxSagitta = source.arcRenderInterpolationMaxSagitta;
+    circleRenderSameAsArcs = source.circleRenderSameAsArcs;
+    minRenderableTextHeightInPx = source.minRenderableTextHeightInPx;
+    defaultWidthFactor = source.defaultWidthFactor;
+    screenPointsSize = source.screenPointsSize;
+    pointsMode = source.pointsMode;
+    wcsBoundingRect = source.wcsBoundingRect;
+    printinMode = source.printinMode;
+    printPreview = source.printPreview;
+
+    setRenderHints(source.renderHints());
+    lpen = source.lpen;
+    lastUsedPen = source.lastUsedPen;
+    QPainter::setPen(source.QPainter::pen());
+    setBrush(source.brush());
+}
+
 void RS_Painter::setViewPort(LC_GraphicViewport *v) {
     viewport = v;
     apply(viewport);
@@ -1544,6 +1708,13 @@ double RS_Painter::toGuiDY(double ucsDY) const {
     return ucsDY * m_viewPortFactor.y;
 }
 
+QTransform RS_Painter::getWorldToGuiTransform() const {
+    const RS_Vector uiOrigin = toGui(RS_Vector{0., 0.});
+    const RS_Vector uiAxisX = toGui(RS_Vector{1., 0.}) - uiOrigin;
+    const RS_Vector uiAxisY = toGui(RS_Vector{0., 1.}) - uiOrigin;
+    return {uiAxisX.x, uiAxisX.y, uiAxisY.x, uiAxisY.y, uiOrigin.x, uiOrigin.y};
+}
+
 void RS_Painter::disableUCS(){
     useUCS(false);
 }
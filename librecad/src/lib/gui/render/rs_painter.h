@@ -40,6 +40,8 @@ class RS_Color;
 class RS_Ellipse;
 class RS_Entity;
 class RS_EntityContainer;
+class RS_Insert;
+class RS_Layer;
 class RS_Pen;
 class RS_Polyline;
 class RS_Spline;
@@ -85,6 +87,8 @@ public:
     void toGui(const RS_Vector& pos, double &x, double &y) const;
     double toGuiDX(double d) const;
     double toGuiDY(double d) const;
+    // affine mapping of world coordinates to UI coordinates, as performed by toGui()
+    QTransform getWorldToGuiTransform() const;
 
     bool isPrinting() const
     {
@@ -101,6 +105,7 @@ public:
     }
     void setViewPort(LC_GraphicViewport* v);
     void setRenderer(LC_GraphicViewportRenderer *r) {renderer = r;}
+    void copyRenderingSetup(RS_Painter& source);
     void updateDashOffset(RS_Entity* e);
     void clearDashOffset() {currenPatternOffset = 0.0;}
     double currentDashOffset() const {return currenPatternOffset;}
@@ -121,6 +126,7 @@ public:
     void drawSplinePointsWCS(const std::vector<RS_Vector> &wcsControlPoints, bool closed);
     void drawCircleWCS(const RS_Vector &wcsCenter, double wcsRadius);
     void drawPointEntityWCS(const RS_Vector &p);
+    void drawPointEntitiesWCS(const std::vector<double> &wcsX, const std::vector<double> &wcsY);
     void drawRefPointEntityWCS(const RS_Vector &wcsPos, int pdMode, double pdSize);
     void drawSolidWCS(const RS_Vector &wcsP1, const RS_Vector &wcsP2, const RS_Vector &wcsP3, const RS_Vector &wcsP4);
     void drawSolidWCS(const RS_VectorSolutions& wcsVertices);
@@ -139,6 +145,7 @@ public:
     void drawCircleUI(double uiCenterX, double uiCenterY, double uiRadius);
     void drawLineUISimple(double x1, double y1, double x2, double y2);
     void drawLineUISimple(const RS_Vector &p1, const RS_Vector &p2);
+    void drawPolylineUI(const QPolygonF& uiPolyline);
     void drawText(const QRect &uiRect, int flags, const QString &text, QRect *uiBoundingBox);
     void drawText(const QRect &rect, const QString &text, QRect *boundingBox);
     void drawRectUI(double uiX1, double uiY1, double uiX2, double uiY2);
@@ -147,6 +154,8 @@ public:
     // methods invoked from entity containers and printing
     void drawEntity(RS_Entity* entity);
     void drawAsChild(RS_Entity* entity);
+    bool prepareInstancePart(const RS_Insert* insert, const RS_Pen& pen, const RS_Layer* layer,
+                             const RS_Vector& wcsMin, const RS_Vector& wcsMax);
     void drawInfiniteWCS(RS_Vector start, RS_Vector end);
 
     /**
@@ -20,7 +20,10 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  ******************************************************************************/
 
+#include <algorithm>
+
 #include <QApplication>
+#include <QImage>
 #include <QScreen>
 #include "lc_graphicviewrenderer.h"
 #include "rs_painter.h"
@@ -30,8 +33,12 @@
 #include "rs_settings.h"
 #include "lc_overlayentitiescontainer.h"
 #include "lc_linemath.h"
+#include "rs_document.h"
 #include "rs_entity.h"
 #include "rs_entitycontainer.h"
+#include "rs_graphic.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
 
 LC_GraphicViewRenderer::LC_GraphicViewRenderer(LC_GraphicViewport *viewport, QPaintDevice* p)
    :LC_WidgetViewPortRenderer(viewport, p) {
@@ -66,6 +73,14 @@ void LC_GraphicViewRenderer::loadSettings() {
     {
         m_drawTextsAsDraftForPreview = LC_GET_BOOL("DrawTextsAsDraftInPreview", true);
         m_drawTextsAsDraftForPanning = LC_GET_BOOL("DrawTextsAsDraftInPanning", true);
+        m_lodCoverage = LC_GET_BOOL("LodCoverage", false);
+        bool blockInstancing = LC_GET_BOOL("BlockInstancing", true);
+        RS_Insert::setInstancingEnabled(blockInstancing);
+        // inserts of the drawing were updated with the previous setting
+        if (blockInstancing != m_blockInstancing && graphic != nullptr) {
+            graphic->updateInserts();
+        }
+        m_blockInstancing = blockInstancing;
     }
     LC_GROUP_END();
 
@@ -90,43 +105,38 @@ void LC_GraphicViewRenderer::loadSettings() {
 
 
 void LC_GraphicViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
-    // check for selected entity drawing
-    if (/*!e->isContainer() && */(e->getFlag(RS2::FlagSelected) != painter->shouldDrawSelected())) {
+    // the drawing pass draws all entities, the selection pass only the selected ones
+    if (painter->shouldDrawSelected() && !e->getFlag(RS2::FlagSelected)) {
         return;
     }
-#ifdef DEBUG_RENDERING
-    isVisibleTimer.start();
-#endif
+    m_renderStats.entitiesVisited++;
     // entity is not visible:
     bool visible = e->isVisible();
-#ifdef DEBUG_RENDERING
-    isVisibleTime += isVisibleTimer.nsecsElapsed();
-#endif
     if (!visible) {
+        m_renderStats.entitiesCulled++;
         return;
     }
 
-#ifdef DEBUG_RENDERING
-    isConstructionTimer.start();
-#endif
     bool constructionEntity = e->isConstruction();
-#ifdef DEBUG_RENDERING
-    isConstructionTime += isConstructionTimer.nsecsElapsed();
-#endif
 
     if (isOutsideOfBoundingClipRect(e, constructionEntity)) {
+        m_renderStats.entitiesCulled++;
         return;
     }
 
     RS2::EntityType entityType = e->rtti();
-    if (isDraftMode()) {
+    if (m_lodCoverage && addToLodCoverage(painter, e, entityType)) {
+        // aggregated into the coverage image instead of drawing
+        m_renderStats.entitiesAggregated++;
+    }
+    else if (isDraftMode()) {
         switch (entityType) {
             case RS2::EntityMText:
             case RS2::EntityText:
             case RS2::EntityImage:
                 // set pen (color):
                 setPenForDraftEntity(painter, e, false);
-                e->drawDraft(painter);
+                justDrawEntityDraft(painter, e);
                 break;
             case RS2::EntityHatch:
                 //skip hatches
@@ -146,7 +156,7 @@ void LC_GraphicViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
                 {
                     if (m_drawTextsAsDraftForPanning) {
                         setPenForDraftEntity(painter, e, false);
-                        e->drawDraft(painter);
+                        justDrawEntityDraft(painter, e);
                     } else {
                         // normal painting
                         if (m_scaleLineWidth) {
@@ -185,7 +195,7 @@ void LC_GraphicViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
     }
 
     // draw reference points:
-    if (e->getFlag(RS2::FlagSelected)) {
+    if (painter->shouldDrawSelected()) {
         if (!e->isParentSelected()) {
             drawEntityReferencePoints(painter, e);
         }
@@ -193,6 +203,23 @@ void LC_GraphicViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
 //RS_DEBUG->print("RS_GraphicView::drawEntity() end");
 }
 
+bool LC_GraphicViewRenderer::prepareInstancePart(RS_Painter *painter, const RS_Insert *insert, const RS_Pen &pen,
+                                                 const RS_Layer *layer, const RS_Vector &wcsMin, const RS_Vector &wcsMax) {
+    if (layer != nullptr && layer->isFrozen()) {
+        return false;
+    }
+    if (isOutsideOfBoundingClipRect(wcsMin, wcsMax)) {
+        return false;
+    }
+    // parts are drawn as entities other than texts by renderEntity()
+    if (isDraftMode() || !getLineWidthScaling()) {
+        setPenForDraftEntity(painter, pen, insert, false);
+    } else {
+        setPenForEntity(painter, pen, insert, false);
+    }
+    return true;
+}
+
 void LC_GraphicViewRenderer::doDrawLayerBackground(RS_Painter *painter) {
     const RS_Pen penSaved = painter->getPen();
 
@@ -240,10 +267,49 @@ void LC_GraphicViewRenderer::doDrawLayerOverlays(RS_Painter *painter) {
     if (graphic != nullptr){ // fixme - sand - again, support for hatch dialog :(
         drawRelativeZero(painter);
     }
+    drawSelection(painter);
     lastPaintEntityPen = RS_Pen();
     drawOverlay(painter);
 }
 
+/**
+ * Draws selected entities over the drawing layer, in the container order. For documents,
+ * only entities from their selection set are visited, so the pass is proportional to the
+ * size of the selection.
+ */
+void LC_GraphicViewRenderer::drawSelection(RS_Painter *painter) {
+    RS_EntityContainer *container = viewport->getContainer();
+    if (container == nullptr) {
+        return;
+    }
+    painter->setDrawSelectedOnly(true);
+    doSetupBeforeContainerDraw();
+    if (container->isDocument()) {
+        for (RS_Entity *e: static_cast<RS_Document *>(container)->getSelectedEntities()) {
+            drawSelectedEntity(painter, e);
+        }
+    } else {
+        for (RS_Entity *e: *container) {
+            drawSelectedEntity(painter, e);
+        }
+    }
+    doFinishAfterContainerDraw(painter);
+    painter->setDrawSelectedOnly(false);
+}
+
+/**
+ * Draws the entity if it's selected, otherwise its selected nested entities.
+ */
+void LC_GraphicViewRenderer::drawSelectedEntity(RS_Painter *painter, RS_Entity *e) {
+    if (e->getFlag(RS2::FlagSelected)) {
+        painter->drawEntity(e);
+    } else if (e->isContainer() && e->isVisible()) {
+        for (RS_Entity *child: *static_cast<RS_EntityContainer *>(e)) {
+            drawSelectedEntity(painter, child);
+        }
+    }
+}
+
 void LC_GraphicViewRenderer::drawRelativeZero(RS_Painter *painter) {
     const RS_Vector relativeZero = viewport->getRelativeZero();
     if (!relativeZero.valid || m_relZeroOptions.hideRelativeZero) {
@@ -378,24 +444,27 @@ void LC_GraphicViewRenderer::setPenForOverlayEntity(RS_Painter *painter, RS_Enti
 }
 
 void LC_GraphicViewRenderer::setPenForEntity(RS_Painter *painter, RS_Entity *e, bool inOverlay) {
-#ifdef DEBUG_RENDERING
-    getPenTimer.start();
-#endif
     // Getting pen from entity (or layer)
-    RS_Pen pen = e->getPenResolved();
-#ifdef DEBUG_RENDERING
-    getPenTime += getPenTimer.nsecsElapsed();
-#endif
+    setPenForEntity(painter, e->getPenResolved(), e, inOverlay);
+}
+
+/**
+ * Sets the given resolved pen, adjusted for highlighting and selection of the entity. The pen
+ * may be the one of a part drawn by the entity, see prepareInstancePart().
+ */
+void LC_GraphicViewRenderer::setPenForEntity(RS_Painter *painter, RS_Pen pen, const RS_Entity *e, bool inOverlay) {
     RS_Pen originalPen = pen;
     bool highlighted = e->getFlag(RS2::FlagHighlighted);
-    bool selected = e->getFlag(RS2::FlagSelected);
     bool overlayPaint = inOverlay || m_inOverlayDrawing;
+    // selected entities look unselected in the drawing layer, as they are drawn again over it
+    bool selected = e->getFlag(RS2::FlagSelected) && (overlayPaint || painter->shouldDrawSelected());
     // try to avoid pen setup if the pen and entity flags are the same as for previous entity. This is important for performance reasons, so we'll reuse
     // painter pen set previously. This check assumed that that all previous entity drawing were performed via this function and no
     // arbitrary QPainter::setPen was called between drawing entities.
     double patternOffset = painter->currentDashOffset();
     if (m_lastPaintedHighlighted == highlighted && m_lastPaintedSelected == selected && m_lastPaintOverlay == overlayPaint) {
         if (lastPaintEntityPen.isSameAs(pen, patternOffset)) {
+            m_renderStats.penReuses++;
             return;
         }
     }
@@ -405,9 +474,6 @@ void LC_GraphicViewRenderer::setPenForEntity(RS_Painter *painter, RS_Entity *e,
         m_lastPaintOverlay = overlayPaint;
     }
 
-#ifdef DEBUG_RENDERING
-    setPenTimer.start();
-#endif
     // Avoid negative widths
 //    int w = std::max(static_cast<int>(pen.getWidth()), 0);
     double width = pen.getWidth();
@@ -479,33 +545,28 @@ void LC_GraphicViewRenderer::setPenForEntity(RS_Painter *painter, RS_Entity *e,
     // deleting not drawing:
 
 // LC_ERR << "PEN " << pen.getColor().name() << "Width: " << pen.getWidth() <<  " | " << pen.getScreenWidth() << " LT " << pen.getLineType();
-#ifdef DEBUG_RENDERING
-    setPenTime += setPenTimer.nsecsElapsed();
-    painterSetPenTimer.start();
-#endif
     lastPaintEntityPen.updateBy(originalPen);
     painter->setPen(pen);
-#ifdef DEBUG_RENDERING
-    painterSetPenTime +=painterSetPenTimer.nsecsElapsed();
-
-#endif
+    m_renderStats.penSwitches++;
 }
 
 void LC_GraphicViewRenderer::setPenForDraftEntity(RS_Painter *painter, RS_Entity *e, bool inOverlay) {
-#ifdef DEBUG_RENDERING
-    setPenTimer.start();
-#endif
-    RS_Pen pen = e->getPenResolved();
+    setPenForDraftEntity(painter, e->getPenResolved(), e, inOverlay);
+}
+
+void LC_GraphicViewRenderer::setPenForDraftEntity(RS_Painter *painter, RS_Pen pen, const RS_Entity *e, bool inOverlay) {
     RS_Pen originalPen = pen;
     bool highlighted = e->getFlag(RS2::FlagHighlighted);
-    bool selected = e->getFlag(RS2::FlagSelected);
     bool overlayPaint = inOverlay || m_inOverlayDrawing;
+    // selected entities look unselected in the drawing layer, as they are drawn again over it
+    bool selected = e->getFlag(RS2::FlagSelected) && (overlayPaint || painter->shouldDrawSelected());
 // try to avoid pen setup if the pen and entity flags are the same as for previous entity. This is important for performance reasons, so we'll reuse
     // painter pen set previously. This check assumed that that all previous entity drawing were performed via this function and no
     // arbitrary QPainter::setPen was called between drawing entities.
     double patternOffset = painter->currentDashOffset();
     if (m_lastPaintedHighlighted == highlighted && m_lastPaintedSelected == selected && m_lastPaintOverlay == overlayPaint) {
         if (lastPaintEntityPen.isSameAs(pen, patternOffset)) {
+            m_renderStats.penReuses++;
             return;
         }
     }
@@ -554,9 +615,7 @@ void LC_GraphicViewRenderer::setPenForDraftEntity(RS_Painter *painter, RS_Entity
 // LC_ERR << "PEN " << pen.getColor().name() << "Width: " << pen.getWidth() <<  " | " << pen.getScreenWidth() << " LT " << pen.getLineType();
     lastPaintEntityPen.updateBy(originalPen);
     painter->setPen(pen);
-#ifdef DEBUG_RENDERING
-    setPenTime += setPenTimer.nsecsElapsed();
-#endif
+    m_renderStats.penSwitches++;
 }
 
 /**
@@ -611,4 +670,82 @@ void LC_GraphicViewRenderer::doSetupBeforeContainerDraw() {
     m_lastPaintedHighlighted = false;
     m_lastPaintedSelected = false;
     m_lastPaintOverlay = false;
+    const RS_Vector factor = viewport->getFactor();
+    m_lodFactor = std::max(factor.x, factor.y);
+}
+
+/**
+ * Draws the coverage image of entities smaller than a pixel, collected by the container draw.
+ */
+void LC_GraphicViewRenderer::doFinishAfterContainerDraw(RS_Painter *painter) {
+    if (!m_lodCoverageUsed) {
+        return;
+    }
+    // the image is in coordinates of the paint device
+    painter->save();
+    painter->resetTransform();
+    painter->drawImage(0, 0, m_lodCoverageImage);
+    painter->restore();
+    m_lodCoverageImage.fill(Qt::transparent);
+    m_lodCoverageUsed = false;
+}
+
+/**
+ * Level of detail: an entity with the bounding box smaller than a pixel is not drawn, but sets the pixel
+ * of its center in the coverage image to the color of its pen. So dense clusters of tiny entities (or
+ * inserts of blocks) are drawn by a single image, without dispatch of their drawing.
+ *
+ * @return true if the entity is added to the coverage image
+ */
+bool LC_GraphicViewRenderer::addToLodCoverage(RS_Painter *painter, RS_Entity *e, RS2::EntityType entityType) {
+    // points are drawn with the size on screen, hatches are skipped in draft mode
+    if (entityType == RS2::EntityPoint || (entityType == RS2::EntityHatch && isDraftMode())) {
+        return false;
+    }
+    const RS_Vector minV = e->getMin();
+    const RS_Vector maxV = e->getMax();
+    if (minV.distanceTo(maxV) * m_lodFactor >= 1.0) {
+        return false;
+    }
+
+    // the color and width are resolved as by setPenForEntity(), but without setup of the painter pen,
+    // which costs more than setting the pixel
+    const RS_Pen pen = e->getPenResolved();
+    const bool selected = e->getFlag(RS2::FlagSelected) && painter->shouldDrawSelected();
+    // wide pens cover more than a pixel
+    if (!isDraftMode() && getLineWidthScaling() && !selected) {
+        double screenWidth = pen.getScreenWidth();
+        if (pen.getAlpha() == 1.0) {
+            screenWidth = pen.getWidth() > 0 ? painter->toGuiDX(pen.getWidth() * unitFactor100) : 0.0;
+        }
+        if (screenWidth > 1.0) {
+            return false;
+        }
+    }
+    QRgb color = pen.getColor().rgba();
+    if (selected) {
+        color = m_colorSelectedEntity.rgba();
+    } else if (e->getFlag(RS2::FlagHighlighted)) {
+        color = m_colorHighlightedEntity.rgba();
+    } else if (e->getFlag(RS2::FlagTransparent)) {
+        color = m_colorBackground.rgba();
+    } else if (pen.getColor().isEqualIgnoringFlags(m_colorBackground)
+               || (pen.getColor().toIntColor() == RS_Color::Black
+                   && pen.getColor().colorDistance(m_colorBackground) < RS_Color::MinColorDistance)) {
+        color = m_colorForeground.rgba();
+    }
+
+    const QSize deviceSize(painter->device()->width(), painter->device()->height());
+    if (m_lodCoverageImage.size() != deviceSize) {
+        m_lodCoverageImage = QImage(deviceSize, QImage::Format_ARGB32_Premultiplied);
+        m_lodCoverageImage.fill(Qt::transparent);
+    }
+    const QPointF devicePos = painter->transform().map(painter->toGuiPointF((minV + maxV) * 0.5));
+    const int x = static_cast<int>(devicePos.x());
+    const int y = static_cast<int>(devicePos.y());
+    if (x >= 0 && y >= 0 && x < deviceSize.width() && y < deviceSize.height()) {
+        reinterpret_cast<QRgb *>(m_lodCoverageImage.scanLine(y))[x] = qPremultiply(color);
+        m_lodCoverageUsed = true;
+    }
+    return true;
 }
@@ -22,6 +22,9 @@
 
 #ifndef LC_GRAPHICVIEWRENDERER_H
 #define LC_GRAPHICVIEWRENDERER_H
+
+#include <QImage>
+
 #include "lc_overlayanglesbasemark.h"
 #include "lc_overlayrelativezero.h"
 #include "lc_overlayucszero.h"
@@ -65,6 +68,16 @@ protected:
 
     bool m_ignoreDraftForHighlight = false;
 
+    // level of detail: entities smaller than a pixel are aggregated into the coverage image,
+    // drawn over the entities, so off by default
+    bool m_lodCoverage = false;
+    bool m_lodCoverageUsed = false;
+    double m_lodFactor = 1.0;
+    QImage m_lodCoverageImage;
+
+    // inserts are drawn as instances of shared block geometry, unless disabled
+    bool m_blockInstancing = true;
+
     /** grid color */
     RS_Color m_gridColor = Qt::gray;
     /** meta grid color */
@@ -102,19 +115,35 @@ protected:
 
     void doDrawLayerBackground(RS_Painter *painter) override;
     void doDrawLayerOverlays(RS_Painter *painter) override;
+    bool hasScreenFixedBackground() const override {return m_draftMode && m_drawDrawSign;}
+    /**
+     * Renderers of tiles draw entities only, so overlays of the copy keep options of this renderer.
+     */
+    LC_GraphicViewRenderer(const LC_GraphicViewRenderer& other) = default;
+    std::unique_ptr<LC_WidgetViewPortRenderer> createTileRenderer() const override {
+        return std::unique_ptr<LC_WidgetViewPortRenderer>(new LC_GraphicViewRenderer(*this));
+    }
     void drawLayerEntitiesOver(RS_Painter *painter) override;
     void drawRelativeZero(RS_Painter *painter);
     void drawOverlay(RS_Painter *painter);
+    void drawSelection(RS_Painter *painter);
+    void drawSelectedEntity(RS_Painter *painter, RS_Entity *e);
     void drawDraftSign(RS_Painter *painter);
     void drawCoordinateSystems(RS_Painter *painter);
     void drawEntitiesInOverlay(LC_OverlaysManager *overlaysManager, RS_Painter *painter, RS2::OverlayGraphics overlayType);
     void drawOverlayEntitiesInOverlay(LC_OverlaysManager *overlaysManager, RS_Painter *painter, RS2::OverlayGraphics overlayType);
     void drawEntityReferencePoints(RS_Painter *painter, const RS_Entity *e) const;
     void setPenForEntity(RS_Painter *painter, RS_Entity *e, bool inOverlay);
+    void setPenForEntity(RS_Painter *painter, RS_Pen pen, const RS_Entity *e, bool inOverlay);
     void setPenForDraftEntity(RS_Painter *painter, RS_Entity *e, bool inOverlay);
+    void setPenForDraftEntity(RS_Painter *painter, RS_Pen pen, const RS_Entity *e, bool inOverlay);
     void setPenForOverlayEntity(RS_Painter *painter, RS_Entity *e);
     void renderEntity(RS_Painter *painter, RS_Entity *e) override;
+    bool prepareInstancePart(RS_Painter *painter, const RS_Insert *insert, const RS_Pen &pen,
+                             const RS_Layer *layer, const RS_Vector &wcsMin, const RS_Vector &wcsMax) override;
     void doSetupBeforeContainerDraw() override;
+    void doFinishAfterContainerDraw(RS_Painter *painter) override;
+    bool addToLodCoverage(RS_Painter *painter, RS_Entity *e, RS2::EntityType entityType);
 };
 
 #endif // LC_GRAPHICVIEWRENDERER_H
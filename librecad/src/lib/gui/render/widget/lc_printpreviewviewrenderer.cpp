@@ -24,6 +24,8 @@
 
 #include "lc_graphicviewport.h"
 #include "rs_graphic.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
 #include "rs_math.h"
 #include "rs_painter.h"
 
@@ -158,35 +160,24 @@ void LC_PrintPreviewViewRenderer::drawPaper(RS_Painter *painter) {
 }
 
 void LC_PrintPreviewViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
-    // fixme - sand - ucs - is it really necessary for print preview??????
-    // check for selected entity drawing
-    if (/*!e->isContainer() && */(e->getFlag(RS2::FlagSelected) != painter->shouldDrawSelected())) {
-        return;
-    }
-#ifdef DEBUG_RENDERING
-    isVisibleTimer.start();
-#endif
+    // selection is not shown by print preview, all entities are drawn by a single pass
+    m_renderStats.entitiesVisited++;
     // entity is not visible:
     bool visible = e->isVisible();
-#ifdef DEBUG_RENDERING
-    isVisibleTime += isVisibleTimer.nsecsElapsed();
-#endif
     if (!visible) {
+        m_renderStats.entitiesCulled++;
         return;
     }
 
-#ifdef DEBUG_RENDERING
-    isConstructionTimer.start();
-#endif
     bool constructionEntity = e->isConstruction();
-#ifdef DEBUG_RENDERING
-    isConstructionTime += isConstructionTimer.nsecsElapsed();
-#endif
 
-    if (!e->isPrint() || constructionEntity)
+    if (!e->isPrint() || constructionEntity) {
+        m_renderStats.entitiesCulled++;
         return;
+    }
 
     if (isOutsideOfBoundingClipRect(e, constructionEntity)) {
+        m_renderStats.entitiesCulled++;
         return;
     }
 
@@ -195,16 +186,30 @@ void LC_PrintPreviewViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e
     justDrawEntity(painter, e);
 }
 
+bool LC_PrintPreviewViewRenderer::prepareInstancePart(RS_Painter *painter, const RS_Insert *insert, const RS_Pen &pen,
+                                                      const RS_Layer *layer, const RS_Vector &wcsMin, const RS_Vector &wcsMax) {
+    // as by renderEntity(), construction layers aren't printed
+    if (layer != nullptr && (layer->isFrozen() || !layer->isPrint() || layer->isConstruction())) {
+        return false;
+    }
+    if (isOutsideOfBoundingClipRect(wcsMin, wcsMax)) {
+        return false;
+    }
+    setPenForPrintingEntity(painter, pen, insert);
+    return true;
+}
+
 void LC_PrintPreviewViewRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_Entity *e) {
-#ifdef DEBUG_RENDERING
-    setPenTimer.start();
-#endif
     // Getting pen from entity (or layer)
-    RS_Pen pen = e->getPenResolved();
+    setPenForPrintingEntity(painter, e->getPenResolved(), e);
+}
+
+void LC_PrintPreviewViewRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_Pen pen, const RS_Entity *e) {
     RS_Pen originalPen = pen;
 
     double patternOffset = painter->currentDashOffset();
     if (lastPaintEntityPen.isSameAs(pen, patternOffset)) {
+        m_renderStats.penReuses++;
         return;
     }
     // Avoid negative widths
@@ -269,9 +274,7 @@ void LC_PrintPreviewViewRenderer::setPenForPrintingEntity(RS_Painter *painter, R
     // we store original pen as last painted, not resolved one - since original pen lead to resulting resolved and may be used by the next entity
     lastPaintEntityPen.updateBy(originalPen);
     painter->setPen(pen);
-#ifdef DEBUG_RENDERING
-    setPenTime += setPenTimer.nsecsElapsed();
-#endif
+    m_renderStats.penSwitches++;
 }
 
 void LC_PrintPreviewViewRenderer::setupPainter(RS_Painter *painter)  {
@@ -31,6 +31,8 @@ class LC_PrintPreviewViewRenderer:public LC_WidgetViewPortRenderer{
 public:
     LC_PrintPreviewViewRenderer(LC_GraphicViewport *viewport, QPaintDevice* paintDevice);
     void renderEntity(RS_Painter *painter, RS_Entity *e) override;
+    bool prepareInstancePart(RS_Painter *painter, const RS_Insert *insert, const RS_Pen &pen,
+                             const RS_Layer *layer, const RS_Vector &wcsMin, const RS_Vector &wcsMax) override;
 
     RS2::DrawingMode getDrawingMode() const {
         return m_drawingMode;
@@ -41,6 +43,7 @@ public:
 protected:
     void drawPaper(RS_Painter *painter);
     void setPenForPrintingEntity(RS_Painter *painter, RS_Entity *e);
+    void setPenForPrintingEntity(RS_Painter *painter, RS_Pen pen, const RS_Entity *e);
     void doDrawLayerBackground(RS_Painter *painter) override;
     void setupPainter(RS_Painter *painter) override;
     void doRender() override;
@@ -21,10 +21,19 @@
  ******************************************************************************/
 #include "lc_widgetviewportrenderer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include <QImage>
 #include <QPixmap>
+#include <QRegion>
 
 #include "lc_graphicviewport.h"
+#include "lc_parallel.h"
+#include "rs_document.h"
 #include "rs_entitycontainer.h"
+#include "rs_insert.h"
 #include "rs_math.h"
 #include "rs_painter.h"
 #include "rs_settings.h"
@@ -38,6 +47,31 @@ LC_WidgetViewPortRenderer::LC_WidgetViewPortRenderer(LC_GraphicViewport *viewpor
 {
 }
 
+/**
+ * Copies settings of the renderer, for renderers of tiles. Pixmaps of layers are not copied.
+ */
+LC_WidgetViewPortRenderer::LC_WidgetViewPortRenderer(const LC_WidgetViewPortRenderer& other):
+    LC_GraphicViewportRenderer(other)
+    , antialiasing{other.antialiasing}
+    , classicRenderer{other.classicRenderer}
+    , pixmapLayerBackground{ std::make_unique<QPixmap>() }
+    , pixmapLayerDrawing{ std::make_unique<QPixmap>() }
+    , pixmapLayerOverlays{ std::make_unique<QPixmap>() }
+    , m_render_minRenderableTextHeightInPx{other.m_render_minRenderableTextHeightInPx}
+    , m_render_minCircleDrawingRadius{other.m_render_minCircleDrawingRadius}
+    , m_render_minArcDrawingRadius{other.m_render_minArcDrawingRadius}
+    , m_render_minEllipseMajorRadius{other.m_render_minEllipseMajorRadius}
+    , m_render_minEllipseMinorRadius{other.m_render_minEllipseMinorRadius}
+    , m_render_minLineDrawingLen{other.m_render_minLineDrawingLen}
+    , m_render_arcsInterpolate{other.m_render_arcsInterpolate}
+    , m_render_arcsInterpolateAngleFixed{other.m_render_arcsInterpolateAngleFixed}
+    , m_render_arcsInterpolateAngleValue{other.m_render_arcsInterpolateAngleValue}
+    , m_render_arcsInterpolateMaxSagitta{other.m_render_arcsInterpolateMaxSagitta}
+    , m_render_circlesSameAsArcs{other.m_render_circlesSameAsArcs}
+    , m_pixmapLayer1{ std::make_unique<QPixmap>(1,1) }
+{
+}
+
 LC_WidgetViewPortRenderer::~LC_WidgetViewPortRenderer() = default;
 
 
@@ -78,28 +112,22 @@ void LC_WidgetViewPortRenderer::loadSettings() {
         m_render_arcsInterpolateMaxSagitta = sagittaMax / 100.0;
 
         m_render_circlesSameAsArcs = LC_GET_BOOL("CircleRenderAsArcs", false);
+        m_spatialIndexCulling = LC_GET_BOOL("SpatialIndexCulling", true);
+        m_incrementalPanning = LC_GET_BOOL("IncrementalPanning", true);
+        m_tiledRendering = LC_GET_BOOL("TiledRendering", false);
+        m_tiledRenderingThreads = LC_GET_INT("TiledRenderingThreads", 0);
+        m_progressiveRendering = LC_GET_BOOL("ProgressiveRendering", false);
+        m_progressiveFrameBudget = LC_GET_INT("ProgressiveFrameBudget", 40);
     } // Render group
     LC_GROUP_END();
 }
 
 void LC_WidgetViewPortRenderer::doRender() {
-
-#ifdef DEBUG_RENDERING
-    QElapsedTimer timer;
-    timer.start();
-    drawEntityCount = 0;
-    entityDrawTime = 0;
-    isVisibleTime = 0;
-    isConstructionTime  = 0;
-    setPenTime = 0;
-    painterSetPenTime = 0;
-    getPenTime = 0;
-
-
-    drawLayerBackgroundTime = 0;
-    drawLayerEntitiesTime = 0;
-    drawLayerOverlaysTime = 0;
-#endif
+    m_frameTimer.start();
+    // entities collected for progressive rendering may be deleted since the previous frame
+    if (isRenderingInProgress() && isProgressiveDrawingOutdated()) {
+        invalidate(RS2::RedrawDrawing);
+    }
     if (antialiasing){
         if (classicRenderer) {
             paintClassicalBuffered(pd);
@@ -112,13 +140,6 @@ void LC_WidgetViewPortRenderer::doRender() {
         paintClassicalBuffered(pd);
     }
 
-#ifdef DEBUG_RENDERING
-    LC_ERR<<"Paint:"  << timer.elapsed() <<
-    " Layer 1 - Background: "  << drawLayerBackgroundTime <<" Layer 2 - Entities:"  << drawLayerEntitiesTime  <<" Layer 3 - overlays: "  << drawLayerOverlaysTime
-    << " Entity Draw: " << entityDrawTime*1e-6 <<  " isVisible: " << isVisibleTime*1e-6 <<  " isConstruction: " << isConstructionTime*1e-6
-    << " setPen: " << setPenTime*1e-6 <<  " getPen: " << getPenTime*1e-6 << " painter setPen: " << painterSetPenTime*1e-6 << " Entities: " << drawEntityCount;
-#endif
-
     redrawMethod=RS2::RedrawNone;
 }
 
@@ -132,29 +153,45 @@ void LC_WidgetViewPortRenderer::paintSequental(QPaintDevice* pd) {
         redrawMethod=(RS2::RedrawMethod ) (redrawMethod | RS2::RedrawGrid);
     }
 
+    QPoint scroll = prepareDrawingScroll(true);
+
     if (redrawMethod & RS2::RedrawGrid) {
         pixmapLayerBackground->fill(m_colorBackground);
         RS_Painter painterBackground(pixmapLayerBackground.get());
         setupPainter(&painterBackground);
         drawLayerBackground(&painterBackground);
         painterBackground.end();
-        redrawMethod=(RS2::RedrawMethod ) (redrawMethod | RS2::RedrawDrawing);
+        // the scrolled drawing layer takes the background of exposed parts
+        if (scroll.isNull()) {
+            redrawMethod = (RS2::RedrawMethod) (redrawMethod | RS2::RedrawDrawing);
+        }
     }
 
-    if (redrawMethod & RS2::RedrawDrawing) {
+    if (!(redrawMethod & RS2::RedrawDrawing) && !scroll.isNull()) {
+        scrollDrawingLayer(pixmapLayerDrawing.get(), scroll, pixmapLayerBackground.get());
+    }
+    else if (redrawMethod & RS2::RedrawDrawing) {
         // DRaw layer 2
         *pixmapLayerDrawing = *pixmapLayerBackground;
+        m_renderStats.pixmapCopies++;
         RS_Painter painterLayerDrawing(pixmapLayerDrawing.get());
         setupPainter(&painterLayerDrawing);
 
-        drawLayerEntities(&painterLayerDrawing);
-        drawLayerEntitiesOver(&painterLayerDrawing);
+        drawLayerDrawing(&painterLayerDrawing, true);
+        painterLayerDrawing.end();
+        redrawMethod=(RS2::RedrawMethod ) (redrawMethod | RS2::RedrawOverlay);
+    }
+    else if (isRenderingInProgress()) {
+        RS_Painter painterLayerDrawing(pixmapLayerDrawing.get());
+        setupPainter(&painterLayerDrawing);
+        drawLayerDrawing(&painterLayerDrawing, false);
         painterLayerDrawing.end();
         redrawMethod=(RS2::RedrawMethod ) (redrawMethod | RS2::RedrawOverlay);
     }
 
     if (redrawMethod & RS2::RedrawOverlay) {
         *pixmapLayerOverlays = *pixmapLayerDrawing;
+        m_renderStats.pixmapCopies++;
         RS_Painter painterLayerOverlays(pixmapLayerOverlays.get());
         setupPainter(&painterLayerOverlays);
 
@@ -164,6 +201,7 @@ void LC_WidgetViewPortRenderer::paintSequental(QPaintDevice* pd) {
 
     RS_Painter wPainter(pd);
     wPainter.drawPixmap(0, 0, *pixmapLayerOverlays);
+    m_renderStats.pixmapCopies++;
 }
 
 
@@ -179,6 +217,8 @@ void LC_WidgetViewPortRenderer::paintClassicalBuffered(QPaintDevice* pd) {
         redrawMethod = RS2::RedrawAll;
     }
 
+    QPoint scroll = prepareDrawingScroll(false);
+
     // Draw Layer 1
     if (redrawMethod & RS2::RedrawGrid) {
         m_pixmapLayer1->fill(m_colorBackground);
@@ -187,13 +227,20 @@ void LC_WidgetViewPortRenderer::paintClassicalBuffered(QPaintDevice* pd) {
         drawLayerBackground(&painterBackground);
     }
 
-    if (redrawMethod & RS2::RedrawDrawing) {
+    if (!(redrawMethod & RS2::RedrawDrawing) && !scroll.isNull()) {
+        scrollDrawingLayer(m_pixmapLayer2.get(), scroll, nullptr);
+    }
+    else if (redrawMethod & RS2::RedrawDrawing) {
         // DRaw layer 2
         m_pixmapLayer2->fill(Qt::transparent);
         RS_Painter painterLayerDrawing(m_pixmapLayer2.get());
         setupPainter(&painterLayerDrawing);
-        drawLayerEntities(&painterLayerDrawing);
-        drawLayerEntitiesOver(&painterLayerDrawing);
+        drawLayerDrawing(&painterLayerDrawing, true);
+    }
+    else if (isRenderingInProgress()) {
+        RS_Painter painterLayerDrawing(m_pixmapLayer2.get());
+        setupPainter(&painterLayerDrawing);
+        drawLayerDrawing(&painterLayerDrawing, false);
     }
 
     if (redrawMethod & RS2::RedrawOverlay) {
@@ -208,6 +255,79 @@ void LC_WidgetViewPortRenderer::paintClassicalBuffered(QPaintDevice* pd) {
     wPainter.drawPixmap(0, 0, *m_pixmapLayer1);
     wPainter.drawPixmap(0, 0, *m_pixmapLayer2);
     wPainter.drawPixmap(0, 0, *m_pixmapLayer3);
+    m_renderStats.pixmapCopies += 3;
+}
+
+/**
+ * Compares the viewport with the one the drawing layer was rendered for. If only the offset was changed
+ * (panning), the drawing layer may be scrolled by the returned delta in pixels. Otherwise, changes of the
+ * viewport invalidate the drawing layer.
+ *
+ * @param backgroundIncluded true if the drawing layer is painted over a copy of the background layer
+ * @return scroll of the drawing layer, null point if it should not be scrolled
+ */
+QPoint LC_WidgetViewPortRenderer::prepareDrawingScroll(bool backgroundIncluded) {
+    const RS_Vector factor = viewport->getFactor();
+    const int offsetX = viewport->getOffsetX();
+    const int offsetY = viewport->getOffsetY();
+    // gui y axis is directed down
+    QPoint scroll{offsetX - m_drawnOffsetX, m_drawnOffsetY - offsetY};
+    bool sameFactor = m_drawnFactor.valid && factor.x == m_drawnFactor.x && factor.y == m_drawnFactor.y;
+
+    m_drawnOffsetX = offsetX;
+    m_drawnOffsetY = offsetY;
+    m_drawnFactor = factor;
+
+    if (!sameFactor) {
+        redrawMethod = (RS2::RedrawMethod) (redrawMethod | RS2::RedrawDrawing);
+        return {};
+    }
+    if (scroll.isNull() || (redrawMethod & RS2::RedrawDrawing)) {
+        return {};
+    }
+    // a partially rendered drawing layer is rendered again
+    bool scrollable = m_incrementalPanning && !isRenderingInProgress()
+                      && std::abs(scroll.x()) < viewport->getWidth() && std::abs(scroll.y()) < viewport->getHeight()
+                      && !(backgroundIncluded && hasScreenFixedBackground());
+    if (!scrollable) {
+        redrawMethod = (RS2::RedrawMethod) (redrawMethod | RS2::RedrawDrawing);
+        return {};
+    }
+    redrawMethod = (RS2::RedrawMethod) (redrawMethod | RS2::RedrawGrid | RS2::RedrawOverlay);
+    return scroll;
+}
+
+/**
+ * Scrolls the drawing layer and renders the exposed parts of it only, with the bounding clip rect of
+ * each part, so culling visits just the entities of the exposed strips.
+ *
+ * @param background if given, the exposed parts are filled by it, otherwise they are cleared
+ */
+void LC_WidgetViewPortRenderer::scrollDrawingLayer(QPixmap* pixmap, const QPoint& scroll, const QPixmap* background) {
+    QRegion exposed;
+    pixmap->scroll(scroll.x(), scroll.y(), pixmap->rect(), &exposed);
+    m_renderStats.pixmapCopies++;
+
+    RS_Painter painter(pixmap);
+    setupPainter(&painter);
+    const LC_Rect viewportClipRect = renderBoundingClipRect;
+    for (const QRect& rect: exposed) {
+        painter.setClipRect(rect.x(), rect.y(), rect.width(), rect.height());
+        if (background != nullptr) {
+            painter.drawPixmap(rect, *background, rect);
+            m_renderStats.pixmapCopies++;
+        }
+        else {
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.fillRect(QRectF(rect), QBrush(Qt::transparent));
+            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        }
+        renderBoundingClipRect = prepareBoundingClipRect(rect.left(), rect.top(), rect.right() + 1, rect.bottom() + 1);
+        painter.setWorldBoundingRect(renderBoundingClipRect);
+        drawLayerEntities(&painter);
+        drawLayerEntitiesOver(&painter);
+    }
+    renderBoundingClipRect = viewportClipRect;
 }
 
 void LC_WidgetViewPortRenderer::setupPainter(RS_Painter *painter) {
@@ -234,35 +354,263 @@ void LC_WidgetViewPortRenderer::setupPainter(RS_Painter *painter) {
 
 
 void LC_WidgetViewPortRenderer::drawLayerBackground(RS_Painter *painter) {
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerBackgroundTimer.start();
-#endif
+    QElapsedTimer timer;
+    if (m_profiling) {
+        timer.start();
+    }
     doDrawLayerBackground(painter);
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerBackgroundTime += drawLayerBackgroundTimer.elapsed();
-#endif
+    if (m_profiling) {
+        m_renderStats.backgroundTime += timer.nsecsElapsed();
+    }
 }
 
 
 // fixme - sand - ADD additional pass with ordering of entities - in order to draw construction entities under normal ones!!!
 
 void LC_WidgetViewPortRenderer::drawLayerEntities(RS_Painter* painter) {
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerEntitiesTimer.start();
-#endif
+    QElapsedTimer timer;
+    if (m_profiling) {
+        timer.start();
+    }
+
+    // selected entities are drawn here as unselected ones, and once more by the overlays layer
+    // parts of the layer (exposed on panning) are rendered with clipping, on this thread
+    if (m_tiledRendering && !painter->hasClipping()) {
+        drawLayerEntitiesTiled(painter);
+    }
+    else {
+        RS_EntityContainer *container = viewport->getContainer();
+        painter->setDrawSelectedOnly(false);
+        doSetupBeforeContainerDraw();
+        renderContainer(painter, container);
+        doFinishAfterContainerDraw(painter);
+    }
+
+    if (m_profiling) {
+        m_renderStats.drawingTime += timer.nsecsElapsed();
+    }
+}
+
+namespace {
+    // size of tiles, in pixels
+    constexpr int RENDER_TILE_SIZE = 256;
+    // number of entities drawn between checks of the frame budget
+    constexpr size_t PROGRESSIVE_BATCH_SIZE = 512;
+    // number of groups of entities by binary order of the size on screen
+    constexpr int PROGRESSIVE_SIZE_BUCKETS = 32;
+
+    unsigned long removalGeneration(const RS_EntityContainer* container) {
+        const RS_Document* document = (container != nullptr) ? container->getDocument() : nullptr;
+        return (document != nullptr) ? document->getRemovalGeneration() : 0;
+    }
+}
 
-    RS_EntityContainer *container = viewport->getContainer();
+/**
+ * Renders entities of the drawing layer and items over them. In progressive mode, the rendering is
+ * done by batches until the frame budget is exceeded, and continued by following frames.
+ *
+ * @param restart true if the layer is rendered from scratch, false to continue progressive rendering
+ */
+void LC_WidgetViewPortRenderer::drawLayerDrawing(RS_Painter *painter, bool restart) {
+    if (!m_progressiveRendering) {
+        m_progressiveEntities.clear();
+        drawLayerEntities(painter);
+        drawLayerEntitiesOver(painter);
+        return;
+    }
+    if (restart) {
+        startProgressiveDrawing();
+    }
+    if (continueProgressiveDrawing(painter)) {
+        drawLayerEntitiesOver(painter);
+    }
+}
+
+/**
+ * Collects entities to render, ordered by their size on screen, largest first. Entities of similar
+ * size (of the same binary order) keep their order in the container.
+ */
+void LC_WidgetViewPortRenderer::startProgressiveDrawing() {
+    std::vector<RS_Entity*> entities;
+    collectEntitiesToRender(viewport->getContainer(), entities);
+
+    std::vector<std::vector<RS_Entity*>> buckets(PROGRESSIVE_SIZE_BUCKETS);
+    const double factor = std::max(viewport->getFactor().x, viewport->getFactor().y);
+    for (RS_Entity *e: entities) {
+        double uiSize = (e->getMax() - e->getMin()).magnitude() * factor;
+        int bucket = PROGRESSIVE_SIZE_BUCKETS - 1;
+        if (std::isfinite(uiSize)) {
+            int exponent = 0;
+            std::frexp(uiSize, &exponent);
+            bucket = std::clamp(exponent, 0, PROGRESSIVE_SIZE_BUCKETS - 1);
+        }
+        buckets[bucket].push_back(e);
+    }
+
+    m_progressiveEntities.clear();
+    m_progressiveEntities.reserve(entities.size());
+    for (int i = PROGRESSIVE_SIZE_BUCKETS - 1; i >= 0; i--) {
+        m_progressiveEntities.insert(m_progressiveEntities.end(), buckets[i].cbegin(), buckets[i].cend());
+    }
+    m_progressiveNext = 0;
+    m_progressiveContainer = viewport->getContainer();
+    m_progressiveGeneration = removalGeneration(m_progressiveContainer);
+}
+
+/**
+ * @return true if the collected entities may be deleted, as entities were removed from the document
+ * or the viewport shows another container, so the drawing layer should be rendered from scratch
+ */
+bool LC_WidgetViewPortRenderer::isProgressiveDrawingOutdated() const {
+    const RS_EntityContainer* container = viewport->getContainer();
+    return container != m_progressiveContainer || removalGeneration(container) != m_progressiveGeneration;
+}
+
+/**
+ * Draws the next batches of collected entities, until all are drawn or the frame budget is exceeded.
+ * Collected entities are valid while no entities are removed from the document, which is checked
+ * before each frame (see isProgressiveDrawingOutdated()).
+ *
+ * @return true if all entities are drawn
+ */
+bool LC_WidgetViewPortRenderer::continueProgressiveDrawing(RS_Painter *painter) {
+    QElapsedTimer timer;
+    if (m_profiling) {
+        timer.start();
+    }
     painter->setDrawSelectedOnly(false);
     doSetupBeforeContainerDraw();
-    justDrawEntity(painter, container);
+    const size_t count = m_progressiveEntities.size();
+    while (m_progressiveNext < count) {
+        const size_t batchEnd = std::min(count, m_progressiveNext + PROGRESSIVE_BATCH_SIZE);
+        for (; m_progressiveNext < batchEnd; m_progressiveNext++) {
+            painter->drawEntity(m_progressiveEntities[m_progressiveNext]);
+        }
+        if (m_progressiveNext < count && m_frameTimer.elapsed() > m_progressiveFrameBudget) {
+            doFinishAfterContainerDraw(painter);
+            if (m_profiling) {
+                m_renderStats.drawingTime += timer.nsecsElapsed();
+            }
+            return false;
+        }
+    }
+    doFinishAfterContainerDraw(painter);
+    if (m_profiling) {
+        m_renderStats.drawingTime += timer.nsecsElapsed();
+    }
+    std::vector<RS_Entity*>().swap(m_progressiveEntities);
+    m_progressiveNext = 0;
+    m_progressiveContainer = nullptr;
+    return true;
+}
 
-    painter->setDrawSelectedOnly(true);
-    doSetupBeforeContainerDraw();
-    justDrawEntity(painter, container);
+namespace {
+    /**
+     * Looks up blocks of the insert, or of inserts in the container, nested ones included.
+     * Inserts cache their block on the first lookup, which may also rebuild the name index
+     * of the block list, so this is done before the tiles are rendered.
+     */
+    void resolveInsertBlocks(RS_Entity *e) {
+        if (e->rtti() == RS2::EntityInsert) {
+            static_cast<RS_Insert *>(e)->getBlockForInsert();
+        }
+        if (e->isContainer()) {
+            for (RS_Entity *child: *static_cast<RS_EntityContainer *>(e)) {
+                resolveInsertBlocks(child);
+            }
+        }
+    }
+}
+
+/**
+ * Renders entities by tiles of the viewport. Each tile is rendered into its own image by a renderer
+ * copied from this one, so the pen caches of the renderers are not shared by threads. Entities are
+ * only read while the tiles are rendered. Images of tiles are composited by the given painter.
+ */
+void LC_WidgetViewPortRenderer::drawLayerEntitiesTiled(RS_Painter *painter) {
+    const int width = viewport->getWidth();
+    const int height = viewport->getHeight();
+    std::vector<QRect> tiles;
+    for (int y = 0; y < height; y += RENDER_TILE_SIZE) {
+        for (int x = 0; x < width; x += RENDER_TILE_SIZE) {
+            tiles.emplace_back(x, y, std::min(RENDER_TILE_SIZE, width - x), std::min(RENDER_TILE_SIZE, height - y));
+        }
+    }
+    size_t threads = m_tiledRenderingThreads > 0 ? size_t(m_tiledRenderingThreads)
+                                                 : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, tiles.size());
+
+    std::vector<std::unique_ptr<LC_WidgetViewPortRenderer>> renderers;
+    for (size_t i = 0; i < threads && tiles.size() > 1; i++) {
+        std::unique_ptr<LC_WidgetViewPortRenderer> renderer = createTileRenderer();
+        if (renderer == nullptr) {
+            break;
+        }
+        // counters of tiles are merged to the ones of this frame
+        renderer->m_renderStats = {};
+        renderers.push_back(std::move(renderer));
+    }
+    if (renderers.empty()) {
+        RS_EntityContainer *container = viewport->getContainer();
+        painter->setDrawSelectedOnly(false);
+        doSetupBeforeContainerDraw();
+        renderContainer(painter, container);
+        doFinishAfterContainerDraw(painter);
+        return;
+    }
+
+    // the spatial index and blocks of inserts are resolved on demand, so it's done here
+    // before the workers query them. Entities of the viewport are collected by the same query
+    // as tiles do, which builds the index, and only their inserts are resolved. It's serial
+    // work, reported as the tiles setup time.
+    QElapsedTimer setupTimer;
+    if (m_profiling) {
+        setupTimer.start();
+    }
+    std::vector<RS_Entity*> viewportEntities;
+    collectEntitiesToRender(viewport->getContainer(), viewportEntities);
+    for (RS_Entity *e: viewportEntities) {
+        resolveInsertBlocks(e);
+    }
+    if (m_profiling) {
+        m_renderStats.tilesSetupTime += setupTimer.nsecsElapsed();
+    }
+
+    std::vector<QImage> images(tiles.size());
+    std::atomic<size_t> nextTile{0};
+    LC_Parallel::forEachChunk(renderers.size(), renderers.size(), [&](size_t chunk, size_t, size_t) {
+        LC_WidgetViewPortRenderer *renderer = renderers[chunk].get();
+        for (size_t index = nextTile++; index < tiles.size(); index = nextTile++) {
+            renderer->drawTile(images[index], tiles[index]);
+        }
+    });
+
+    for (size_t i = 0; i < tiles.size(); i++) {
+        painter->drawImage(tiles[i].topLeft(), images[i]);
+    }
+    m_renderStats.pixmapCopies += tiles.size();
+    for (const auto &renderer: renderers) {
+        m_renderStats.merge(renderer->m_renderStats);
+    }
+}
 
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerEntitiesTime += drawLayerEntitiesTimer.elapsed();
-#endif
+/**
+ * Renders entities of the tile (in viewport pixels) into the image, culled by the bounding
+ * clip rect of the tile.
+ */
+void LC_WidgetViewPortRenderer::drawTile(QImage &image, const QRect &tile) {
+    image = QImage(tile.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    renderBoundingClipRect = prepareBoundingClipRect(tile.left(), tile.top(), tile.right() + 1, tile.bottom() + 1);
+
+    RS_Painter painter(&image);
+    setupPainter(&painter);
+    painter.translate(-tile.x(), -tile.y());
+    painter.setDrawSelectedOnly(false);
+    doSetupBeforeContainerDraw();
+    renderContainer(&painter, viewport->getContainer());
+    doFinishAfterContainerDraw(&painter);
+    painter.end();
 }
 
 void LC_WidgetViewPortRenderer::doSetupBeforeContainerDraw() {
@@ -272,11 +620,12 @@ void LC_WidgetViewPortRenderer::doSetupBeforeContainerDraw() {
 
 
 void LC_WidgetViewPortRenderer::drawLayerOverlays(RS_Painter *painter) {
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerOverlaysTimer.start();
-#endif
+    QElapsedTimer timer;
+    if (m_profiling) {
+        timer.start();
+    }
     doDrawLayerOverlays(painter);
-#ifdef DEBUG_RENDERING_DETAILS
-    drawLayerOverlaysTime +=  drawLayerOverlaysTimer.elapsed();
-#endif
+    if (m_profiling) {
+        m_renderStats.overlaysTime += timer.nsecsElapsed();
+    }
 }
@@ -23,9 +23,14 @@
 #ifndef LC_WIDGETVIEWPORTRENDERER_H
 #define LC_WIDGETVIEWPORTRENDERER_H
 
+#include <QElapsedTimer>
+#include <QPoint>
+
 #include "lc_graphicviewportrenderer.h"
 
+class QImage;
 class QPixmap;
+class QRect;
 
 class LC_WidgetViewPortRenderer:public LC_GraphicViewportRenderer
 {
@@ -36,10 +41,23 @@ public:
     void setupPainter(RS_Painter* painter) override;
     void setAntialiasing(bool state) {antialiasing = state;}
     void invalidate(RS2::RedrawMethod method) {redrawMethod = static_cast<RS2::RedrawMethod>(redrawMethod | method);}
+    /**
+     * @return true if progressive rendering of the drawing layer is not finished, so the widget
+     * should be painted again
+     */
+    bool isRenderingInProgress() const {return !m_progressiveEntities.empty();}
 protected:
+    LC_WidgetViewPortRenderer(const LC_WidgetViewPortRenderer& other);
+
     void doRender() override;
+    /**
+     * @return renderer with the same settings, which renders entities of a tile on a worker thread;
+     * nullptr if the renderer doesn't support tiled rendering
+     */
+    virtual std::unique_ptr<LC_WidgetViewPortRenderer> createTileRenderer() const {return nullptr;}
 
     virtual void doSetupBeforeContainerDraw();
+    virtual void doFinishAfterContainerDraw([[maybe_unused]]RS_Painter* painter) {}
     void paintClassicalBuffered(QPaintDevice* pd);
     void paintSequental(QPaintDevice* pd);
 
@@ -50,19 +68,15 @@ protected:
     virtual void drawLayerEntitiesOver([[maybe_unused]]RS_Painter* painter){}
     virtual void doDrawLayerBackground([[maybe_unused]]RS_Painter *painter) {}
     virtual void doDrawLayerOverlays([[maybe_unused]]RS_Painter *painter) {}
+    /**
+     * @return true if the background layer has content fixed to the screen (not to the drawing), so
+     * the drawing layer that includes the background can't be scrolled on panning
+     */
+    virtual bool hasScreenFixedBackground() const {return false;}
     int getMinRenderableTextHeightInPx() const {
         return m_render_minRenderableTextHeightInPx;
     }
 
-#ifdef DEBUG_RENDERING
-    QElapsedTimer drawLayerBackgroundTimer;
-    QElapsedTimer drawLayerEntitiesTimer;
-    QElapsedTimer drawLayerOverlaysTimer;
-    long drawLayerBackgroundTime = 0;
-    long drawLayerEntitiesTime = 0;
-    long drawLayerOverlaysTime = 0;
-#endif
-
 private:
     bool antialiasing = false;
     bool classicRenderer = true;
@@ -73,6 +87,37 @@ private:
 
     RS2::RedrawMethod redrawMethod = RS2::RedrawAll;
 
+    // scroll the drawing layer on panning and render only the exposed parts of it
+    bool m_incrementalPanning = true;
+    // viewport offset and factor the drawing layer was rendered for
+    int m_drawnOffsetX = 0;
+    int m_drawnOffsetY = 0;
+    RS_Vector m_drawnFactor = RS_Vector(false);
+
+    // render entities by tiles on worker threads
+    bool m_tiledRendering = false;
+    // number of worker threads for tiled rendering, 0 - number of cores
+    int m_tiledRenderingThreads = 0;
+
+    // render the drawing layer by batches within the frame budget (ms), largest entities first
+    bool m_progressiveRendering = false;
+    int m_progressiveFrameBudget = 40;
+    QElapsedTimer m_frameTimer;
+    std::vector<RS_Entity*> m_progressiveEntities;
+    size_t m_progressiveNext = 0;
+    // container the entities were collected from, and its removal generation at that time
+    const RS_EntityContainer* m_progressiveContainer = nullptr;
+    unsigned long m_progressiveGeneration = 0;
+
+    void drawLayerDrawing(RS_Painter* painter, bool restart);
+    void startProgressiveDrawing();
+    bool continueProgressiveDrawing(RS_Painter* painter);
+    bool isProgressiveDrawingOutdated() const;
+    void drawLayerEntitiesTiled(RS_Painter* painter);
+    void drawTile(QImage& image, const QRect& tile);
+    QPoint prepareDrawingScroll(bool backgroundIncluded);
+    void scrollDrawingLayer(QPixmap* pixmap, const QPoint& scroll, const QPixmap* background);
+
     int m_render_minRenderableTextHeightInPx = 4;
     double m_render_minCircleDrawingRadius = 2.0;
     double m_render_minArcDrawingRadius = 0.5;
@@ -258,13 +258,22 @@ void RS_GraphicView::onViewportChanged() {
     adjustZoomControls();
     QString info = m_viewport->getGrid()->getInfo();
     updateGridStatusWidget(info);
-    redraw();
+    // the renderer compares the viewport with the one the drawing was rendered for,
+    // and scrolls or re-renders the drawing layer
+    redraw((RS2::RedrawMethod) (RS2::RedrawGrid | RS2::RedrawOverlay));
 }
 
 void RS_GraphicView::onViewportRedrawNeeded() {
     redraw(RS2::RedrawDrawing);
 }
 
+/**
+ * Selected entities are drawn by the overlay layer, so the drawing layer is kept.
+ */
+void RS_GraphicView::onViewportSelectionChanged() {
+    redraw(RS2::RedrawOverlay);
+}
+
 void RS_GraphicView::onUCSChanged(LC_UCS* ucs) {
     emit ucsChanged(ucs);
     QString info = m_viewport->getGrid()->getInfo();
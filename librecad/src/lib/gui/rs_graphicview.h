@@ -189,6 +189,7 @@ protected:
     LC_WidgetViewPortRenderer* getRenderer() const;
     void resizeEvent(QResizeEvent *event) override;
     void onViewportRedrawNeeded() override;
+    void onViewportSelectionChanged() override;
 private:
     std::unique_ptr<RS_EventHandler> m_eventHandler;
     RS_EntityContainer *container = nullptr;
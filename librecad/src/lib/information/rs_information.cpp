@@ -38,6 +38,7 @@
 #include "rs_ellipse.h"
 #include "rs_entity.h"
 #include "rs_entitycontainer.h"
+#include "rs_insert.h"
 #include "rs_line.h"
 #include "rs_math.h"
 #include "rs_polyline.h"
@@ -69,6 +70,12 @@ bool isLine(RS_Entity const* e) {
     return e != nullptr && e->rtti() == RS2::EntityLine;
 }
 
+// whether the entity is an insert drawn from shared geometry of a font glyph or a block
+bool isInstance(RS_Entity const* e) {
+    return e != nullptr && e->rtti() == RS2::EntityInsert
+           && static_cast<RS_Insert const*>(e)->isInstance();
+}
+
 // whether the entity is an ellipse
 bool isEllipse(RS_Entity const* e) {
     return e != nullptr && e->rtti() == RS2::EntityEllipse;
@@ -503,6 +510,14 @@ RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
         }
     }
 
+    // inserts drawn as instances have no entities, intersect the entities of their blocks instead
+    if (isInstance(e2)) {
+        std::swap(e1, e2);
+    }
+    if (isInstance(e1)) {
+        return static_cast<RS_Insert const*>(e1)->getInstanceIntersection(e2, onEntities);
+    }
+
     //avoid intersections between line segments the same spline
     /* ToDo: 24 Aug 2011, Dongxu Li, if rtti() is not defined for the parent, the following check for splines may still cause segfault */
     if ( e1->getParent() && e1->getParent() == e2->getParent()) {
@@ -22,6 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <algorithm>
 #include <cfloat>
+#include <cmath>
+#include <iostream>
 #include <numeric>
 
 #include "lc_quadratic.h"
@@ -37,60 +39,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "emu_c99.h" /* C99 math */
 #endif
 
-/**
- * Constructor.
- */
-
-LC_Quadratic::LC_Quadratic():
-    m_mQuad(2,2),
-    m_vLinear(2),
-    m_bValid(false)
-{}
-
-LC_Quadratic::LC_Quadratic(const LC_Quadratic& lc0):
-    m_bIsQuadratic(lc0.isQuadratic())
-    ,m_bValid(lc0)
-{
-    if(!m_bValid)
-        return;
-
-    if(m_bIsQuadratic)
-        m_mQuad=lc0.getQuad();
-
-    m_vLinear=lc0.getLinear();
-    m_dConst=lc0.m_dConst;
-}
-
-LC_Quadratic& LC_Quadratic::operator = (const LC_Quadratic& lc0)
-{
-    if(lc0.isQuadratic()){
-        m_mQuad.resize(2,2,false);
-        m_mQuad=lc0.getQuad();
-    }
-    m_vLinear.resize(2);
-    m_vLinear=lc0.getLinear();
-    m_dConst=lc0.m_dConst;
-    m_bIsQuadratic=lc0.isQuadratic();
-    m_bValid=lc0.m_bValid;
-    return *this;
-}
-
-
-LC_Quadratic::LC_Quadratic(std::vector<double> ce):
-    m_mQuad(2,2),
-    m_vLinear(2)
+LC_Quadratic::LC_Quadratic(std::vector<double> ce)
 {
     if(ce.size()==6){
         //quadratic
-        m_mQuad(0,0)=ce[0];
-        m_mQuad(0,1)=0.5*ce[1];
-        m_mQuad(1,0)=m_mQuad(0,1);
-        m_mQuad(1,1)=ce[2];
-        m_vLinear(0)=ce[3];
-        m_vLinear(1)=ce[4];
-        m_dConst=ce[5];
-        m_bIsQuadratic=true;
-        m_bValid=true;
+        *this = LC_Quadratic{std::array<double, 6>{{ce[0], ce[1], ce[2], ce[3], ce[4], ce[5]}}};
         return;
     }
     if(ce.size()==3){
@@ -104,6 +57,19 @@ LC_Quadratic::LC_Quadratic(std::vector<double> ce):
     m_bValid=false;
 }
 
+LC_Quadratic::LC_Quadratic(const std::array<double, 6>& ce):
+    m_dConst(ce[5])
+    ,m_bIsQuadratic(true)
+    ,m_bValid(true)
+{
+    m_mQuad(0,0)=ce[0];
+    m_mQuad(0,1)=0.5*ce[1];
+    m_mQuad(1,0)=m_mQuad(0,1);
+    m_mQuad(1,1)=ce[2];
+    m_vLinear(0)=ce[3];
+    m_vLinear(1)=ce[4];
+}
+
 /** construct a parabola, ellipse or hyperbola as the path of center of tangent circles
   passing the point
 *@circle, an entity
@@ -111,9 +77,7 @@ LC_Quadratic::LC_Quadratic(std::vector<double> ce):
 *@return, a path of center tangential circles which pass the point
 */
 LC_Quadratic::LC_Quadratic(const RS_AtomicEntity* circle, const RS_Vector& point)
-    : m_mQuad(2,2)
-    ,m_vLinear(2)
-    ,m_bIsQuadratic(true)
+    : m_bIsQuadratic(true)
     ,m_bValid(true)
 {
     if(circle==nullptr) {
@@ -234,22 +198,22 @@ bool LC_Quadratic::operator != (bool valid) const
     return m_bValid != valid;
 }
 
-boost::numeric::ublas::vector<double>& LC_Quadratic::getLinear()
+LC_Quadratic::Vector& LC_Quadratic::getLinear()
 {
     return m_vLinear;
 }
 
-const boost::numeric::ublas::vector<double>& LC_Quadratic::getLinear() const
+const LC_Quadratic::Vector& LC_Quadratic::getLinear() const
 {
     return m_vLinear;
 }
 
-boost::numeric::ublas::matrix<double>& LC_Quadratic::getQuad()
+LC_Quadratic::Matrix& LC_Quadratic::getQuad()
 {
     return m_mQuad;
 }
 
-const boost::numeric::ublas::matrix<double>& LC_Quadratic::getQuad() const
+const LC_Quadratic::Matrix& LC_Quadratic::getQuad() const
 {
     return m_mQuad;
 }
@@ -269,9 +233,7 @@ double& LC_Quadratic::constTerm()
 LC_Quadratic::LC_Quadratic(const RS_AtomicEntity* circle0,
                            const RS_AtomicEntity* circle1,
                            bool mirror):
-    m_mQuad(2,2)
-    ,m_vLinear(2)
-    ,m_bValid(false)
+    m_bValid(false)
 {
     //    DEBUG_HEADER
 
@@ -421,6 +383,14 @@ std::vector<double>  LC_Quadratic::getCoefficients() const
     return ret;
 }
 
+std::array<double, 6> LC_Quadratic::getQuadraticCoefficients() const
+{
+    if(!m_bIsQuadratic)
+        return {{0., 0., 0., m_vLinear(0), m_vLinear(1), m_dConst}};
+    return {{m_mQuad(0,0), m_mQuad(0,1)+m_mQuad(1,0), m_mQuad(1,1),
+             m_vLinear(0), m_vLinear(1), m_dConst}};
+}
+
 LC_Quadratic LC_Quadratic::move(const RS_Vector& v)
 {
     if(m_bValid && v.valid ) {
@@ -440,13 +410,11 @@ LC_Quadratic LC_Quadratic::move(const RS_Vector& v)
 
 LC_Quadratic LC_Quadratic::rotate(double angle)
 {
-    using namespace boost::numeric::ublas;
-    matrix<double> m=rotationMatrix(angle);
-    matrix<double> t=trans(m);
-    m_vLinear = prod(t, m_vLinear);
+    const Matrix m=rotationMatrix(angle);
+    const Matrix t=m.transposed();
+    m_vLinear = t * m_vLinear;
     if(m_bIsQuadratic){
-        m_mQuad=prod(m_mQuad,m);
-        m_mQuad=prod(t, m_mQuad);
+        m_mQuad = t * (m_mQuad * m);
     }
     return *this;
 }
@@ -465,17 +433,12 @@ LC_Quadratic LC_Quadratic::rotate(const RS_Vector& center, double angle)
 LC_Quadratic LC_Quadratic::shear(double k)
 {
     if(isQuadratic()){
-        auto getCes = [this]() -> std::array<double, 6>{
-            std::vector<double> cev = getCoefficients();
-            return {cev[0], cev[1], cev[2], cev[3], cev[4], cev[5]};
-        };
-        const auto& [a,b,c,d,e,f] = getCes();
+        const auto [a,b,c,d,e,f] = getQuadraticCoefficients();
 
-        const std::vector<double> sheared = {{
+        return LC_Quadratic{std::array<double, 6>{{
             a, -2.*k*a + b, k*(k*a - b) + c,
             d, e - k*d, f
-        }};
-        return {sheared};
+        }}};
     }
     LC_Quadratic qf(*this);
     qf.m_vLinear(1) -= k * qf.m_vLinear(0);
@@ -583,8 +546,43 @@ RS_VectorSolutions LC_Quadratic::getIntersection(const LC_Quadratic& l1, const L
         }
         return getIntersection(p1->flipXY(),p2->flipXY()).flipXY();
     }
-    std::vector<std::vector<double> >  ce = { p1->getCoefficients(),
-                                            p2->getCoefficients()};
+    // conics with proportional quadratic parts, e.g. two circles: the difference of the
+    // equations is linear, so intersections are found by the line-quadratic solver instead
+    // of the quartic
+    const std::array<double, 6> ce1 = p1->getQuadraticCoefficients();
+    const std::array<double, 6> ce2 = p2->getQuadraticCoefficients();
+    const auto largest = std::max_element(ce1.cbegin(), ce1.cbegin() + 3, [](double x, double y) {
+        return std::abs(x) < std::abs(y);
+    }) - ce1.cbegin();
+    const double k = ce1[largest] != 0. ? ce2[largest]/ce1[largest] : 0.;
+    const double tolerance = RS_TOLERANCE*std::abs(ce2[largest]);
+    if (k != 0.
+        && std::abs(ce2[0] - k*ce1[0]) <= tolerance
+        && std::abs(ce2[1] - k*ce1[1]) <= tolerance
+        && std::abs(ce2[2] - k*ce1[2]) <= tolerance) {
+        LC_Quadratic radical{std::vector<double>{ce2[3] - k*ce1[3], ce2[4] - k*ce1[4], ce2[5] - k*ce1[5]}};
+        if (std::abs(radical.m_vLinear(0)) + std::abs(radical.m_vLinear(1)) < tolerance) {
+            // identical or disjoint conics
+            return ret;
+        }
+        // a tangent line gives the touching point twice, apart by the rounding of the square
+        // root in the solver; the quartic solver returns it once
+        const double tangentTolerance = std::sqrt(RS_TOLERANCE);
+        for (const RS_Vector& vp: getIntersection(*p1, radical)) {
+            auto same = std::find_if(ret.begin(), ret.end(), [&vp, tangentTolerance](const RS_Vector& v) {
+                return vp.distanceTo(v) < tangentTolerance;
+            });
+            if (same == ret.end()) {
+                ret.push_back(vp);
+            } else {
+                *same = (*same + vp) * 0.5;
+            }
+        }
+        return ret;
+    }
+
+    std::vector<std::vector<double> >  ce = { {ce1.cbegin(), ce1.cend()},
+                                              {ce2.cbegin(), ce2.cend()}};
     if(RS_DEBUG->getLevel()>=RS_Debug::D_INFORMATIONAL){
         DEBUG_HEADER
                 std::cout<<*p1<<std::endl;
@@ -597,18 +595,14 @@ RS_VectorSolutions LC_Quadratic::getIntersection(const LC_Quadratic& l1, const L
             valid=false;
             break;
         }
-        const std::vector<double> xyi = {v.x * v.x, v.x * v.y, v.y * v.y, v.x, v.y, 1.};
-        const double e0 = std::inner_product(xyi.cbegin(), xyi.cend(), ce.front().cbegin(), 0.);
-        const double e1 = std::inner_product(xyi.cbegin(), xyi.cend(), ce.back().cbegin(), 0.);
+        const std::array<double, 6> xyi = {{v.x * v.x, v.x * v.y, v.y * v.y, v.x, v.y, 1.}};
+        const double e0 = std::inner_product(xyi.cbegin(), xyi.cend(), ce1.cbegin(), 0.);
+        const double e1 = std::inner_product(xyi.cbegin(), xyi.cend(), ce2.cbegin(), 0.);
         LC_LOG<<__func__<<"(): "<<v.x<<","<<v.y<<": equ0= "<<e0;
         LC_LOG<<__func__<<"(): "<<v.x<<","<<v.y<<": equ1= "<<e1;
     }
     if(valid) return sol;
-    ce.clear();
-    ce.push_back(p1->getCoefficients());
-    ce.push_back(p2->getCoefficients());
-    sol=RS_Math::simultaneousQuadraticSolverFull(ce);
-    ret.clear();
+    // the solver is deterministic: keep the finite solutions instead of solving again
     for(auto const& v: sol){
         if(v.magnitude()<=RS_MAXDOUBLE){
             ret.push_back(v);
@@ -627,14 +621,9 @@ RS_VectorSolutions LC_Quadratic::getIntersection(const LC_Quadratic& l1, const L
    cos x, sin x
    -sin x, cos x
    */
-boost::numeric::ublas::matrix<double> LC_Quadratic::rotationMatrix(const double& angle)
+LC_Quadratic::Matrix LC_Quadratic::rotationMatrix(const double& angle)
 {
-    boost::numeric::ublas::matrix<double> ret(2,2);
-    ret(0,0)=cos(angle);
-    ret(0,1)=sin(angle);
-    ret(1,0)=-ret(0,1);
-    ret(1,1)=ret(0,0);
-    return ret;
+    return rotationMatrix(std::cos(angle), std::sin(angle));
 }
 
 /**
@@ -653,18 +642,13 @@ LC_Quadratic LC_Quadratic::getDualCurve() const
 {
     if (!isQuadratic())
         return LC_Quadratic{};
-    auto getCes = [this]() -> std::array<double, 6>{
-        std::vector<double> cev = getCoefficients();
-        return {cev[0], cev[1], cev[2], cev[3], cev[4], cev[5]};
-    };
-    const auto& [a,b,c,d,e,f] = getCes();
+    const auto [a,b,c,d,e,f] = getQuadraticCoefficients();
 
-    const std::vector<double> dualCe = {{
+    return LC_Quadratic{std::array<double, 6>{{
         e*e - 4.*c*f, 4.*b*f - 2.*d*e, d*d - 4.*a*f,
         4.*c*d-2.*b*e, 4.*a*e-2.*b*d,
         b*b-4.*a*c
-    }};
-    return {dualCe};
+    }}};
 }
 
 /**
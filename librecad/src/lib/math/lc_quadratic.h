@@ -25,13 +25,49 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #ifndef LC_QUADRATIC_H
 #define LC_QUADRATIC_H
 
-#include <boost/numeric/ublas/matrix.hpp>
-#include <boost/numeric/ublas/io.hpp>
+#include <array>
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
 
 class RS_Vector;
 class RS_VectorSolutions;
 class RS_AtomicEntity;
 
+/**
+ * Fixed-size matrix of doubles, stored in place (no heap allocation). Elements are
+ * accessed as m(row, column); a column vector is a matrix of one column, accessed as v(row).
+ */
+template<std::size_t Rows, std::size_t Columns>
+struct LC_FixedMatrix {
+    std::array<double, Rows * Columns> data{};
+
+    constexpr double& operator () (std::size_t row, std::size_t column = 0) {
+        return data[row * Columns + column];
+    }
+    constexpr const double& operator () (std::size_t row, std::size_t column = 0) const {
+        return data[row * Columns + column];
+    }
+
+    constexpr LC_FixedMatrix<Columns, Rows> transposed() const {
+        LC_FixedMatrix<Columns, Rows> ret;
+        for (std::size_t i = 0; i < Rows; ++i)
+            for (std::size_t j = 0; j < Columns; ++j)
+                ret(j, i) = (*this)(i, j);
+        return ret;
+    }
+
+    template<std::size_t N>
+    constexpr LC_FixedMatrix<Rows, N> operator * (const LC_FixedMatrix<Columns, N>& other) const {
+        LC_FixedMatrix<Rows, N> ret;
+        for (std::size_t i = 0; i < Rows; ++i)
+            for (std::size_t j = 0; j < N; ++j)
+                for (std::size_t k = 0; k < Columns; ++k)
+                    ret(i, j) += (*this)(i, k) * other(k, j);
+        return ret;
+    }
+};
+
 /**
  * Class for generic linear and quadratic equation
  * supports translation and rotation of an equation
@@ -40,9 +76,10 @@ class RS_AtomicEntity;
  */
 class LC_Quadratic {
 public:
-    LC_Quadratic();
-    LC_Quadratic(const LC_Quadratic& lc0);
-    LC_Quadratic& operator = (const LC_Quadratic& lc0);
+    using Matrix = LC_FixedMatrix<2, 2>;
+    using Vector = LC_FixedMatrix<2, 1>;
+
+    LC_Quadratic() = default;
 	/** \brief construct a ellipse or hyperbola as the path of center of tangent circles
       passing the point */
     LC_Quadratic(const RS_AtomicEntity* circle, const RS_Vector& point);
@@ -60,7 +97,17 @@ public:
     LC_Quadratic(const RS_Vector& point0, const RS_Vector& point1);
 
     LC_Quadratic(std::vector<double> ce);
+    /**
+     * @brief LC_Quadratic, construct a quadratic from coefficients {a, b, c, d, e, f} of
+     * a*x^2 + b*x*y + c*y^2 + d*x + e*y + f = 0
+     */
+    explicit LC_Quadratic(const std::array<double, 6>& ce);
     std::vector<double> getCoefficients() const;
+    /**
+     * @brief getQuadraticCoefficients, coefficients {a, b, c, d, e, f} without allocation,
+     * a, b and c are zeros for a linear equation
+     */
+    std::array<double, 6> getQuadraticCoefficients() const;
     LC_Quadratic move(const RS_Vector& v);
     LC_Quadratic rotate(double a);
     LC_Quadratic rotate(const RS_Vector& center, double a);
@@ -85,10 +132,10 @@ public:
 	bool operator == (bool valid) const;
 	bool operator != (bool valid) const;
 
-	boost::numeric::ublas::vector<double>& getLinear();
-	 const boost::numeric::ublas::vector<double>& getLinear() const;
-	 boost::numeric::ublas::matrix<double>& getQuad();
-	 const boost::numeric::ublas::matrix<double>& getQuad() const;
+	Vector& getLinear();
+	 const Vector& getLinear() const;
+	 Matrix& getQuad();
+	 const Matrix& getQuad() const;
 	 double const& constTerm()const;
 	 double& constTerm();
 
@@ -105,7 +152,11 @@ public:
     LC_Quadratic getDualCurve() const;
 
     /** the matrix of rotation by angle **/
-    static boost::numeric::ublas::matrix<double> rotationMatrix(const double& angle);
+    static Matrix rotationMatrix(const double& angle);
+    /** the matrix of rotation by angle, given by its cosine and sine **/
+    static constexpr Matrix rotationMatrix(double cosine, double sine) {
+        return Matrix{{cosine, sine, -sine, cosine}};
+    }
 
     static RS_VectorSolutions getIntersection(const LC_Quadratic& l1, const LC_Quadratic& l2);
 
@@ -113,8 +164,8 @@ public:
 
 private:
     // the equation form: {x, y}.m_mQuad.{{x},{y}} + m_vLinear.{{x},{y}}+m_dConst=0
-    boost::numeric::ublas::matrix<double> m_mQuad;
-    boost::numeric::ublas::vector<double> m_vLinear;
+    Matrix m_mQuad;
+    Vector m_vLinear;
     double m_dConst = 0.;
     bool m_bIsQuadratic = false;
     /** whether this quadratic form is valid */
@@ -26,6 +26,7 @@
 #include "rs_modification.h"
 
 #include <QSet>
+#include <QTransform>
 
 #include "lc_graphicviewport.h"
 #include "lc_linemath.h"
@@ -46,6 +47,7 @@
 #include "rs_math.h"
 #include "rs_mtext.h"
 #include "rs_polyline.h"
+#include "rs_preview.h"
 #include "rs_settings.h"
 #include "rs_text.h"
 #include "rs_units.h"
@@ -117,6 +119,12 @@ namespace {
                     return vp.valid && e->isPointOnEntity(vp, tolerance);
                 });
             }
+        } else {
+            // inserts drawn as instances have no entities, the block entities are intersected instead
+            RS_VectorSolutions s2 = RS_Information::getIntersection(&trimEntity, &limitEntity, false);
+            std::copy_if(s2.begin(), s2.end(), std::back_inserter(sol), [&limitEntity, tolerance](const RS_Vector &vp){
+                return vp.valid && limitEntity.isPointOnEntity(vp, tolerance);
+            });
         }
         return sol;
     }
@@ -204,6 +212,21 @@ namespace {
        bool result = point1.distanceTo(candidate) < RS_TOLERANCE || point2.distanceTo(candidate) < RS_TOLERANCE;
        return result;
     }
+
+    // affine transformations of world coordinates, same as RS_Entity::rotate(), scale() and mirror()
+    QTransform rotationAround(const RS_Vector& center, double angle) {
+        return QTransform().translate(center.x, center.y).rotateRadians(angle).translate(-center.x, -center.y);
+    }
+
+    QTransform scalingAround(const RS_Vector& center, const RS_Vector& factor) {
+        return QTransform().translate(center.x, center.y).scale(factor.x, factor.y).translate(-center.x, -center.y);
+    }
+
+    QTransform mirroringAbout(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
+        double axisAngle = axisPoint1.angleTo(axisPoint2);
+        return QTransform().translate(axisPoint1.x, axisPoint1.y).rotateRadians(axisAngle).scale(1., -1.)
+            .rotateRadians(-axisAngle).translate(-axisPoint1.x, -axisPoint1.y);
+    }
 }
 
 
@@ -1726,6 +1749,13 @@ bool RS_Modification::move(RS_MoveData &data, bool previewOnly, [[maybe_unused]]
 bool RS_Modification::move(RS_MoveData& data, const std::vector<RS_Entity*> &entitiesList, bool forPreviewOnly, bool keepSelected) {
 
     int numberOfCopies = data.obtainNumberOfCopies();
+    if (forPreviewOnly && isPreviewedTransformed(entitiesList)) {
+        for (int num = 1; num <= numberOfCopies; num++) {
+            const RS_Vector offset = data.offset * num;
+            previewTransformed(entitiesList, QTransform::fromTranslate(offset.x, offset.y));
+        }
+        return true;
+    }
     std::vector<RS_Entity*> clonesList;
 
     for(auto e: entitiesList){
@@ -1744,6 +1774,19 @@ bool RS_Modification::move(RS_MoveData& data, const std::vector<RS_Entity*> &ent
     return true;
 }
 
+/**
+ * @return true, if the entities are modified in preview container, and they are too many to be
+ * previewed by clones. Such entities are previewed by previewTransformed().
+ */
+bool RS_Modification::isPreviewedTransformed(const std::vector<RS_Entity*>& entitiesList) const {
+    return container->rtti() == RS2::EntityPreview
+        && static_cast<RS_Preview*>(container)->isPreviewedTransformed(entitiesList);
+}
+
+void RS_Modification::previewTransformed(const std::vector<RS_Entity*>& entitiesList, const QTransform& wcsTransform) const {
+    static_cast<RS_Preview*>(container)->addTransformed(entitiesList, wcsTransform);
+}
+
 RS_Entity *RS_Modification::getClone(bool forPreviewOnly, const RS_Entity *e) const {
     RS_Entity* result = nullptr;
     if (forPreviewOnly){
@@ -1904,6 +1947,23 @@ bool RS_Modification::rotate(RS_RotateData& data, const std::vector<RS_Entity*>
     // Create new entities
 
     int numberOfCopies = data.obtainNumberOfCopies();
+    if (forPreviewOnly && isPreviewedTransformed(entitiesList)) {
+        for (int num = 1; num <= numberOfCopies; num++) {
+            double rotationAngle = data.angle * num;
+            QTransform transform = rotationAround(data.center, rotationAngle);
+            if (data.twoRotations && data.refPoint.distanceTo(data.center) >= RS_TOLERANCE) {
+                RS_Vector rotatedRefPoint = data.refPoint;
+                rotatedRefPoint.rotate(data.center, rotationAngle);
+                double secondRotationAngle = data.secondAngle;
+                if (data.secondAngleIsAbsolute){
+                    secondRotationAngle -= rotationAngle;
+                }
+                transform *= rotationAround(rotatedRefPoint, secondRotationAngle);
+            }
+            previewTransformed(entitiesList, transform);
+        }
+        return true;
+    }
     for (auto e: entitiesList) {
         for (int num = 1; num <= numberOfCopies; num++) {
             RS_Entity* ec = getClone(forPreviewOnly, e);
@@ -1959,6 +2019,13 @@ bool RS_Modification::scale(RS_ScaleData& data, bool forPreviewOnly, const bool
  * modification.
  */
 bool RS_Modification::scale(RS_ScaleData& data, const std::vector<RS_Entity*> &entitiesList, bool forPreviewOnly, const bool keepSelected) {
+    if (forPreviewOnly && isPreviewedTransformed(entitiesList)) {
+        int numberOfCopies = data.obtainNumberOfCopies();
+        for (int num = 1; num <= numberOfCopies; num++) {
+            previewTransformed(entitiesList, scalingAround(data.referencePoint, RS_Math::pow(data.factor, num)));
+        }
+        return true;
+    }
     std::vector<RS_Entity*> selectedList,clonesList;
 
     for(auto ec: entitiesList){
@@ -2030,6 +2097,11 @@ bool RS_Modification::mirror(RS_MirrorData& data, const std::vector<RS_Entity*>
 //    int numberOfCopies = obtainNumberOfCopies(data);
     int numberOfCopies = 1; // fixme - think about support of multiple copies.... may it be be something like moving the central point of selection? Like mirror+move?
 
+    if (forPreviewOnly && isPreviewedTransformed(entitiesList)) {
+        previewTransformed(entitiesList, mirroringAbout(data.axisPoint1, data.axisPoint2));
+        return true;
+    }
+
     // Create new entities
 
     for(auto e: entitiesList){
@@ -2095,9 +2167,9 @@ bool RS_Modification::rotate2(RS_Rotate2Data& data, const std::vector<RS_Entity*
 void RS_Modification::deleteOriginalAndAddNewEntities(const std::vector<RS_Entity*> &addList, const std::vector<RS_Entity*> &originalEntities, bool addOnly, bool deleteOriginals, bool forceUndoable){
     LC_UndoSection undo(document, viewport, handleUndo); // bundle remove/add entities in one undoCycle
     if (addOnly) {
+        container->addEntities(addList);
         for (RS_Entity *e: addList) {
             if (e != nullptr) {
-                container->addEntity(e);
                 undo.addUndoable(e);
             }
         }
@@ -2191,9 +2263,9 @@ void RS_Modification::deselectOriginals(const std::vector<RS_Entity*> &entitiesL
 void RS_Modification::addNewEntities(const std::vector<RS_Entity*>& addList, bool forceUndoable) {
     LC_UndoSection undo( document, viewport, handleUndo || forceUndoable);
 
+    container->addEntities(addList);
     for (RS_Entity* e: addList) {
         if (e) {
-            container->addEntity(e);
             undo.addUndoable(e);
         }
     }
@@ -3170,7 +3242,6 @@ static void update_exploded_children_recursively(
     }
 }
 
-
 /**
  * Removes the selected entity containers and adds the entities in them as
  * new single entities.
@@ -3195,10 +3266,21 @@ bool RS_Modification::explode(const std::vector<RS_Entity*> &entitiesList, const
     std::vector<RS_Entity*> clonesList;
 
     for(auto e: entitiesList){
-        if (e->isContainer()) {
+        RS_EntityContainer* ec = nullptr;
+        // inserts drawn as instances of their blocks have no entities,
+        // explode a copy resolved to entities of the block instead
+        std::unique_ptr<RS_Insert> resolved;
+        if (e->rtti() == RS2::EntityInsert) {
+            resolved = static_cast<RS_Insert*>(e)->createResolvedInstance();
+        }
+        if (resolved != nullptr) {
+            ec = resolved.get();
+        } else if (e->isContainer()) {
+            ec = (RS_EntityContainer*)e;
+        }
+        if (ec != nullptr) {
 
             // add entities from container:
-            auto* ec = (RS_EntityContainer*)e;
             //ec->setSelected(false);
 
             // iterate and explode container:
@@ -3211,6 +3293,10 @@ bool RS_Modification::explode(const std::vector<RS_Entity*> &entitiesList, const
             switch (ec->rtti()) {
                 case RS2::EntityMText:
                 case RS2::EntityText:
+                    rl = RS2::ResolveAll;
+                    resolveLayer = true;
+                    resolvePen = true;
+                    break;
                 case RS2::EntityHatch:
                 case RS2::EntityPolyline:
                     rl = RS2::ResolveAll;
@@ -3245,40 +3331,52 @@ bool RS_Modification::explode(const std::vector<RS_Entity*> &entitiesList, const
                     break;
             }
 
-            for (RS_Entity* e2 = ec->firstEntity(rl); e2;
-                 e2 = ec->nextEntity(rl)) {
+            bool isText = ec->rtti() == RS2::EntityText || ec->rtti() == RS2::EntityMText;
+            auto explodeEntity = [&](RS_Entity* e2) {
+                RS_Entity* clone = e2->clone();
+                clone->setSelected(false);
+                clone->reparent(container);
 
-                if (e2 != nullptr) {
-                    RS_Entity* clone = e2->clone();
-                    clone->setSelected(false);
-                    clone->reparent(container);
+                clonesList.push_back(clone);
 
-                    clonesList.push_back(clone);
-
-                    // In order to fix bug #819 and escape similar issues,
-                    // we have to update all children of exploded entity,
-                    // even those (below the tree) which are not direct
-                    // subjects to the current explode() call.
-                    update_exploded_children_recursively(ec, e2, clone,
-                                                         rl, resolveLayer, resolvePen);
+                // In order to fix bug #819 and escape similar issues,
+                // we have to update all children of exploded entity,
+                // even those (below the tree) which are not direct
+                // subjects to the current explode() call.
+                update_exploded_children_recursively(ec, e2, clone,
+                                                     rl, resolveLayer, resolvePen);
 /*
-                        if (resolveLayer) {
-                            clone->setLayer(ec->getLayer());
-                        } else {
-                            clone->setLayer(e2->getLayer());
-                        }
+                    if (resolveLayer) {
+                        clone->setLayer(ec->getLayer());
+                    } else {
+                        clone->setLayer(e2->getLayer());
+                    }
 
 //                        clone->setPen(ec->getPen(resolvePen));
-                        if (resolvePen) {
-                            clone->setPen(ec->getPen(true));
-                        } else {
-                            clone->setPen(e2->getPen(false));
-                        }
+                    if (resolvePen) {
+                        clone->setPen(ec->getPen(true));
+                    } else {
+                        clone->setPen(e2->getPen(false));
+                    }
 
 						addList.push_back(clone);
 
-                        clone->update();
+                    clone->update();
 */
+            };
+
+            for (RS_Entity* e2 = ec->firstEntity(rl); e2;
+                 e2 = ec->nextEntity(rl)) {
+
+                if (isText && e2->rtti() == RS2::EntityInsert && static_cast<RS_Insert*>(e2)->isInstance()) {
+                    // letters drawn from shared font glyphs have no entities,
+                    // explode copies resolved to entities of the letter blocks
+                    std::unique_ptr<RS_Insert> letter = static_cast<RS_Insert*>(e2)->createResolvedInstance();
+                    for (RS_Entity* e3 = letter->firstEntity(rl); e3; e3 = letter->nextEntity(rl)) {
+                        explodeEntity(e3);
+                    }
+                } else {
+                    explodeEntity(e2);
                 }
             }
         } else {
@@ -43,6 +43,7 @@ class RS_Document;
 class RS_Graphic;
 class RS_GraphicView;
 class LC_GraphicViewport;
+class QTransform;
 
 struct LC_ModifyOperationFlags{
     bool useCurrentAttributes = false;
@@ -402,6 +403,8 @@ protected:
                              bool forPreviewOnly, bool keepSelected) const;
 
     RS_Entity* getClone(bool forPreviewOnly, const RS_Entity* e) const;
+    bool isPreviewedTransformed(const std::vector<RS_Entity*>& entitiesList) const;
+    void previewTransformed(const std::vector<RS_Entity*>& entitiesList, const QTransform& wcsTransform) const;
 };
 
 #endif
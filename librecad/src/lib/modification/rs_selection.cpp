@@ -26,6 +26,7 @@
 #include "rs_selection.h"
 
 #include "lc_graphicviewport.h"
+#include "lc_looputils.h"
 #include "qc_applicationwindow.h"
 #include "qg_dialogfactory.h"
 #include "rs_dialogfactory.h"
@@ -69,7 +70,7 @@ void RS_Selection::selectSingle(RS_Entity *e){
             } else {
                 QG_DIALOGFACTORY->displayBlockName("", false);
             }
-            graphicView->notifyChanged();
+            graphicView->notifySelectionChanged();
         }
     }
 }
@@ -99,7 +100,7 @@ void RS_Selection::selectAll(bool select){
                 }*/
             }
         }
-        graphicView->notifyChanged();
+        graphicView->notifySelectionChanged();
     }
 }
 
@@ -113,7 +114,7 @@ void RS_Selection::invertSelection(){
         }
     }
 
-    graphicView->notifyChanged();
+    graphicView->notifySelectionChanged();
 }
 
 /**
@@ -127,14 +128,14 @@ void RS_Selection::selectWindow(
     enum RS2::EntityType typeToSelect, const RS_Vector &v1, const RS_Vector &v2,
     bool select, bool cross){
     container->selectWindow(typeToSelect, v1, v2, select, cross);
-    graphicView->notifyChanged();
+    graphicView->notifySelectionChanged();
 }
 
 void RS_Selection::selectWindow(const QList<RS2::EntityType> &typesToSelect, const RS_Vector &v1, const RS_Vector &v2,
     bool select, bool cross){
 
     container->selectWindow(typesToSelect, v1, v2, select, cross);
-    graphicView->notifyChanged();
+    graphicView->notifySelectionChanged();
 }
 
 /**
@@ -181,7 +182,7 @@ void RS_Selection::selectIntersected(const RS_Vector &v1, const RS_Vector &v2, b
             }
         }
     }
-    graphicView->notifyChanged();
+    graphicView->notifySelectionChanged();
 }
 
 /**
@@ -203,55 +204,50 @@ void RS_Selection::selectContour(RS_Entity *e){
     auto *ae = (RS_AtomicEntity *) e;
     RS_Vector p1 = ae->getStartpoint();
     RS_Vector p2 = ae->getEndpoint();
-    bool found = false;
 
     // (de)select 1st entity:
     e->setSelected(select);
 
-    do {// fixme - hm...iterating over all entities of drawing in cycle???? too nice for me...
-        found = false;
-        // fixme - iterating over all entities of drawing
-        for (auto en: *container) {
-
-            if (en && en->isVisible() &&
-                en->isAtomic() && en->isSelected() != select &&
-                (!(en->getLayer() && en->getLayer()->isLocked()))){
-
-                ae = (RS_AtomicEntity *) en;
-                bool doit = false;
-
-                // startpoint connects to 1st point
-                if (ae->getStartpoint().distanceTo(p1) < 1.0e-4){
-                    doit = true;
-                    p1 = ae->getEndpoint();
-                }
-
-                    // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p1) < 1.0e-4){
-                    doit = true;
-                    p1 = ae->getStartpoint();
-                }
-
-                    // startpoint connects to 2nd point
-                else if (ae->getStartpoint().distanceTo(p2) < 1.0e-4){
-                    doit = true;
-                    p2 = ae->getEndpoint();
-                }
-
-                    // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p2) < 1.0e-4){
-                    doit = true;
-                    p2 = ae->getStartpoint();
-                }
+    // end points of entities that may be (de)selected, so connected entities are found
+    // without iterating over all entities for each step
+    constexpr double tolerance = 1.0e-4;
+    std::vector<RS_AtomicEntity*> candidates;
+    LC_LoopUtils::EndpointHash endpoints{tolerance};
+    for (auto en: *container) {
+        if (en && en->isVisible() &&
+            en->isAtomic() && en->isSelected() != select &&
+            (!(en->getLayer() && en->getLayer()->isLocked()))){
+            ae = (RS_AtomicEntity *) en;
+            endpoints.insert(ae->getStartpoint(), candidates.size());
+            endpoints.insert(ae->getEndpoint(), candidates.size());
+            candidates.push_back(ae);
+        }
+    }
 
-                if (doit){
-                    ae->setSelected(select);
-                    found = true;
-                }
-            }
+    // (de)selects an entity connected to the point, and moves the point to the other end of the entity
+    auto selectConnected = [&candidates, &endpoints, select](RS_Vector& point) {
+        std::vector<size_t> connected = endpoints.find(point);
+        if (connected.empty()) {
+            return false;
         }
-    } while (found);
-    graphicView->notifyChanged();
+        const size_t id = connected.front();
+        RS_AtomicEntity *next = candidates[id];
+        RS_Vector start = next->getStartpoint();
+        RS_Vector end = next->getEndpoint();
+        endpoints.remove(start, id);
+        endpoints.remove(end, id);
+        next->setSelected(select);
+        point = start.distanceTo(point) < tolerance ? end : start;
+        return true;
+    };
+
+    // follow the contour from both end points of the entity
+    bool found = true;
+    while (found) {
+        found = selectConnected(p1);
+        found = selectConnected(p2) || found;
+    }
+    graphicView->notifySelectionChanged();
 }
 
 /**
@@ -287,5 +283,5 @@ void RS_Selection::selectLayer(const QString &layerName, bool select){
             }
         }
     }
-    graphicView->notifyChanged();
+    graphicView->notifySelectionChanged();
 }
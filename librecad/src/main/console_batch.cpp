@@ -0,0 +1,123 @@
+/******************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program.
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+******************************************************************************/
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <QtCore>
+
+#include "console_batch.h"
+#include "lc_parallel.h"
+
+namespace {
+void appendDxfFiles(const QString& path, QStringList& dxfFiles)
+{
+    QFileInfo fileInfo(path);
+    if (fileInfo.isDir()) {
+        QDir dir(path);
+        // name filters are case insensitive
+        const QStringList names = dir.entryList(QStringList() << "*.dxf", QDir::Files, QDir::Name);
+        for (const QString& name : names)
+            dxfFiles.append(dir.filePath(name));
+    } else if (fileInfo.suffix().toLower() == "dxf") {
+        dxfFiles.append(path);
+    }
+}
+
+struct ConversionResult {
+    QString outFile;
+    bool ok = false;
+    qint64 msecs = 0;
+};
+}
+
+QStringList LC_ConsoleBatch::collectDxfFiles(const QStringList& args, const QString& listFile)
+{
+    QStringList dxfFiles;
+    for (const QString& arg : args)
+        appendDxfFiles(arg, dxfFiles);
+
+    if (!listFile.isEmpty()) {
+        QFile file(listFile);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qDebug() << "ERROR: Cannot read list file" << listFile;
+            return dxfFiles;
+        }
+        QDir listDir = QFileInfo(listFile).absoluteDir();
+        QTextStream in(&file);
+        QString line;
+        while (in.readLineInto(&line)) {
+            line = line.trimmed();
+            if (line.isEmpty() || line.startsWith('#'))
+                continue;
+            appendDxfFiles(QDir::isRelativePath(line) ? listDir.filePath(line) : line, dxfFiles);
+        }
+    }
+    return dxfFiles;
+}
+
+std::mutex& LC_ConsoleBatch::sharedStateMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+int LC_ConsoleBatch::convert(const QStringList& dxfFiles, int jobs, const Conversion& conversion)
+{
+    size_t threads = jobs > 0 ? size_t(jobs) : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<ConversionResult> results(dxfFiles.size());
+    std::mutex reportMutex;
+
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+    LC_Parallel::forEachItem(results.size(), threads, [&](size_t index) {
+        const QString& dxfFile = dxfFiles.at(int(index));
+        ConversionResult& result = results[index];
+        QElapsedTimer timer;
+        timer.start();
+        result.ok = conversion(dxfFile, result.outFile);
+        result.msecs = timer.elapsed();
+
+        std::lock_guard<std::mutex> lock(reportMutex);
+        qDebug() << "Converted" << dxfFile << "to" << result.outFile
+                 << (result.ok ? "DONE" : "FAILED") << "in" << result.msecs << "ms";
+    });
+    qint64 totalMsecs = totalTimer.elapsed();
+
+    int failed = 0;
+    qint64 sumMsecs = 0;
+    for (int i = 0; i < dxfFiles.size(); ++i) {
+        const ConversionResult& result = results[i];
+        sumMsecs += result.msecs;
+        if (!result.ok) {
+            ++failed;
+            qDebug() << "FAILED:" << dxfFiles.at(i);
+        }
+    }
+    qDebug() << "Summary:" << dxfFiles.size() - failed << "of" << dxfFiles.size()
+             << "files converted in" << totalMsecs << "ms by" << std::min<size_t>(threads, results.size())
+             << "jobs, sum of file times" << sumMsecs << "ms";
+    return failed;
+}
@@ -0,0 +1,68 @@
+/******************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program.
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This file may be distributed and/or modified under the terms of the
+** GNU General Public License version 2 as published by the Free Software
+** Foundation and appearing in the file gpl-2.0.txt included in the
+** packaging of this file.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+******************************************************************************/
+#ifndef CONSOLE_BATCH_H
+#define CONSOLE_BATCH_H
+
+#include <functional>
+#include <mutex>
+
+#include <QStringList>
+
+/**
+ * Batch mode of the console converters (dxf2png, dxf2pdf): converts many
+ * drawings concurrently, each one by its own document, viewport and renderer.
+ */
+namespace LC_ConsoleBatch {
+    /**
+     * Converts a single drawing, sets the name of the produced file.
+     * @return true on success
+     */
+    using Conversion = std::function<bool(const QString& dxfFile, QString& outFile)>;
+
+    /**
+     * Collects input DXF files. Directories among the arguments are expanded to the
+     * DXF files they contain. The list file, if given, has one file or directory per
+     * line; relative paths are resolved against the directory of the list file.
+     */
+    QStringList collectDxfFiles(const QStringList& args, const QString& listFile);
+
+    /**
+     * Settings, font and pattern lists are not thread safe, so reading of documents
+     * and setup of viewports and renderers are serialized by this mutex. Reading can't
+     * be narrowed to the accesses of the shared state: the document and the DXF filter
+     * read settings through their shared group, and texts, inserts and hatches load
+     * fonts and patterns on demand, while the read entities are updated.
+     * So files are read one at a time, and only rendering runs concurrently.
+     */
+    std::mutex& sharedStateMutex();
+
+    /**
+     * Converts the files on the given number of worker threads (0 - number of cores).
+     * Time of each file and the summary are reported to the debug output.
+     * @return number of files failed to convert
+     */
+    int convert(const QStringList& dxfFiles, int jobs, const Conversion& conversion);
+}
+
+#endif // CONSOLE_BATCH_H
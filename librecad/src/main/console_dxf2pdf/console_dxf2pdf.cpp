@@ -35,6 +35,7 @@
 
 #include "main.h"
 
+#include "console_batch.h"
 #include "console_dxf2pdf.h"
 #include "pdf_print_loop.h"
 
@@ -76,6 +77,9 @@ int console_dxf2pdf(int argc, char* argv[])
     appDesc << "";
     appDesc << "  " + librecad + QObject::tr( " -o some.pdf *.dxf");
     appDesc << "    " + QObject::tr( "-- print all dxf files to 'some.pdf' file.");
+    appDesc << "";
+    appDesc << "  " + librecad + QObject::tr( " -j 8 -t pdf sheets/");
+    appDesc << "    " + QObject::tr( "-- print all dxf files of 'sheets' directory to pdf files in 'pdf' directory, 8 files at a time.");
     parser.setApplicationDescription( appDesc.join( "\n"));
 
     parser.addHelpOption();
@@ -125,13 +129,22 @@ int console_dxf2pdf(int argc, char* argv[])
         QObject::tr( "Target output directory."), "path");
     parser.addOption(outDirOpt);
 
-    parser.addPositionalArgument(QObject::tr( "<dxf_files>"), QObject::tr( "Input DXF file(s)"));
+    QCommandLineOption listFileOpt(QStringList() << "l" << "list",
+        QObject::tr( "Print DXF files and directories listed in the file, one per line."), "file");
+    parser.addOption(listFileOpt);
+
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        QObject::tr( "Number of files printed concurrently to separate PDF files (default: number of cores). "
+                     "Files are read one at a time, their printing runs concurrently."), "integer");
+    parser.addOption(jobsOpt);
+
+    parser.addPositionalArgument(QObject::tr( "<dxf_files>"), QObject::tr( "Input DXF file(s) or directories"));
 
     parser.process(app);
 
     const QStringList args = parser.positionalArguments();
 
-    if (args.isEmpty() || (args.size() == 1 && args[0] == "dxf2pdf"))
+    if ((args.isEmpty() || (args.size() == 1 && args[0] == "dxf2pdf")) && !parser.isSet(listFileOpt))
         parser.showHelp(EXIT_FAILURE);
 
     PdfPrintParams params;
@@ -155,15 +168,16 @@ int console_dxf2pdf(int argc, char* argv[])
     parseMarginsArg(parser.value(marginsOpt), params);
     parsePagesNumArg(parser.value(pagesNumOpt), params);
 
+    bool jobsOk;
+    int jobs = parser.value(jobsOpt).toInt(&jobsOk);
+    if (jobsOk)
+        params.jobs = jobs;
+
     params.outFile = parser.value(outFileOpt);
     params.outDir = parser.value(outDirOpt);
 
-    for (auto arg : args) {
-        QFileInfo dxfFileInfo(arg);
-        if (dxfFileInfo.suffix().toLower() != "dxf")
-            continue; // Skip files without .dxf extension
-        params.dxfFiles.append(arg);
-    }
+    // Skips files without .dxf extension, expands directories
+    params.dxfFiles = LC_ConsoleBatch::collectDxfFiles(args, parser.value(listFileOpt));
 
     if (params.dxfFiles.isEmpty())
         parser.showHelp(EXIT_FAILURE);
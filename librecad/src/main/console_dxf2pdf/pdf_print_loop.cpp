@@ -24,6 +24,7 @@
 
 #include <QtCore>
 
+#include "console_batch.h"
 #include "rs.h"
 #include "rs_graphic.h"
 #include "rs_painter.h"
@@ -35,14 +36,21 @@
 
 #include "lc_documentsstorage.h"
 static bool openDocAndSetGraphic(RS_Document**, RS_Graphic**, const QString&);
-static void touchGraphic(RS_Graphic*, PdfPrintParams&);
-static void setupPrinterAndPaper(RS_Graphic*, QPrinter&, PdfPrintParams&);
+static void touchGraphic(RS_Graphic*, const PdfPrintParams&);
+static void setupPrinterAndPaper(RS_Graphic*, QPrinter&, const PdfPrintParams&, const QString&);
 static void drawGraphic(RS_Graphic *graphic, QPrinter &printer, RS_Painter &painter);
 
 void PdfPrintLoop::run(){
     if (params.outFile.isEmpty()) {
-        for (auto &&f : params.dxfFiles) {
-            printOneDxfToOnePdf(f);
+        if (params.dxfFiles.size() == 1) {
+            QString outFile;
+            printOneDxfToOnePdf(params.dxfFiles.first(), outFile);
+        } else {
+            // every file is printed by its own document, viewport and printer
+            LC_ConsoleBatch::convert(params.dxfFiles, params.jobs,
+                [this](const QString& dxfFile, QString& outFile) {
+                    return printOneDxfToOnePdf(dxfFile, outFile);
+                });
         }
     } else {
         printManyDxfToOnePdf();
@@ -51,30 +59,34 @@ void PdfPrintLoop::run(){
 }
 
 
-void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) {
+bool PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile, QString& outFile) const {
 
     // Main code logic and flow for this method is originally stolen from
     // QC_ApplicationWindow::slotFilePrint(bool printPDF) method.
     // But finally it was split in to smaller parts.
 
     QFileInfo dxfFileInfo(dxfFile);
-    params.outFile =
+    outFile =
         (params.outDir.isEmpty() ? dxfFileInfo.path() : params.outDir)
         + "/" + dxfFileInfo.completeBaseName() + ".pdf";
 
     RS_Document *doc;
     RS_Graphic *graphic;
 
+    // may be called by worker threads, so reading of the file and the parts using
+    // settings and font lists are serialized (see LC_ConsoleBatch::sharedStateMutex())
+    std::unique_lock<std::mutex> lock(LC_ConsoleBatch::sharedStateMutex());
     if (!openDocAndSetGraphic(&doc, &graphic, dxfFile))
-        return;
+        return false;
 
-    qDebug() << "Printing" << dxfFile << "to" << params.outFile << ">>>>";
+    qDebug() << "Printing" << dxfFile << "to" << outFile << ">>>>";
 
     touchGraphic(graphic, params);
 
     QPrinter printer(QPrinter::HighResolution);
 
-    setupPrinterAndPaper(graphic, printer, params);
+    setupPrinterAndPaper(graphic, printer, params, outFile);
+    lock.unlock();
 
     RS_Painter painter(&printer);
 
@@ -85,9 +97,10 @@ void PdfPrintLoop::printOneDxfToOnePdf(const QString& dxfFile) {
 
     painter.end();
 
-    qDebug() << "Printing" << dxfFile << "to" << params.outFile << "DONE";
+    qDebug() << "Printing" << dxfFile << "to" << outFile << "DONE";
 
     delete doc;
+    return true;
 }
 
 
@@ -131,7 +144,7 @@ void PdfPrintLoop::printManyDxfToOnePdf() {
         // FIXME: Is it possible to set up printer and paper for every
         // opened dxf file and tie them with painter? For now just using
         // data extracted from the first opened dxf file for all pages.
-        setupPrinterAndPaper(contentItems.at(0).graphic, printer, params);
+        setupPrinterAndPaper(contentItems.at(0).graphic, printer, params, params.outFile);
     }
 
     RS_Painter painter(&printer);
@@ -183,7 +196,7 @@ static bool openDocAndSetGraphic(RS_Document** doc, RS_Graphic** graphic,
 }
 
 
-static void touchGraphic(RS_Graphic* graphic, PdfPrintParams& params){
+static void touchGraphic(RS_Graphic* graphic, const PdfPrintParams& params){
     graphic->calculateBorders();
     graphic->setMargins(params.margins.left, params.margins.top,
                         params.margins.right, params.margins.bottom);
@@ -206,7 +219,7 @@ static void touchGraphic(RS_Graphic* graphic, PdfPrintParams& params){
 }
 
 static void setupPrinterAndPaper(RS_Graphic* graphic, QPrinter& printer,
-    PdfPrintParams& params){
+    const PdfPrintParams& params, const QString& outFile){
     bool landscape = false;
 
     RS2::PaperFormat pf = graphic->getPaperFormat(&landscape);
@@ -233,7 +246,7 @@ static void setupPrinterAndPaper(RS_Graphic* graphic, QPrinter& printer,
     printer.setOrientation(landscape ? QPrinter::Landscape : QPrinter::Portrait);
 #endif
 
-    printer.setOutputFileName(params.outFile);
+    printer.setOutputFileName(outFile);
     printer.setOutputFormat(QPrinter::PdfFormat);
     printer.setResolution(params.resolution);
     printer.setFullPage(true);
@@ -265,8 +278,11 @@ static void drawGraphic(RS_Graphic* graphic, QPrinter& printer,
     viewport.setBorders(0,0,0,0);
 
     LC_PrintViewportRenderer renderer(&viewport, &painter);
-    viewport.loadSettings();
-    renderer.loadSettings();
+    {
+        std::lock_guard<std::mutex> lock(LC_ConsoleBatch::sharedStateMutex());
+        viewport.loadSettings();
+        renderer.loadSettings();
+    }
 
     RS2::Unit unit = graphic->getUnit();
     double fx = printerFx * RS_Units::getFactorToMM(unit);
@@ -33,6 +33,7 @@
 
 #include "main.h"
 
+#include "console_batch.h"
 #include "qc_applicationwindow.h"
 #include "qg_dialogfactory.h"
 
@@ -63,6 +64,8 @@ static void touchGraphic(RS_Graphic*);
 
 static QSize parsePngSizeArg(QString);
 
+static bool convertDxfFile(const QString& dxfFile, const QString& outFile, QSize pngSize);
+
 bool slotFileExport(RS_Graphic* graphic,
                     const QString& name,
                     const QString& format,
@@ -125,6 +128,8 @@ int console_dxf2png(int argc, char* argv[])
     appDesc += "Examples:\n\n";
     appDesc += "  " + librecad + " dxf2png *.dxf";
     appDesc += "    -- print a dxf file to a png file with the same name.\n";
+    appDesc += "  " + librecad + " dxf2png -j 8 -t png sheets/";
+    appDesc += "    -- print all dxf files of 'sheets' directory to png files in 'png' directory, 8 files at a time.\n";
     parser.setApplicationDescription(appDesc);
 
     parser.addHelpOption();
@@ -138,76 +143,114 @@ int console_dxf2png(int argc, char* argv[])
         "Output PNG size (Width x Height) in pixels.", "WxH");
     parser.addOption(pngSizeOpt);
 
-    parser.addPositionalArgument("<dxf_files>", "Input DXF file");
+    QCommandLineOption outDirOpt(QStringList() << "t" << "directory",
+        "Target output directory for batch conversion.", "path");
+    parser.addOption(outDirOpt);
+
+    QCommandLineOption listFileOpt(QStringList() << "l" << "list",
+        "Batch conversion of DXF files and directories listed in the file, one per line.", "file");
+    parser.addOption(listFileOpt);
+
+    QCommandLineOption jobsOpt(QStringList() << "j" << "jobs",
+        "Number of files converted concurrently in batch mode (default: number of cores). "
+        "Files are read one at a time, their rendering runs concurrently.", "integer");
+    parser.addOption(jobsOpt);
+
+    parser.addPositionalArgument("<dxf_files>", "Input DXF file(s) or directories");
 
     parser.process(app);
 
     const QStringList args = parser.positionalArguments();
 
-    if (args.isEmpty() || (args.size() == 1 && (args[0] == "dxf2png" || args[0] == "dxf2svg")))
+    if ((args.isEmpty() || (args.size() == 1 && (args[0] == "dxf2png" || args[0] == "dxf2svg")))
+        && !parser.isSet(listFileOpt))
         parser.showHelp(EXIT_FAILURE);
     // Set PNG size from user input
     QSize pngSize = parsePngSizeArg(parser.value(pngSizeOpt)); // If nothing, use default values.
 
-    QStringList dxfFiles;
+    // output extension is defined by the program name: dxf2png or dxf2svg
+    QString program = allowed.count(prgInfo.baseName()) != 0 ? prgInfo.baseName() : args.value(0);
+    QString extension = program == "dxf2svg" ? "svg" : "png";
 
-    for (auto arg : args) {
-        QFileInfo dxfFileInfo(arg);
-        if (dxfFileInfo.suffix().toLower() != "dxf")
-            continue; // Skip files without .dxf extension
-        dxfFiles.append(arg);
-    }
+    QStringList dxfFiles = LC_ConsoleBatch::collectDxfFiles(args, parser.value(listFileOpt));
 
     if (dxfFiles.isEmpty())
         parser.showHelp(EXIT_FAILURE);
 
-    // Output setup
+    QString outDir = parser.value(outDirOpt);
+    bool batch = dxfFiles.size() > 1 || parser.isSet(listFileOpt) || !outDir.isEmpty();
+    if (!batch) {
+        // Output setup
 
-    QString& dxfFile = dxfFiles[0];
+        QString& dxfFile = dxfFiles[0];
 
-    QFileInfo dxfFileInfo(dxfFile);
-    QString fn = dxfFileInfo.completeBaseName(); // original DXF file name
-    if(fn.isEmpty())
-        fn = "unnamed";
+        QFileInfo dxfFileInfo(dxfFile);
+        QString fn = dxfFileInfo.completeBaseName(); // original DXF file name
+        if(fn.isEmpty())
+            fn = "unnamed";
 
-    // Set output filename from user input if present
-    QString outFile = parser.value(outFileOpt);
-    if (outFile.isEmpty()) {
-        outFile = dxfFileInfo.path() + "/" + fn + "." + args[0].mid(args[0].size()-3);
-    } else {
-        outFile = dxfFileInfo.path() + "/" + outFile;
+        // Set output filename from user input if present
+        QString outFile = parser.value(outFileOpt);
+        if (outFile.isEmpty()) {
+            outFile = dxfFileInfo.path() + "/" + fn + "." + extension;
+        } else {
+            outFile = dxfFileInfo.path() + "/" + outFile;
+        }
+
+        return convertDxfFile(dxfFile, outFile, pngSize) ? 0 : 1;
     }
 
-    // Open the file and process the graphics
+    if (!outDir.isEmpty() && !QDir().mkpath(outDir)) {
+        qDebug() << "ERROR: Cannot create directory" << outDir;
+        return EXIT_FAILURE;
+    }
 
-    std::unique_ptr<RS_Document> doc = openDocAndSetGraphic(dxfFile);
+    bool jobsOk = false;
+    int jobs = parser.value(jobsOpt).toInt(&jobsOk);
+    int failed = LC_ConsoleBatch::convert(dxfFiles, jobsOk ? jobs : 0,
+        [&outDir, &extension, pngSize](const QString& dxfFile, QString& outFile) {
+            QFileInfo dxfFileInfo(dxfFile);
+            QString fn = dxfFileInfo.completeBaseName();
+            if (fn.isEmpty())
+                fn = "unnamed";
+            outFile = (outDir.isEmpty() ? dxfFileInfo.path() : outDir) + "/" + fn + "." + extension;
+            return convertDxfFile(dxfFile, outFile, pngSize);
+        });
+    return failed == 0 ? 0 : 1;
+}
 
-    if (doc == nullptr || doc->getGraphic() == nullptr)
-        return 1;
-    RS_Graphic *graphic = doc->getGraphic();
+/**
+ * Converts a single DXF file to the image file, may be called from worker threads
+ * of the batch mode.
+ */
+static bool convertDxfFile(const QString& dxfFile, const QString& outFile, QSize pngSize)
+{
+    // find out extension:
+    QString format = getFormatFromFile(outFile).toUpper();
+
+    // Open the file and process the graphics
+    std::unique_ptr<RS_Document> doc;
+    {
+        // files are read one at a time, see LC_ConsoleBatch::sharedStateMutex()
+        std::lock_guard<std::mutex> lock(LC_ConsoleBatch::sharedStateMutex());
+        doc = openDocAndSetGraphic(dxfFile);
+        if (doc == nullptr || doc->getGraphic() == nullptr)
+            return false;
 
-    LC_LOG << "Printing" << dxfFile << "to" << outFile << ">>>>";
+        LC_LOG << "Printing" << dxfFile << "to" << outFile << ">>>>";
 
-    touchGraphic(graphic);
+        touchGraphic(doc->getGraphic());
+    }
+    RS_Graphic *graphic = doc->getGraphic();
 
     // Start of the actual conversion
 
     LC_LOG<< "QC_ApplicationWindow::slotFileExport()";
 
-    // read default settings:
-    LC_GROUP_GUARD("Export"); // fixme settings
-    QString defDir = dxfFileInfo.path();
-
-    // find out extension:
-    QString format = getFormatFromFile(outFile).toUpper();
-
-    // append extension to file:
-    if (!QFileInfo(fn).fileName().contains(".")) {
-        fn.push_back("." + format.toLower());
-    }
-
     bool ret = false;
     if (format.compare("SVG", Qt::CaseInsensitive) == 0) {
+        // the svg generator reads settings
+        std::lock_guard<std::mutex> lock(LC_ConsoleBatch::sharedStateMutex());
         ret = LC_ActionFileExportMakerCam::writeSvg(outFile, *graphic);
     } else {
         QSize borders = QSize(5, 5);
@@ -218,7 +261,7 @@ int console_dxf2png(int argc, char* argv[])
     }
 
     qDebug() << "Printing" << dxfFile << "to" << outFile << (ret ? "Done" : "Failed");
-    return 0;
+    return ret;
 }
 
 
@@ -273,11 +316,10 @@ bool slotFileExport(RS_Graphic* graphic, const QString& name,
         return false;
     }
 
-    QApplication::setOverrideCursor( QCursor(Qt::WaitCursor) );
-
     bool ret = false;
     // set vars for normal pictures and vectors (svg)
-    QPixmap* picture = new QPixmap(size);
+    // QImage, as pixmaps can't be used outside of the gui thread by the batch mode
+    QImage* picture = new QImage(size, QImage::Format_RGB32);
 
     QSvgGenerator* vector = new QSvgGenerator();
 
@@ -316,12 +358,13 @@ bool slotFileExport(RS_Graphic* graphic, const QString& name,
     viewport.setBorders(borders.width(), borders.height(), borders.width(), borders.height());
 
     viewport.setContainer(graphic);
-    viewport.loadSettings();
-    viewport.zoomAuto(false);
-
-
     LC_PrintViewportRenderer renderer(&viewport, &painter);
-    renderer.loadSettings();
+    {
+        std::lock_guard<std::mutex> lock(LC_ConsoleBatch::sharedStateMutex());
+        viewport.loadSettings();
+        renderer.loadSettings();
+    }
+    viewport.zoomAuto(false);
 
     if (black) {
         renderer.setBackground(Qt::black);
@@ -336,17 +379,15 @@ bool slotFileExport(RS_Graphic* graphic, const QString& name,
     {
         // RVT_PORT QImageIO iio;
         QImageWriter iio;
-        QImage img = picture->toImage();
         // RVT_PORT iio.setImage(img);
         iio.setFileName(name);
         iio.setFormat(format.toLatin1());
         // RVT_PORT if (iio.write()) {
-        if (iio.write(img)) {
+        if (iio.write(*picture)) {
             ret = true;
         }
 //        QString error=iio.errorString();
     }
-    QApplication::restoreOverrideCursor();
 
     // GraphicView deletes painter
     painter.end();
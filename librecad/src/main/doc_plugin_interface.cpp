@@ -24,6 +24,8 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+
 #include <QEventLoop>
 #include <QFileInfo>
 #include <QInputDialog>
@@ -35,6 +37,7 @@
 #include "intern/qc_actiongetselect.h"
 #include "lc_actioncontext.h"
 #include "lc_documentsstorage.h"
+#include "lc_pointcloud.h"
 #include "lc_splinepoints.h"
 #include "lc_undosection.h"
 #include "qc_applicationwindow.h"
@@ -921,29 +924,103 @@ void Doc_plugin_interface::addEllipse(QPointF *start, QPointF *end, qreal ratio,
 void Doc_plugin_interface::addLines(std::vector<QPointF> const& points, bool closed)
 {
     if (doc) {
+        if (points.empty())
+            return;
+        std::vector<RS_Entity*> lines;
+        lines.reserve(points.size());
         RS_LineData data;
-
-        LC_UndoSection undo(doc, gView->getViewPort());
         data.endpoint=RS_Vector(points.front().x(), points.front().y());
 
         for(size_t i=1; i<points.size(); ++i){
             data.startpoint=data.endpoint;
             data.endpoint=RS_Vector(points[i].x(), points[i].y());
-            auto* line=new RS_Line(doc, data);
-            doc->addEntity(line);
-            undo.addUndoable(line);
+            lines.push_back(new RS_Line(doc, data));
         }
         if(closed){
             data.startpoint=data.endpoint;
             data.endpoint=RS_Vector(points.front().x(), points.front().y());
-            auto* line=new RS_Line(doc, data);
-            doc->addEntity(line);
-            undo.addUndoable(line);
+            lines.push_back(new RS_Line(doc, data));
+        }
+        addEntities(lines);
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::addPoints(std::vector<QPointF> const& points)
+{
+    if (doc) {
+        std::vector<RS_Entity*> entities;
+        entities.reserve(points.size());
+        for (const QPointF& point: points) {
+            entities.push_back(new RS_Point(doc, RS_PointData(RS_Vector(point.x(), point.y()))));
+        }
+        addEntities(entities);
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::addPointCloud(std::vector<QPointF> const& points)
+{
+    if (doc) {
+        if (points.empty())
+            return;
+        LC_PointCloudData data;
+        data.reserve(points.size());
+        for (const QPointF& point: points) {
+            data.append(point.x(), point.y());
+        }
+        addEntities({new LC_PointCloud(doc, std::move(data))});
+    } else
+		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
+}
+
+void Doc_plugin_interface::addTexts(QStringList const& txts, QString sty, std::vector<QPointF> const& starts,
+            double height, double angle, DPI::HAlign ha,  DPI::VAlign va)
+{
+    if (doc) {
+        double width = 1.0;
+        RS_TextData::VAlign valign = static_cast <RS_TextData::VAlign>(va);
+        RS_TextData::HAlign halign = static_cast <RS_TextData::HAlign>(ha);
+        size_t count = std::min(starts.size(), static_cast<size_t>(txts.size()));
+
+        std::vector<RS_Entity*> entities;
+        entities.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            RS_Vector v1(starts[i].x(), starts[i].y());
+            RS_TextData d(v1, v1, height, width, valign, halign,
+                      RS_TextData::None, txts.at(static_cast<int>(i)), sty, angle, RS2::Update);
+            entities.push_back(new RS_Text(doc, d));
         }
+        addEntities(entities);
     } else
 		RS_DEBUG->print("%s: currentContainer is nullptr", __func__);
 }
 
+void Doc_plugin_interface::addEntities(std::vector<RS_Entity*> const& entities)
+{
+    LC_UndoSection undo(doc, gView->getViewPort());
+    // borders are extended by each entity, instead of being recalculated for the whole document,
+    // and the spatial index is rebuilt on demand for large batches
+    doc->addEntities(entities);
+    for (RS_Entity* entity: entities) {
+        undo.addUndoable(entity);
+    }
+}
+
+void Doc_plugin_interface::startUndoCycle()
+{
+    if (doc && m_undoCycleDepth++ == 0) {
+        doc->startUndoCycle();
+    }
+}
+
+void Doc_plugin_interface::endUndoCycle()
+{
+    if (doc && m_undoCycleDepth > 0 && --m_undoCycleDepth == 0) {
+        doc->endUndoCycle();
+    }
+}
+
 void Doc_plugin_interface::addPolyline(std::vector<Plug_VertexData> const& points, bool closed)
 {
     if (doc) {
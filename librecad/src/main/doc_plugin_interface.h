@@ -89,6 +89,12 @@ public:
     void addArc(QPointF *start, qreal radius, qreal a1, qreal a2) override;
     void addEllipse(QPointF *start, QPointF *end, qreal ratio, qreal a1, qreal a2) override;
      void addLines(std::vector<QPointF> const& points, bool closed=false) override;
+     void addPoints(std::vector<QPointF> const& points) override;
+     void addTexts(QStringList const& txts, QString sty, std::vector<QPointF> const& starts,
+                   double height, double angle, DPI::HAlign ha,  DPI::VAlign va) override;
+     void startUndoCycle() override;
+     void endUndoCycle() override;
+     void addPointCloud(std::vector<QPointF> const& points) override;
      void addPolyline(std::vector<Plug_VertexData> const& points, bool closed=false) override;
      void addSplinePoints(std::vector<QPointF> const& points, bool closed=false) override;
     void addImage(int handle, QPointF *start, QPointF *uvr, QPointF *vvr,
@@ -132,11 +138,16 @@ public:
     //method to handle undo in Plugin_Entity 
     bool addToUndo(RS_Entity* current, RS_Entity* modified, DPI::Disposition how);
 private:
+    //adds entities to the document as a single undo cycle, borders are extended by the entities
+    void addEntities(std::vector<RS_Entity*> const& entities);
+
     RS_Document *doc;
     RS_Graphic *docGr;
     RS_GraphicView *gView;
     QWidget* main_window;
     LC_ActionContext* m_actionContext;
+    //! nesting level of startUndoCycle() calls
+    int m_undoCycleDepth = 0;
 };
 
 /*void addArc(QPointF *start);			->Without start
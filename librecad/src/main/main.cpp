@@ -46,6 +46,7 @@
 #include <QDir>
 
 #include "lc_iconcolorsoptions.h"
+#include "lc_simpletests.h"
 #include "qc_applicationwindow.h"
 #include "qg_dlginitial.h"
 #include "rs_debug.h"
@@ -252,6 +253,9 @@ int main(int argc, char** argv) {
         if (arg.compare("dxf2png") == 0 || arg == "dxf2svg") {
             return console_dxf2png(argc, argv);
         }
+        if (arg == "simpletests") {
+            return console_simpletests(argc, argv);
+        }
     }
 
     RS_DEBUG->setLevel(RS_Debug::D_WARNING);
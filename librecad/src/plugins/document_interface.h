@@ -526,6 +526,45 @@ public:
     * \return a string with the converted number.
     */
     virtual QString realToStr(const qreal num, const int units = 0, const int prec = 0) = 0;
+
+    //! Add many point entities to current document.
+    /*! Add point entities to current document with current attributes, as a single
+    *  undo cycle. Use it instead of addPoint() to import large point sets.
+    *  \param points point coordinates.
+    */
+    virtual void addPoints(std::vector<QPointF> const& points) = 0;
+
+    //! Add many text entities to current document.
+    /*! Add text entities to current document with current attributes, as a single
+    *  undo cycle. Use it instead of addText() to import large sets of labels.
+    *  \param txts text content of each entity
+    *  \param sty a QString with text style name
+    *  \param starts insertion point coordinates, one per text
+    *  \param height height of texts
+    *  \param angle rotation angle of texts
+    *  \param ha horizontal alignment of texts
+    *  \param va vertical alignment of texts
+    */
+    virtual void addTexts(QStringList const& txts, QString sty, std::vector<QPointF> const& starts,
+                double height, double angle, DPI::HAlign ha,  DPI::VAlign va) = 0;
+
+    //! Start an undo cycle for the following changes of current document.
+    /*! Entities added until the matching endUndoCycle() are undone together. Use it
+    *  around imports calling addPoints(), addTexts() or addLines() several times.
+    *  Calls may be nested, only the outermost pair opens and closes the cycle.
+    */
+    virtual void startUndoCycle() = 0;
+
+    //! End the undo cycle started by startUndoCycle().
+    virtual void endUndoCycle() = 0;
+
+    //! Add a point cloud entity to current document.
+    /*! Add the points to current document with current attributes, as a single point
+    *  cloud entity. It takes much less memory than one point entity per point, but the
+    *  points can't be selected or edited one by one. Use addPoints() for that.
+    *  \param points point coordinates.
+    */
+    virtual void addPointCloud(std::vector<QPointF> const& points) = 0;
 };
 
 
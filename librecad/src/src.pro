@@ -246,6 +246,7 @@ INCLUDEPATH += \
     ui/dock_widgets/library_widget \
     ui/dock_widgets/pen_palette \
     ui/dock_widgets/pen_wizard \
+    ui/dock_widgets/render_profiler \
     ui/dock_widgets/views_list \
     ui/dock_widgets/ucs_list \
     ui/dock_widgets/workspaces \
@@ -333,6 +334,7 @@ HEADERS += \
     lib/engine/document/views/lc_view.h \
     lib/engine/document/views/lc_viewslist.h \
     lib/engine/document/entities/lc_cachedlengthentity.h \
+    lib/engine/document/entities/lc_entitypool.h \
     lib/engine/overlays/crosshair/lc_crosshair.h \
     lib/engine/document/container/lc_looputils.h \
     lib/engine/document/entities/lc_parabola.h \
@@ -348,6 +350,7 @@ HEADERS += \
     lib/engine/rs.h \
     lib/engine/document/entities/rs_arc.h \
     lib/engine/document/entities/rs_atomicentity.h \
+    lib/engine/document/blocks/lc_blockgeometry.h \
     lib/engine/document/blocks/rs_block.h \
     lib/engine/document/blocks/rs_blocklist.h \
     lib/engine/document/blocks/rs_blocklistlistener.h \
@@ -395,6 +398,7 @@ HEADERS += \
     lib/engine/settings/rs_settings.h \
     lib/engine/document/entities/rs_solid.h \
     lib/engine/document/entities/rs_spline.h \
+    lib/engine/document/entities/lc_pointcloud.h \
     lib/engine/document/entities/lc_splinepoints.h \
     lib/engine/rs_system.h \
     lib/engine/document/entities/rs_text.h \
@@ -423,6 +427,7 @@ HEADERS += \
     lib/gui/lc_graphicviewportlistener.h \
     lib/gui/render/headless/lc_printviewportrenderer.h \
     lib/gui/render/lc_graphicviewportrenderer.h \
+    lib/gui/render/lc_renderprofiler.h \
     plugins/lc_plugininvoker.h \
     lib/actions/lc_actioncontext.h \
     ui/components/creators/lc_creatorinvoker.h \
@@ -514,12 +519,14 @@ HEADERS += \
     lib/math/rs_math.h \
     lib/math/lc_quadratic.h \
     main/console_dxf2png.h \
+    main/console_batch.h \
     test/lc_simpletests.h \
     lib/generators/makercamsvg/lc_makercamsvg.h \
     lib/generators/makercamsvg/lc_xmlwriterinterface.h \
     lib/generators/makercamsvg/lc_xmlwriterqxmlstreamwriter.h \
     lib/engine/document/entities/lc_rect.h \
     lib/engine/utils/lc_rtree.h \
+    lib/engine/utils/lc_parallel.h \
     lib/engine/undo/lc_undosection.h \
     lib/printing/lc_printing.h \
     main/lc_application.h \
@@ -605,6 +612,7 @@ SOURCES += \
     ui/main/lc_defaultactioncontext.cpp \
     ui/main/persistence/lc_documentsstorage.cpp \
     lib/gui/render/lc_graphicviewportrenderer.cpp \
+    lib/gui/render/lc_renderprofiler.cpp \
     lib/gui/render/widget/lc_graphicviewrenderer.cpp \
     lib/gui/render/widget/lc_printpreviewviewrenderer.cpp \
     lib/gui/render/widget/lc_widgetviewportrenderer.cpp \
@@ -636,6 +644,7 @@ SOURCES += \
     lib/engine/document/views/lc_view.cpp \
     lib/engine/document/views/lc_viewslist.cpp \
     lib/engine/document/entities/lc_cachedlengthentity.cpp \
+    lib/engine/document/entities/lc_entitypool.cpp \
     lib/engine/overlays/crosshair/lc_crosshair.cpp \
     lib/engine/document/container/lc_looputils.cpp \
     lib/engine/document/entities/lc_parabola.cpp \
@@ -645,6 +654,7 @@ SOURCES += \
     lib/engine/overlays/references/lc_refline.cpp \
     lib/engine/overlays/references/lc_refpoint.cpp \
     lib/engine/document/entities/rs_arc.cpp \
+    lib/engine/document/blocks/lc_blockgeometry.cpp \
     lib/engine/document/blocks/rs_block.cpp \
     lib/engine/document/blocks/rs_blocklist.cpp \
     lib/engine/clipboard/rs_clipboard.cpp \
@@ -685,6 +695,7 @@ SOURCES += \
     lib/engine/settings/rs_settings.cpp \
     lib/engine/document/entities/rs_solid.cpp \
     lib/engine/document/entities/rs_spline.cpp \
+    lib/engine/document/entities/lc_pointcloud.cpp \
     lib/engine/document/entities/lc_splinepoints.cpp \
     lib/engine/rs_system.cpp \
     lib/engine/document/entities/rs_text.cpp \
@@ -755,6 +766,7 @@ SOURCES += \
     lib/engine/rs_color.cpp \
     lib/engine/rs_pen.cpp \
     main/console_dxf2png.cpp \
+    main/console_batch.cpp \
     test/lc_simpletests.cpp \
     lib/generators/makercamsvg/lc_xmlwriterqxmlstreamwriter.cpp \
     lib/generators/makercamsvg/lc_makercamsvg.cpp \
@@ -763,6 +775,7 @@ SOURCES += \
     lib/engine/rs_flags.cpp \
     lib/engine/document/entities/lc_rect.cpp \
     lib/engine/utils/lc_rtree.cpp \
+    lib/engine/utils/lc_parallel.cpp \
     lib/engine/undo/lc_undosection.cpp \
     lib/engine/rs.cpp \
     lib/printing/lc_printing.cpp \
@@ -1276,6 +1289,7 @@ HEADERS += ui/action_options/lc_actionoptionsmanager.h \
     ui/dock_widgets/pen_wizard/colorcombobox.h \
     ui/dock_widgets/pen_wizard/colorwizard.h \
     ui/dock_widgets/pen_wizard/lc_penwizard.h \
+    ui/dock_widgets/render_profiler/lc_renderprofilerwidget.h \
     ui/main/init/lc_actionfactory.h \
     ui/main/init/lc_widgetfactory.h \
     ui/main/init/lc_menufactory.h \
@@ -1465,6 +1479,7 @@ SOURCES +=ui/action_options/lc_actionoptionsmanager.cpp \
     ui/dock_widgets/pen_wizard/colorcombobox.cpp \
     ui/dock_widgets/pen_wizard/colorwizard.cpp \
     ui/dock_widgets/pen_wizard/lc_penwizard.cpp \
+    ui/dock_widgets/render_profiler/lc_renderprofilerwidget.cpp \
     ui/main/init/lc_actionfactory.cpp \
     ui/main/init/lc_widgetfactory.cpp \
     ui/main/init/lc_menufactory.cpp \
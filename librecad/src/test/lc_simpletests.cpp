@@ -1,8 +1,22 @@
 #include <iostream>
 #include <cmath>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QMenuBar>
+#include <QMessageBox>
+#include "intern/drw_cptable936.h"
+#include "intern/drw_textcodec.h"
+#include "lc_entitypool.h"
+#include "lc_quadratic.h"
 #include "lc_simpletests.h"
+#include "main.h"
 #include "qc_applicationwindow.h"
 #include "rs_graphic.h"
 #include "rs_math.h"
@@ -26,6 +40,10 @@
 #include "rs_layer.h"
 #include "rs_graphicview.h"
 #include "rs_debug.h"
+#include "rs_filterdxfrw.h"
+#include "rs_information.h"
+#include "rs_settings.h"
+#include "rs_system.h"
 
 LC_SimpleTests::LC_SimpleTests(QWidget *parent):
 	QObject(parent)
@@ -109,6 +127,36 @@ LC_SimpleTests::LC_SimpleTests(QWidget *parent):
 		connect(action, SIGNAL(triggered()),
 				this, SLOT(slotTestResize1024()));
 		testMenu->addAction(action);
+
+		action = new QAction("DXF Read Throughput", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestReadDxfThroughput()));
+		testMenu->addAction(action);
+
+		action = new QAction("Entity Memory Statistics", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestEntityMemoryStatistics()));
+		testMenu->addAction(action);
+
+		action = new QAction("Bulk Entity Add/Remove", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestBulkAddRemove()));
+		testMenu->addAction(action);
+
+		action = new QAction("Conic Intersections", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestConicIntersections()));
+		testMenu->addAction(action);
+
+		action = new QAction("DBCS Text Codec", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestDbcsCodec()));
+		testMenu->addAction(action);
+
+		action = new QAction("DWG Concurrent Decoding", this);
+		connect(action, SIGNAL(triggered()),
+				this, SLOT(slotTestDwgConcurrentDecoding()));
+		testMenu->addAction(action);
 }
 
 /**
@@ -1103,3 +1151,453 @@ void LC_SimpleTests::slotTestResize1024() {
 	QC_ApplicationWindow::getAppWindow()->update();
 	RS_DEBUG->print("%s\n: end\n", __func__);
 }
+
+/**
+ * Testing function. Scales up an ascii dxf file (e.g. screw2012ascii.DXF of libdxfrw)
+ * by repeating the records of its ENTITIES section, and reads it.
+ */
+void LC_SimpleTests::slotTestReadDxfThroughput() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+	QString fileName = QFileDialog::getOpenFileName(nullptr, "DXF Read Throughput", QString(),
+													"Drawing Exchange DXF (*.dxf *.DXF)");
+	if (fileName.isEmpty()) {
+		return;
+	}
+	QString report;
+	testReadDxfThroughput(fileName, report);
+	RS_DEBUG->print("%s: %s\n", __func__, report.toLatin1().data());
+	QMessageBox::information(nullptr, "DXF Read Throughput", report);
+}
+
+bool LC_SimpleTests::testReadDxfThroughput(const QString& fileName, QString& report) {
+	const int copies = 100;
+	QFile source(fileName);
+	if (!source.open(QIODevice::ReadOnly)) {
+		report = "Cannot open " + fileName;
+		return false;
+	}
+	QByteArray data = source.readAll();
+	int sectionStart = data.indexOf("\nENTITIES");
+	sectionStart = (sectionStart >= 0) ? data.indexOf('\n', sectionStart + 1) + 1 : -1;
+	int sectionEnd = (sectionStart > 0) ? data.indexOf("\nENDSEC", sectionStart) : -1;
+	// start of the group code line of ENDSEC
+	sectionEnd = (sectionEnd > 0) ? data.lastIndexOf('\n', sectionEnd - 1) + 1 : -1;
+	if (sectionStart <= 0 || sectionEnd < sectionStart) {
+		report = "No ENTITIES section found in " + fileName;
+		return false;
+	}
+	QByteArray scaled = data.left(sectionStart)
+						+ data.mid(sectionStart, sectionEnd - sectionStart).repeated(copies)
+						+ data.mid(sectionEnd);
+
+	QString scaledName = QDir::temp().filePath("lc_read_throughput.dxf");
+	QFile scaledFile(scaledName);
+	if (!scaledFile.open(QIODevice::WriteOnly) || scaledFile.write(scaled) != scaled.size()) {
+		report = "Cannot write " + scaledName;
+		return false;
+	}
+	scaledFile.close();
+
+	RS_Graphic graphic;
+	RS_FilterDXFRW filter;
+	QElapsedTimer timer;
+	timer.start();
+	bool ok = filter.fileImport(graphic, scaledName, RS2::FormatDXFRW);
+	double seconds = timer.nsecsElapsed() * 1e-9;
+	QFile::remove(scaledName);
+
+	double megabytes = scaled.size() / (1024. * 1024.);
+	report = QString("%1: %2 MB, %3 entities, read in %4 s, %5 MB/s")
+				 .arg(ok ? "OK" : "Failed")
+				 .arg(megabytes, 0, 'f', 1)
+				 .arg(graphic.count())
+				 .arg(seconds, 0, 'f', 3)
+				 .arg(megabytes / std::max(seconds, 1e-9), 0, 'f', 1);
+	return ok && graphic.count() > 0;
+}
+
+void LC_SimpleTests::slotTestEntityMemoryStatistics() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+	QString report;
+	testEntityMemoryStatistics(report);
+	RS_DEBUG->print("%s: %s\n", __func__, report.toLatin1().data());
+	QMessageBox::information(nullptr, "Entity Memory Statistics", report);
+}
+
+bool LC_SimpleTests::testEntityMemoryStatistics(QString& report) {
+	for (const LC_EntityPool::Statistics& stats : LC_EntityPool::getAllStatistics()) {
+		double bytesPerEntity = stats.liveObjects > 0
+									? double(stats.reservedBytes) / stats.liveObjects
+									: 0.;
+		report += QString("%1: %2 bytes/object, %3 live (peak %4), %5 KB reserved, "
+						  "%6 bytes/entity, %7 derived on heap\n")
+					  .arg(stats.typeName)
+					  .arg(stats.objectSize)
+					  .arg(stats.liveObjects)
+					  .arg(stats.peakObjects)
+					  .arg(stats.reservedBytes / 1024.0, 0, 'f', 1)
+					  .arg(bytesPerEntity, 0, 'f', 1)
+					  .arg(stats.heapAllocations);
+	}
+	return true;
+}
+
+void LC_SimpleTests::slotTestBulkAddRemove() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+	QString report;
+	testBulkAddRemove(report);
+	RS_DEBUG->print("%s: %s\n", __func__, report.toLatin1().data());
+	QMessageBox::information(nullptr, "Bulk Entity Add/Remove", report);
+}
+
+bool LC_SimpleTests::testBulkAddRemove(QString& report) {
+	bool ok = true;
+	// removal of every second entity, by batch and, for small sizes, one by one
+	for (int size = 12500; size <= 200000; size *= 2) {
+		RS_EntityContainer container(nullptr, true);
+		std::vector<RS_Entity*> lines;
+		lines.reserve(size);
+		for (int i = 0; i < size; ++i) {
+			RS_Vector start(i % 1000, i / 1000);
+			lines.push_back(new RS_Line(&container, start, start + RS_Vector(0.5, 0.5)));
+		}
+		QElapsedTimer timer;
+		timer.start();
+		container.addEntities(lines);
+		double addSeconds = timer.nsecsElapsed() * 1e-9;
+
+		std::vector<RS_Entity*> toRemove;
+		for (int i = 0; i < size; i += 2) {
+			toRemove.push_back(lines[i]);
+		}
+		timer.restart();
+		int removed = container.removeEntities(toRemove);
+		double removeSeconds = timer.nsecsElapsed() * 1e-9;
+		ok = ok && removed == int(toRemove.size()) && container.count() == unsigned(size - removed);
+
+		QString single = "-";
+		if (size <= 25000) {
+			std::vector<RS_Entity*> rest(container.begin(), container.end());
+			timer.restart();
+			for (RS_Entity* e : rest) {
+				container.removeEntity(e);
+			}
+			ok = ok && container.count() == 0;
+			single = QString::number(timer.nsecsElapsed() * 1e-9, 'f', 3) + " s";
+		}
+		report += QString("%1 entities: add %2 s, remove %3 in %4 s (%5 us/entity), one by one %6\n")
+					  .arg(size)
+					  .arg(addSeconds, 0, 'f', 3)
+					  .arg(removed)
+					  .arg(removeSeconds, 0, 'f', 3)
+					  .arg(removeSeconds * 1e6 / std::max(removed, 1), 0, 'f', 3)
+					  .arg(single);
+	}
+	return ok;
+}
+
+/**
+ * Testing function. Times intersections of random circle, arc and ellipse pairs,
+ * by RS_Information::getIntersection() and by the quadratic solver alone, which
+ * the former falls back to, and counts the pairs whose intersections differ.
+ */
+void LC_SimpleTests::slotTestConicIntersections() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+	QString report;
+	testConicIntersections(report);
+	RS_DEBUG->print("%s: %s\n", __func__, report.toLatin1().data());
+	QMessageBox::information(nullptr, "Conic Intersections", report);
+}
+
+bool LC_SimpleTests::testConicIntersections(QString& report) {
+	const int pairs = 20000;
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<double> position(-5., 5.), radius(0.5, 5.), angle(0., 2.*M_PI);
+	RS_EntityContainer container(nullptr, true);
+	auto createEntity = [&](RS2::EntityType type) -> RS_Entity* {
+		RS_Vector center(position(rng), position(rng));
+		double r = radius(rng);
+		double a1 = angle(rng);
+		double a2 = angle(rng);
+		switch (type) {
+			case RS2::EntityCircle:
+				return new RS_Circle(&container, {center, r});
+			case RS2::EntityArc:
+				return new RS_Arc(&container, {center, r, a1, a2, false});
+			default:
+				return new RS_Ellipse(&container, {center, RS_Vector::polar(r, a1),
+												   0.2 + 0.8*a2/(2.*M_PI), 0., 2.*M_PI, false});
+		}
+	};
+	// same points, regardless of order and of points found twice
+	auto contains = [](const RS_VectorSolutions& s0, const RS_VectorSolutions& s1) {
+		return std::all_of(s0.begin(), s0.end(), [&s1](const RS_Vector& v0) {
+			return std::any_of(s1.begin(), s1.end(), [&v0](const RS_Vector& v1) {
+				return v0.distanceTo(v1) < 1e-6;
+			});
+		});
+	};
+
+	const std::vector<std::pair<RS2::EntityType, RS2::EntityType>> types = {
+		{RS2::EntityCircle, RS2::EntityCircle},
+		{RS2::EntityArc, RS2::EntityArc},
+		{RS2::EntityCircle, RS2::EntityEllipse},
+		{RS2::EntityArc, RS2::EntityEllipse},
+		{RS2::EntityEllipse, RS2::EntityEllipse}
+	};
+	const std::map<RS2::EntityType, QString> names = {
+		{RS2::EntityCircle, "circle"}, {RS2::EntityArc, "arc"}, {RS2::EntityEllipse, "ellipse"}
+	};
+	for (const auto& [type1, type2] : types) {
+		std::vector<std::pair<RS_Entity*, RS_Entity*>> entities;
+		entities.reserve(pairs);
+		for (int i = 0; i < pairs; ++i) {
+			entities.emplace_back(createEntity(type1), createEntity(type2));
+			container.addEntity(entities.back().first);
+			container.addEntity(entities.back().second);
+		}
+		std::vector<RS_VectorSolutions> byEntities;
+		byEntities.reserve(pairs);
+		QElapsedTimer timer;
+		timer.start();
+		for (const auto& [e1, e2] : entities) {
+			byEntities.push_back(RS_Information::getIntersection(e1, e2, false));
+		}
+		double entitySeconds = timer.nsecsElapsed() * 1e-9;
+
+		std::vector<RS_VectorSolutions> byQuadratics;
+		byQuadratics.reserve(pairs);
+		timer.restart();
+		for (const auto& [e1, e2] : entities) {
+			byQuadratics.push_back(LC_Quadratic::getIntersection(e1->getQuadratic(), e2->getQuadratic()));
+		}
+		double quadraticSeconds = timer.nsecsElapsed() * 1e-9;
+
+		int differences = 0;
+		for (int i = 0; i < pairs; ++i) {
+			if (!contains(byEntities[i], byQuadratics[i]) || !contains(byQuadratics[i], byEntities[i])) {
+				++differences;
+			}
+		}
+		report += QString("%1-%2: entities %3 us/pair, quadratic solver %4 us/pair, %5 of %6 pairs differ\n")
+					  .arg(names.at(type1))
+					  .arg(names.at(type2))
+					  .arg(entitySeconds * 1e6 / pairs, 0, 'f', 3)
+					  .arg(quadraticSeconds * 1e6 / pairs, 0, 'f', 3)
+					  .arg(differences)
+					  .arg(pairs);
+	}
+	return true;
+}
+
+/**
+ * Testing function. Converts every character of code page 936 (GBK) to UTF-8 and back
+ * by DRW_TextCodec, and compares with the linear table searches of the previous
+ * converters: of the lead byte range to decode and of the whole table to encode.
+ */
+void LC_SimpleTests::slotTestDbcsCodec() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+	QString report;
+	testDbcsCodec(report);
+	RS_DEBUG->print("%s: %s\n", __func__, report.toLatin1().data());
+	QMessageBox::information(nullptr, "DBCS Text Codec", report);
+}
+
+bool LC_SimpleTests::testDbcsCodec(QString& report) {
+	const int copies = 20;
+	std::string encoded;
+	encoded.reserve(2 * CPLENGTH936 * copies);
+	for (int i = 0; i < copies; ++i) {
+		for (const auto& entry : DRW_DoubleTable936) {
+			encoded += static_cast<char>(entry[0] >> 8);
+			encoded += static_cast<char>(entry[0] & 0xFF);
+		}
+	}
+	const double characters = encoded.size() / 2;
+
+	QElapsedTimer timer;
+	timer.start();
+	DRW_TextCodec codec;
+	codec.setVersion("AC1015", true);
+	codec.setCodePage("ANSI_936", true);
+	double setupSeconds = timer.nsecsElapsed() * 1e-9;
+	timer.restart();
+	std::string utf8 = codec.toUtf8(encoded);
+	double decodeSeconds = timer.nsecsElapsed() * 1e-9;
+	timer.restart();
+	std::string roundTrip = codec.fromUtf8(utf8);
+	double encodeSeconds = timer.nsecsElapsed() * 1e-9;
+
+	// linear searches, once over the table
+	std::vector<int> codePoints;
+	codePoints.reserve(CPLENGTH936);
+	timer.restart();
+	for (int i = 0; i < CPLENGTH936; ++i) {
+		int lead = static_cast<unsigned char>(encoded[2 * i]);
+		int code = (lead << 8) | static_cast<unsigned char>(encoded[2 * i + 1]);
+		int codePoint = NOTFOUND936;
+		for (int k = DRW_LeadTable936[lead - 0x81]; k < DRW_LeadTable936[lead - 0x80]; ++k) {
+			if (DRW_DoubleTable936[k][0] == code) {
+				codePoint = DRW_DoubleTable936[k][1];
+				break;
+			}
+		}
+		codePoints.push_back(codePoint);
+	}
+	double linearDecodeSeconds = timer.nsecsElapsed() * 1e-9;
+	int found = 0;
+	timer.restart();
+	for (int codePoint : codePoints) {
+		for (const auto& entry : DRW_DoubleTable936) {
+			if (entry[1] == codePoint) {
+				++found;
+				break;
+			}
+		}
+	}
+	double linearEncodeSeconds = timer.nsecsElapsed() * 1e-9;
+
+	report = QString("Code page 936, %1 characters, lookup tables built in %2 ms\n"
+					 "decode: %3 us/char, %4 MB/s\n"
+					 "encode: %5 us/char, %6 MB/s\n"
+					 "round trip: %7\n"
+					 "linear search, %8 characters: decode %9 us/char, encode %10 us/char (%11 found)\n")
+				 .arg(characters, 0, 'f', 0)
+				 .arg(setupSeconds * 1e3, 0, 'f', 3)
+				 .arg(decodeSeconds * 1e6 / characters, 0, 'f', 4)
+				 .arg(encoded.size() / (1024. * 1024.) / std::max(decodeSeconds, 1e-9), 0, 'f', 1)
+				 .arg(encodeSeconds * 1e6 / characters, 0, 'f', 4)
+				 .arg(encoded.size() / (1024. * 1024.) / std::max(encodeSeconds, 1e-9), 0, 'f', 1)
+				 .arg(roundTrip == encoded ? "identical" : "differs")
+				 .arg(CPLENGTH936)
+				 .arg(linearDecodeSeconds * 1e6 / CPLENGTH936, 0, 'f', 4)
+				 .arg(linearEncodeSeconds * 1e6 / CPLENGTH936, 0, 'f', 4)
+				 .arg(found);
+	return roundTrip == encoded && found == CPLENGTH936;
+}
+
+/**
+ * Testing function. Reads a dwg file (2004+) with entities decoded sequentially and
+ * on all cores, and compares the entities of both drawings and of their blocks, in order:
+ * type, layer and borders.
+ */
+void LC_SimpleTests::slotTestDwgConcurrentDecoding() {
+	RS_DEBUG->print("%s\n: begin\n", __func__);
+	QString fileName = QFileDialog::getOpenFileName(nullptr, "DWG Concurrent Decoding", QString(),
+													"DWG Drawing (*.dwg *.DWG)");
+	if (fileName.isEmpty()) {
+		return;
+	}
+	QString report;
+	testDwgConcurrentDecoding(fileName, report);
+	RS_DEBUG->print("%s: %s\n", __func__, report.toLatin1().data());
+	QMessageBox::information(nullptr, "DWG Concurrent Decoding", report);
+}
+
+bool LC_SimpleTests::testDwgConcurrentDecoding(const QString& fileName, QString& report) {
+	auto describe = [](const RS_EntityContainer& container, QStringList& entities) {
+		for (RS_Entity* e : container) {
+			RS_Layer* layer = e->getLayer(false);
+			entities << QString("%1 %2 (%3, %4) (%5, %6)")
+							.arg(e->rtti())
+							.arg(layer != nullptr ? layer->getName() : QString())
+							.arg(e->getMin().x, 0, 'g', 12).arg(e->getMin().y, 0, 'g', 12)
+							.arg(e->getMax().x, 0, 'g', 12).arg(e->getMax().y, 0, 'g', 12);
+		}
+	};
+	const int savedThreads = LC_GET_ONE_INT("Defaults", "DwgDecodingThreads", 1);
+	QStringList entities[2];
+	double seconds[2] = {0., 0.};
+	bool ok[2] = {false, false};
+	for (int i = 0; i < 2; ++i) {
+		// 1 - sequential, 0 - on all cores
+		LC_SET_ONE("Defaults", "DwgDecodingThreads", 1 - i);
+		RS_Graphic graphic;
+		RS_FilterDXFRW filter;
+		QElapsedTimer timer;
+		timer.start();
+		ok[i] = filter.fileImport(graphic, fileName, RS2::FormatDWG);
+		seconds[i] = timer.nsecsElapsed() * 1e-9;
+		describe(graphic, entities[i]);
+		for (unsigned b = 0; b < graphic.countBlocks(); ++b) {
+			entities[i] << "block " + graphic.blockAt(b)->getName();
+			describe(*graphic.blockAt(b), entities[i]);
+		}
+	}
+	LC_SET_ONE("Defaults", "DwgDecodingThreads", savedThreads);
+
+	int differences = std::abs(int(entities[0].size()) - int(entities[1].size()));
+	for (int i = 0; i < std::min(entities[0].size(), entities[1].size()); ++i) {
+		if (entities[0].at(i) != entities[1].at(i)) {
+			if (differences == 0) {
+				RS_DEBUG->print(RS_Debug::D_WARNING, "%s: first difference: '%s' - '%s'", __func__,
+								entities[0].at(i).toLatin1().data(), entities[1].at(i).toLatin1().data());
+			}
+			++differences;
+		}
+	}
+	report = QString("sequential: %1, %2 entities in %3 s\n"
+					 "concurrent: %4, %5 entities in %6 s\n"
+					 "%7 differences\n")
+				 .arg(ok[0] ? "OK" : "Failed")
+				 .arg(entities[0].size())
+				 .arg(seconds[0], 0, 'f', 3)
+				 .arg(ok[1] ? "OK" : "Failed")
+				 .arg(entities[1].size())
+				 .arg(seconds[1], 0, 'f', 3)
+				 .arg(differences);
+	return ok[0] && ok[1] && differences == 0;
+}
+
+int console_simpletests(int argc, char* argv[]) {
+	RS_DEBUG->setLevel(RS_Debug::D_WARNING);
+
+	QApplication app(argc, argv);
+	QCoreApplication::setOrganizationName("LibreCAD");
+	QCoreApplication::setApplicationName("LibreCAD");
+	QCoreApplication::setApplicationVersion(XSTR(LC_VERSION));
+
+	QFileInfo prgInfo(QFile::decodeName(argv[0]));
+	QString prgDir(prgInfo.absolutePath());
+	RS_Settings::init(app.organizationName(), app.applicationName());
+	RS_SYSTEM->init(app.applicationName(), app.applicationVersion(),
+		XSTR(QC_APPDIR), prgDir.toLatin1().data());
+
+	// librecad simpletests <test> [file], or simpletests <test> [file]
+	QStringList args = app.arguments().mid(1);
+	if (!args.isEmpty() && args.first() == "simpletests") {
+		args.removeFirst();
+	}
+	const QString test = args.value(0);
+	const QString fileName = args.value(1);
+	const std::map<QString, std::function<bool(QString&)>> tests = {
+		{"EntityMemoryStatistics", &LC_SimpleTests::testEntityMemoryStatistics},
+		{"BulkAddRemove", &LC_SimpleTests::testBulkAddRemove},
+		{"ConicIntersections", &LC_SimpleTests::testConicIntersections},
+		{"DbcsCodec", &LC_SimpleTests::testDbcsCodec}
+	};
+	const std::map<QString, std::function<bool(const QString&, QString&)>> fileTests = {
+		{"ReadDxfThroughput", &LC_SimpleTests::testReadDxfThroughput},
+		{"DwgConcurrentDecoding", &LC_SimpleTests::testDwgConcurrentDecoding}
+	};
+
+	QString report;
+	bool passed = false;
+	if (tests.count(test) == 1) {
+		passed = tests.at(test)(report);
+	} else if (fileTests.count(test) == 1 && !fileName.isEmpty()) {
+		passed = fileTests.at(test)(fileName, report);
+	} else {
+		std::cerr << "usage: " << argv[0] << " simpletests <test> [file]\ntests:";
+		for (const auto& t : tests) {
+			std::cerr << " " << t.first.toStdString();
+		}
+		for (const auto& t : fileTests) {
+			std::cerr << " " << t.first.toStdString() << " <file>";
+		}
+		std::cerr << std::endl;
+		return 2;
+	}
+	std::cout << test.toStdString() << ": " << report.toStdString() << std::endl;
+	return passed ? 0 : 1;
+}
@@ -3,6 +3,7 @@
 
 #include <QObject>
 
+class QString;
 class QWidget;
 class RS_EntityContainer;
 
@@ -41,5 +42,37 @@ public slots:
 	void slotTestResize800();
 	/** resizes window to 640x480 for screen shots */
 	void slotTestResize1024();
+	/** reads a scaled up dxf file and reports the read throughput */
+	void slotTestReadDxfThroughput();
+	/** reports memory used by pooled entities of each type */
+	void slotTestEntityMemoryStatistics();
+	/** times batch addition and removal of entities for growing container sizes */
+	void slotTestBulkAddRemove();
+	/** times intersections of circle, arc and ellipse pairs */
+	void slotTestConicIntersections();
+	/** times conversion of double byte code page text to and from UTF-8 */
+	void slotTestDbcsCodec();
+	/** reads a dwg file with sequential and concurrent entity decoding and compares */
+	void slotTestDwgConcurrentDecoding();
+
+public:
+	/*
+	 * tests run by the slots above and by console_simpletests(), without user interaction;
+	 * each fills 'report' and returns false on failure
+	 */
+	static bool testReadDxfThroughput(const QString& fileName, QString& report);
+	static bool testEntityMemoryStatistics(QString& report);
+	static bool testBulkAddRemove(QString& report);
+	static bool testConicIntersections(QString& report);
+	static bool testDbcsCodec(QString& report);
+	static bool testDwgConcurrentDecoding(const QString& fileName, QString& report);
 };
+
+/**
+ * Runs one of the tests without user interaction, for ctest:
+ *     librecad simpletests <test> [file]
+ * @return 0 - passed, 1 - failed, 2 - wrong arguments
+ */
+int console_simpletests(int argc, char* argv[]);
+
 #endif // LC_SIMPLETESTS_H
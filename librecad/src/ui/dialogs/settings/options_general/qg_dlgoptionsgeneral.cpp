@@ -544,6 +544,8 @@ void QG_DlgOptionsGeneral::init(){
 
         cbAutoBackup->setChecked(autoBackup);
         cbAutoSaveTime->setEnabled(autoBackup);
+        cbAutoSaveInBackground->setChecked(LC_GET_BOOL("AutoSaveInBackground", true));
+        cbAutoSaveInBackground->setEnabled(autoBackup);
         cbUseQtFileOpenDialog->setChecked(LC_GET_BOOL("UseQtFileOpenDialog", true));
         cbWheelScrollInvertH->setChecked(LC_GET_BOOL("WheelScrollInvertH"));
         cbWheelScrollInvertV->setChecked(LC_GET_BOOL("WheelScrollInvertV"));
@@ -843,6 +845,7 @@ void QG_DlgOptionsGeneral::ok(){
             LC_SET("Unit", RS_Units::unitToString(RS_Units::stringToUnit(cbUnit->currentText()), false/*untr.*/));
             LC_SET("AutoSaveTime", cbAutoSaveTime->value());
             LC_SET("AutoBackupDocument", cbAutoBackup->isChecked());
+            LC_SET("AutoSaveInBackground", cbAutoSaveInBackground->isChecked());
 
             QString autosaveFileNamePrefix = cbAutoSaveFileNamePrefix->currentText();
             LC_SET("AutosaveFilePrefix", autosaveFileNamePrefix);
@@ -1190,6 +1193,7 @@ void QG_DlgOptionsGeneral::onCheckNewVersionChanged(){
 void QG_DlgOptionsGeneral::onAutoBackupChanged([[maybe_unused]] int state){
     bool allowBackup = cbAutoBackup->isChecked();
     cbAutoSaveTime->setEnabled(allowBackup);
+    cbAutoSaveInBackground->setEnabled(allowBackup);
     auto &appWindow = QC_ApplicationWindow::getAppWindow(); // fixme - sand - files - remove static
     appWindow->startAutoSaveTimer(allowBackup);
 }
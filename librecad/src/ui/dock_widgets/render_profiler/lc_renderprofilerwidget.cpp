@@ -0,0 +1,116 @@
+/*
+ * ********************************************************************************
+ * This file is part of the LibreCAD project, a 2D CAD program
+ *
+ * Copyright (C) 2025 LibreCAD.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ * ********************************************************************************
+ */
+
+#include "lc_renderprofilerwidget.h"
+
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "lc_renderprofiler.h"
+
+namespace {
+    // interval of the report refresh, ms
+    constexpr int REFRESH_INTERVAL = 500;
+}
+
+LC_RenderProfilerWidget::LC_RenderProfilerWidget(QWidget* parent)
+    : QWidget(parent)
+    , m_enableCheckBox(new QCheckBox(tr("Profile rendering"), this))
+    , m_report(new QPlainTextEdit(this))
+    , m_refreshTimer(new QTimer(this)) {
+    auto resetButton = new QPushButton(tr("Reset"), this);
+    auto saveButton = new QPushButton(tr("Save JSON..."), this);
+
+    auto buttonsLayout = new QHBoxLayout;
+    buttonsLayout->addWidget(m_enableCheckBox);
+    buttonsLayout->addStretch();
+    buttonsLayout->addWidget(resetButton);
+    buttonsLayout->addWidget(saveButton);
+
+    m_report->setReadOnly(true);
+    m_report->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_report->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    auto layout = new QVBoxLayout;
+    layout->setContentsMargins(QMargins{});
+    layout->addLayout(buttonsLayout);
+    layout->addWidget(m_report);
+    setLayout(layout);
+
+    m_enableCheckBox->setChecked(LC_RenderProfiler::instance()->isEnabled());
+    m_refreshTimer->setInterval(REFRESH_INTERVAL);
+
+    connect(m_enableCheckBox, &QCheckBox::toggled, this, &LC_RenderProfilerWidget::setProfilingEnabled);
+    connect(resetButton, &QPushButton::clicked, this, &LC_RenderProfilerWidget::resetProfiler);
+    connect(saveButton, &QPushButton::clicked, this, &LC_RenderProfilerWidget::saveJson);
+    connect(m_refreshTimer, &QTimer::timeout, this, &LC_RenderProfilerWidget::updateReport);
+}
+
+void LC_RenderProfilerWidget::setProfilingEnabled(bool enabled) {
+    LC_RenderProfiler::instance()->setEnabled(enabled);
+}
+
+void LC_RenderProfilerWidget::resetProfiler() {
+    LC_RenderProfiler::instance()->reset();
+    updateReport();
+}
+
+void LC_RenderProfilerWidget::saveJson() {
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save rendering profile"), QString(), tr("JSON (*.json)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+    if (!LC_RenderProfiler::instance()->saveJson(fileName)) {
+        QMessageBox::warning(this, tr("Save rendering profile"), tr("Cannot write file %1").arg(fileName));
+    }
+}
+
+/**
+ * Updates the report, if frames were rendered since the last update.
+ */
+void LC_RenderProfilerWidget::updateReport() {
+    LC_RenderProfiler* profiler = LC_RenderProfiler::instance();
+    qint64 frameCount = profiler->getFrameCount();
+    if (frameCount != m_reportedFrameCount) {
+        m_reportedFrameCount = frameCount;
+        m_report->setPlainText(profiler->toText());
+    }
+}
+
+void LC_RenderProfilerWidget::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    m_reportedFrameCount = -1;
+    updateReport();
+    m_refreshTimer->start();
+}
+
+void LC_RenderProfilerWidget::hideEvent(QHideEvent* event) {
+    m_refreshTimer->stop();
+    QWidget::hideEvent(event);
+}
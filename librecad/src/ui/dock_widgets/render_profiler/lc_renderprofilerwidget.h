@@ -0,0 +1,55 @@
+/*
+ * ********************************************************************************
+ * This file is part of the LibreCAD project, a 2D CAD program
+ *
+ * Copyright (C) 2025 LibreCAD.org
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ * ********************************************************************************
+ */
+
+#ifndef LC_RENDERPROFILERWIDGET_H
+#define LC_RENDERPROFILERWIDGET_H
+
+#include <QWidget>
+
+class QCheckBox;
+class QPlainTextEdit;
+class QTimer;
+
+/**
+ * Dock widget of the rendering profiler: enables profiling at runtime, shows the report of
+ * collected counters, refreshed while the widget is visible, and saves them as JSON.
+ */
+class LC_RenderProfilerWidget: public QWidget {
+    Q_OBJECT
+public:
+    explicit LC_RenderProfilerWidget(QWidget* parent = nullptr);
+protected slots:
+    void setProfilingEnabled(bool enabled);
+    void resetProfiler();
+    void saveJson();
+    void updateReport();
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+private:
+    QCheckBox* m_enableCheckBox = nullptr;
+    QPlainTextEdit* m_report = nullptr;
+    QTimer* m_refreshTimer = nullptr;
+    qint64 m_reportedFrameCount = -1;
+};
+
+#endif // LC_RENDERPROFILERWIDGET_H
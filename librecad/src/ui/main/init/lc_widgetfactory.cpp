@@ -36,6 +36,7 @@
 #include "lc_qtstatusbarmanager.h"
 #include "lc_quickinfowidget.h"
 #include "lc_relzerocoordinateswidget.h"
+#include "lc_renderprofilerwidget.h"
 #include "lc_ucslistwidget.h"
 #include "lc_ucsstatewidget.h"
 #include "qc_applicationwindow.h"
@@ -315,6 +316,7 @@ void LC_WidgetFactory::createRightSidebar(QG_ActionHandler* action_handler){
     QDockWidget *dock_library = createLibraryWidget(action_handler);
     QDockWidget *dock_command = createCmdWidget(action_handler);
     QDockWidget *doc_pen_wiz = createPenWizardWidget();
+    QDockWidget *dock_render_profiler = createRenderProfilerWidget();
 
     m_appWin->addDockWidget(Qt::RightDockWidgetArea, doc_pen_wiz);
 
@@ -328,6 +330,9 @@ void LC_WidgetFactory::createRightSidebar(QG_ActionHandler* action_handler){
     m_appWin->addDockWidget(Qt::RightDockWidgetArea, dock_views);
     m_appWin->tabifyDockWidget(dock_views, dock_ucss);
     m_appWin->addDockWidget(Qt::RightDockWidgetArea, dock_command);
+    // diagnostic widget, shown on demand
+    m_appWin->addDockWidget(Qt::RightDockWidgetArea, dock_render_profiler);
+    dock_render_profiler->hide();
 
     updateDockWidgetsTitleBarType(m_appWin, verticalTitle);
 }
@@ -364,6 +369,14 @@ QDockWidget* LC_WidgetFactory::createPenWizardWidget(){
     return dock;
 }
 
+QDockWidget* LC_WidgetFactory::createRenderProfilerWidget(){
+    auto dock = createDockWidget(tr("Rendering Profiler"), "render_profiler_dockwidget", tr("Profiler"));
+    auto widget = new LC_RenderProfilerWidget(dock);
+    widget->setFocusPolicy(Qt::NoFocus);
+    dock->setWidget(widget);
+    return dock;
+}
+
 void LC_WidgetFactory::setDockWidgetTitleType(QDockWidget *widget, bool verticalTitleBar){
     QDockWidget::DockWidgetFeatures features =
             QDockWidget::DockWidgetClosable
@@ -62,6 +62,7 @@ private:
     QDockWidget *createCmdWidget(QG_ActionHandler *action_handler);
     void modifyCommandTitleBar(Qt::DockWidgetArea area) const;
     QDockWidget* createPenWizardWidget();
+    QDockWidget* createRenderProfilerWidget();
     void initLeftCADSidebar();
     void createRightSidebar(QG_ActionHandler *action_handler);
     void initStatusBar();
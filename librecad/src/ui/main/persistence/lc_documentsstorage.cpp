@@ -22,18 +22,257 @@
 
 #include "lc_documentsstorage.h"
 
-#include <QApplication>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
 
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "lc_parallel.h"
+#include "lc_ucs.h"
+#include "lc_ucslist.h"
+#include "lc_view.h"
+#include "lc_viewslist.h"
 #include "qg_filedialog.h"
+#include "rs_block.h"
+#include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_dialogfactoryinterface.h"
 #include "rs_document.h"
 #include "rs_fileio.h"
 #include "rs_graphic.h"
 #include "rs_graphicview.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
+#include "rs_layerlist.h"
 #include "rs_settings.h"
 
-LC_DocumentsStorage::LC_DocumentsStorage() = default;
+namespace {
+    /**
+     * Detached copy of the drawing which is written by the background auto-save.
+     * The copy shares nothing with the original drawing, so the worker thread may
+     * serialize it while the user continues editing. Block, layer, view and UCS lists
+     * do not delete their items, so the snapshot owns them.
+     */
+    struct AutoSaveSnapshot {
+        ~AutoSaveSnapshot() {
+            delete graphic;
+            qDeleteAll(blocks);
+            qDeleteAll(layers);
+            qDeleteAll(views);
+            qDeleteAll(ucsList);
+        }
+
+        RS_Graphic* graphic = nullptr;
+        QList<RS_Block*> blocks;
+        QList<RS_Layer*> layers;
+        QList<LC_View*> views;
+        QList<LC_UCS*> ucsList;
+    };
+
+    using LayersMap = std::unordered_map<const RS_Layer*, RS_Layer*>;
+
+    /**
+     * Moves the cloned entity (and all its sub-entities) to the snapshot: parent
+     * and layer pointers of the clone still refer to the original drawing.
+     */
+    void adoptClonedEntity(RS_Entity* entity, RS_EntityContainer* parent, const LayersMap& layersMap) {
+        entity->reparent(parent);
+        RS_Layer* layer = entity->getLayer(false);
+        if (layer != nullptr) {
+            auto it = layersMap.find(layer);
+            entity->setLayer(it != layersMap.end() ? it->second : nullptr);
+        }
+        if (entity->isContainer()) {
+            auto* container = static_cast<RS_EntityContainer*>(entity);
+            for (RS_Entity* child : *container) {
+                adoptClonedEntity(child, container, layersMap);
+            }
+        }
+    }
+
+    // minimal number of entities cloned by a worker thread
+    constexpr size_t SNAPSHOT_CHUNK_SIZE = 2048;
+
+    /**
+     * @return true if the clone of the entity is a plain copy of its data. Such entities are
+     * cloned by worker threads, while clones of others may recompute their caches (e.g. hatch
+     * patterns, which are loaded on demand) and are created by the UI thread.
+     */
+    bool isClonedConcurrently(const RS_Entity* entity) {
+        switch (entity->rtti()) {
+            case RS2::EntityLine:
+            case RS2::EntityArc:
+            case RS2::EntityCircle:
+            case RS2::EntityEllipse:
+            case RS2::EntityPoint:
+            case RS2::EntityConstructionLine:
+            case RS2::EntityPolyline:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * Clones entities of the drawing for the snapshot, in the original order. Entities may be
+     * modified in place, so they are cloned while the UI thread waits; the plain geometry,
+     * which makes up most of large drawings, is cloned by the shared worker threads.
+     */
+    std::vector<RS_Entity*> cloneEntities(RS_Graphic* graphic, RS_EntityContainer* snapshot, const LayersMap& layersMap) {
+        std::vector<RS_Entity*> entities;
+        entities.reserve(graphic->count());
+        for (RS_Entity* entity : *graphic) {
+            if (entity != nullptr && !entity->isUndone()) {
+                entities.push_back(entity);
+            }
+        }
+        std::vector<RS_Entity*> clones(entities.size(), nullptr);
+        for (size_t i = 0; i < entities.size(); i++) {
+            if (!isClonedConcurrently(entities[i])) {
+                clones[i] = entities[i]->clone();
+                adoptClonedEntity(clones[i], snapshot, layersMap);
+            }
+        }
+        size_t chunks = LC_Parallel::chunksCount(entities.size(), SNAPSHOT_CHUNK_SIZE);
+        LC_Parallel::forEachChunk(entities.size(), chunks, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (clones[i] == nullptr) {
+                    clones[i] = entities[i]->clone();
+                    adoptClonedEntity(clones[i], snapshot, layersMap);
+                }
+            }
+        });
+        return clones;
+    }
+
+    /**
+     * Binds cloned inserts to blocks of the snapshot. Clones keep the block of the original insert
+     * cached until they are reparented, and looking blocks up by name may build the name index of
+     * the block list, so it is done here, and not by the writer on the worker thread.
+     */
+    void bindInsertsToBlocks(RS_EntityContainer* container, RS_Graphic* snapshot) {
+        for (RS_Entity* entity : *container) {
+            if (entity->rtti() == RS2::EntityInsert) {
+                auto* insert = static_cast<RS_Insert*>(entity);
+                if (insert->getData().blockSource != nullptr) {
+                    // letters of fonts, which aren't a part of the drawing
+                    continue;
+                }
+                insert->reparent(container);
+                RS_Block* block = insert->getBlockForInsert();
+                if (block != nullptr && block->getParent() != snapshot) {
+                    RS_DEBUG->print(RS_Debug::D_WARNING, "LC_DocumentsStorage: insert of block %s isn't bound to the snapshot",
+                                    insert->getName().toLatin1().data());
+                }
+            }
+            if (entity->isContainer()) {
+                bindInsertsToBlocks(static_cast<RS_EntityContainer*>(entity), snapshot);
+            }
+        }
+    }
+
+    /**
+     * Creates the snapshot of the graphic. Should be called on the UI thread, as it reads
+     * the original drawing (and the settings, via RS_Graphic constructor).
+     */
+    std::unique_ptr<AutoSaveSnapshot> createAutoSaveSnapshot(RS_Graphic* graphic) {
+        auto result = std::make_unique<AutoSaveSnapshot>();
+        auto* snapshot = new RS_Graphic();
+        result->graphic = snapshot;
+
+        snapshot->setVariableDictObject(graphic->getVariableDictObject());
+        snapshot->setMargins(graphic->getMarginLeft(), graphic->getMarginTop(),
+                             graphic->getMarginRight(), graphic->getMarginBottom());
+        snapshot->setPagesNum(graphic->getPagesNumHoriz(), graphic->getPagesNumVert());
+        snapshot->setPaperScaleFixed(graphic->getPaperScaleFixed());
+
+        LayersMap layersMap;
+        snapshot->clearLayers();
+        RS_LayerList* layerList = graphic->getLayerList();
+        for (unsigned i = 0; i < layerList->count(); i++) {
+            RS_Layer* layer = layerList->at(i);
+            RS_Layer* layerCopy = layer->clone();
+            layersMap[layer] = layerCopy;
+            result->layers.append(layerCopy);
+            snapshot->addLayer(layerCopy);
+        }
+        auto activeLayer = layersMap.find(graphic->getActiveLayer());
+        if (activeLayer != layersMap.end()) {
+            snapshot->activateLayer(activeLayer->second);
+        }
+
+        for (unsigned i = 0; i < graphic->countBlocks(); i++) {
+            RS_Block* block = graphic->blockAt(i);
+            if (block->isUndone()) {
+                continue;
+            }
+            auto* blockCopy = static_cast<RS_Block*>(block->clone());
+            adoptClonedEntity(blockCopy, snapshot, layersMap);
+            if (snapshot->addBlock(blockCopy, false)) {
+                result->blocks.append(blockCopy);
+            }
+        }
+
+        for (RS_Entity* entityCopy : cloneEntities(graphic, snapshot, layersMap)) {
+            // keep the structure of the drawing as is, RS_Graphic::addEntity() flattens plain containers
+            snapshot->RS_EntityContainer::addEntity(entityCopy);
+        }
+
+        bindInsertsToBlocks(snapshot, snapshot);
+        for (RS_Block* blockCopy : std::as_const(result->blocks)) {
+            bindInsertsToBlocks(blockCopy, snapshot);
+        }
+
+        LC_UCSList* ucsList = graphic->getUCSList();
+        for (unsigned i = 0; i < ucsList->count(); i++) {
+            LC_UCS* ucsCopy = ucsList->at(i)->clone();
+            result->ucsList.append(ucsCopy);
+            snapshot->addUCS(ucsCopy);
+        }
+
+        LC_ViewList* viewList = graphic->getViewList();
+        for (unsigned i = 0; i < viewList->count(); i++) {
+            LC_View* viewCopy = viewList->at(i)->clone();
+            if (viewCopy->isHasUCS()) {
+                LC_UCS* viewUcsCopy = viewCopy->getUCS()->clone();
+                result->ucsList.append(viewUcsCopy);
+                viewCopy->setUCS(viewUcsCopy);
+            }
+            result->views.append(viewCopy);
+            snapshot->addNamedView(viewCopy);
+        }
+        return result;
+    }
+
+    /**
+     * Replaces the target file by the written temporary one. Unlike removing the target
+     * and renaming, the rename with replacement never leaves the partially written
+     * or missing auto-save file.
+     */
+    bool replaceFile(const QString& sourceFileName, const QString& targetFileName) {
+        std::error_code error;
+        std::filesystem::rename(QFileInfo(sourceFileName).filesystemAbsoluteFilePath(),
+                                QFileInfo(targetFileName).filesystemAbsoluteFilePath(), error);
+        if (error) {
+            RS_DEBUG->print(RS_Debug::D_WARNING, "LC_DocumentsStorage: can't replace auto-save file: %s",
+                            error.message().c_str());
+            QFile::remove(sourceFileName);
+            return false;
+        }
+        return true;
+    }
+}
+
+LC_DocumentsStorage::LC_DocumentsStorage(QObject* parent):QObject(parent) {
+}
+
+LC_DocumentsStorage::~LC_DocumentsStorage() {
+    // the auto-save file should be complete even if the document is closed during auto-save
+    waitForAutoSave();
+}
 
 bool LC_DocumentsStorage::saveDocument(RS_Document* document, RS_GraphicView * graphicView,  bool &cancelled) {
     bool result = false;
@@ -85,6 +324,84 @@ bool LC_DocumentsStorage::autoSaveDocument(RS_Document* document, RS_GraphicView
     return result;
 }
 
+/**
+ * Auto-saves the document without blocking the UI. The snapshot of the drawing is
+ * created while the calling thread waits (plain geometry is cloned by the shared workers),
+ * while its serialization is performed by the worker thread into the temporary file
+ * that replaces the auto-save file once written.
+ * Completion is reported by autoSaveFinished() signal.
+ * @return false if the auto-save can't be started
+ */
+bool LC_DocumentsStorage::autoSaveDocumentInBackground(RS_Document* document, QString& autosaveFileName) {
+    if (document == nullptr) {
+        return false;
+    }
+    RS_Graphic* graphic = document->getGraphic();
+    if (graphic == nullptr) {
+        return false;
+    }
+    autosaveFileName = graphic->getAutoSaveFileName();
+    if (isAutoSaveInProgress()) {
+        // previous auto-save is still writing, skip this one
+        return true;
+    }
+    if (!graphic->isModified()) {
+        emit autoSaveFinished(true, autosaveFileName, 0, 0);
+        return true;
+    }
+    if (autosaveFileName.isEmpty()) {
+        return false;
+    }
+
+    RS2::FormatType formatType = graphic->getFormatType();
+    if (formatType == RS2::FormatUnknown) {
+        formatType = RS2::FormatDXFRW;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    std::shared_ptr<AutoSaveSnapshot> snapshot = createAutoSaveSnapshot(graphic);
+    qint64 snapshotTime = timer.elapsed();
+    RS_DEBUG->print("LC_DocumentsStorage::autoSaveDocumentInBackground: snapshot created in %lld ms", snapshotTime);
+
+    auto writeTime = std::make_shared<qint64>(0);
+    auto success = std::make_shared<bool>(false);
+    QString tmpFileName = autosaveFileName + ".tmp";
+
+    QThread* thread = QThread::create([snapshot = std::move(snapshot), tmpFileName, autosaveFileName, formatType, writeTime, success]() mutable {
+        QElapsedTimer writeTimer;
+        writeTimer.start();
+        bool written = RS_FileIO::instance()->fileExport(*snapshot->graphic, tmpFileName, formatType);
+        if (written) {
+            written = replaceFile(tmpFileName, autosaveFileName);
+        } else {
+            QFile::remove(tmpFileName);
+        }
+        // the snapshot is not needed anymore, release it here and not on UI thread
+        snapshot.reset();
+        *writeTime = writeTimer.elapsed();
+        *success = written;
+    });
+
+    connect(thread, &QThread::finished, this, [this, autosaveFileName, snapshotTime, writeTime, success]() {
+        emit autoSaveFinished(*success, autosaveFileName, snapshotTime, *writeTime);
+    });
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    m_autoSaveThread = thread;
+    thread->start(QThread::LowPriority);
+    return true;
+}
+
+bool LC_DocumentsStorage::isAutoSaveInProgress() const {
+    return m_autoSaveThread != nullptr && !m_autoSaveThread->isFinished();
+}
+
+void LC_DocumentsStorage::waitForAutoSave() const {
+    if (m_autoSaveThread != nullptr) {
+        m_autoSaveThread->wait();
+    }
+}
+
 bool LC_DocumentsStorage::saveBlockAs(RS_Graphic *block, const QString &fileName){
     bool result = false;
     if (!fileName.isEmpty()) {
@@ -259,6 +576,9 @@ bool LC_DocumentsStorage::exportGraphics(RS_Graphic* graphic, const QString& fil
 bool LC_DocumentsStorage::saveGraphicAs(RS_Graphic* graphic, const QString &filename, RS2::FormatType type, bool forceSave) {
     bool ret = false;
 
+    // background auto-save should not re-create auto-save file which is removed below
+    waitForAutoSave();
+
     // Check/memorize if file name we want to use as new file
    // name is the same as the actual file name.
 
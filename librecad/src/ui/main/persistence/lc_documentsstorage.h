@@ -24,8 +24,10 @@
 #define LC_DOCUMENTSSTORAGE_H
 
 #include <QObject>
+#include <QPointer>
 #include "rs.h"
 
+class QThread;
 class RS_Graphic;
 class RS_GraphicView;
 class RS_Document;
@@ -34,15 +36,26 @@ class QFileInfo;
 class LC_DocumentsStorage: public QObject{
     Q_OBJECT
 public:
-    LC_DocumentsStorage();
+    explicit LC_DocumentsStorage(QObject* parent = nullptr);
+    ~LC_DocumentsStorage() override;
     bool saveDocument(RS_Document *document,RS_GraphicView * graphicView, bool &cancelled);
     bool saveBlockAs(RS_Graphic* block, const QString& fileName);
     bool autoSaveDocument(RS_Document *document,RS_GraphicView * graphicView, QString& autosaveFileName);
+    bool autoSaveDocumentInBackground(RS_Document *document, QString& autosaveFileName);
+    bool isAutoSaveInProgress() const;
+    void waitForAutoSave() const;
     bool saveDocumentAs(const RS_Document *document,RS_GraphicView * graphicView, bool &cancelled);
     bool exportGraphics(RS_Graphic *document,const QString &fileName, RS2::FormatType formatType);
     bool loadDocument(const RS_Document *document, const QString &fileName, RS2::FormatType type) const;
     bool loadDocument(const RS_Document *document, const QString &fileName) const;
     bool loadDocumentFromTemplate(const RS_Document *document, RS_GraphicView *graphicView, const QString &fileName, RS2::FormatType type) const;
+signals:
+    /**
+     * Emitted on the UI thread once a background auto-save is completed.
+     * @param snapshotTime time (ms) spent on copying the drawing on the UI thread
+     * @param writeTime time (ms) spent on writing the file by the worker thread
+     */
+    void autoSaveFinished(bool success, const QString& autosaveFileName, qint64 snapshotTime, qint64 writeTime);
 protected:
     bool doSaveGraphicAs(RS_Graphic* graphic, RS_GraphicView *graphicView, bool &cancelled, const QString& currentFileName = "");
     bool autoSaveGraphic(RS_Graphic *graphic, QString& fileName);
@@ -55,6 +68,9 @@ protected:
     QString createAutoSaveFileName(const QFileInfo &fileInfo) const;
     QString createAutoSaveFileName(const QFileInfo &fileInfo, const QString &filePrefix) const;
     QString createAutoSaveFileName(const QString &path, const QString &filePrefix, const QString &fileName) const;
+private:
+    // worker thread of the background auto-save which is currently running, if any
+    QPointer<QThread> m_autoSaveThread;
 };
 
 #endif // LC_DOCUMENTSSTORAGE_H
@@ -1097,16 +1097,35 @@ void QC_ApplicationWindow::autoSaveCurrentDrawing() {
     QC_MDIWindow *w = getCurrentMDIWindow();
     if (w != nullptr) {
         QString autosaveFileName;
-        if (w->autoSaveDocument(autosaveFileName)) {
-            showStatusMessage(tr("Auto-saved drawing"), 2000);
+        if (LC_GET_ONE_BOOL("Defaults", "AutoSaveInBackground", true)) {
+            connect(w, &QC_MDIWindow::autoSaveFinished, this, &QC_ApplicationWindow::onAutoSaveFinished, Qt::UniqueConnection);
+            if (!w->autoSaveDocumentInBackground(autosaveFileName)) {
+                onAutoSaveFinished(false, autosaveFileName, 0, 0);
+            }
+        } else {
+            bool saved = w->autoSaveDocument(autosaveFileName);
+            onAutoSaveFinished(saved, autosaveFileName, 0, 0);
+        }
+    }
+}
+
+void QC_ApplicationWindow::onAutoSaveFinished(bool success, const QString& autosaveFileName, qint64 snapshotTime, qint64 writeTime) {
+    if (success) {
+        if (writeTime > 0) {
+            showStatusMessage(tr("Auto-saved drawing (snapshot %1 ms, written in background in %2 ms)")
+                                  .arg(snapshotTime).arg(writeTime), 2000);
         } else {
-            // error
+            showStatusMessage(tr("Auto-saved drawing"), 2000);
+        }
+    } else {
+        // error
+        if (m_autosaveTimer != nullptr) {
             m_autosaveTimer->stop();
-            QMessageBox::information(this, QMessageBox::tr("Warning"),
-                                     tr("Cannot auto-save the file\n%1\nPlease check the permissions.\n"
-                                        "Auto-save disabled.").arg(autosaveFileName),QMessageBox::Ok);
-            showStatusMessage(tr("Auto-saving failed"), 2000);
         }
+        QMessageBox::information(this, QMessageBox::tr("Warning"),
+                                 tr("Cannot auto-save the file\n%1\nPlease check the permissions.\n"
+                                    "Auto-save disabled.").arg(autosaveFileName),QMessageBox::Ok);
+        showStatusMessage(tr("Auto-saving failed"), 2000);
     }
 }
 
@@ -164,6 +164,7 @@ public slots:
     void slotFileSaveAll();
     /** auto-save document */
     void autoSaveCurrentDrawing();
+    void onAutoSaveFinished(bool success, const QString& autosaveFileName, qint64 snapshotTime, qint64 writeTime);
     /** exports the document as bitmap */
     void slotFileExport();
 
@@ -54,6 +54,8 @@ QC_MDIWindow::QC_MDIWindow(RS_Document *doc, QWidget *parent, bool printPreview,
     , m_owner{doc == nullptr}{
     setAttribute(Qt::WA_DeleteOnClose);
     m_cadMdiArea=qobject_cast<QMdiArea*>(parent);
+    m_documentsStorage = new LC_DocumentsStorage(this);
+    connect(m_documentsStorage, &LC_DocumentsStorage::autoSaveFinished, this, &QC_MDIWindow::autoSaveFinished);
 
     if (doc==nullptr) {
         m_document = new RS_Graphic();
@@ -339,6 +341,14 @@ bool QC_MDIWindow::autoSaveDocument(QString& autosaveFileName){
     return result;
 }
 
+/**
+ * Auto-saves the document without blocking the UI, the result is reported by autoSaveFinished() signal.
+ */
+bool QC_MDIWindow::autoSaveDocumentInBackground(QString& autosaveFileName){
+    bool result = m_documentsStorage->autoSaveDocumentInBackground(m_document, autosaveFileName);
+    return result;
+}
+
 /**
  * Saves the current file. The user is asked for a new filename
  * and format.
@@ -52,8 +52,12 @@ public slots:
     bool loadDocument(const QString &fileName, RS2::FormatType type);
     bool saveDocument(bool &cancelled, bool isAutoSave = false);
     bool autoSaveDocument(QString &autosaveFileName);
+    bool autoSaveDocumentInBackground(QString &autosaveFileName);
     bool saveDocumentAs(bool &cancelled);
     void slotFilePrint();
+signals:
+    /** Emitted once the background auto-save of the document is completed */
+    void autoSaveFinished(bool success, const QString& autosaveFileName, qint64 snapshotTime, qint64 writeTime);
 public:
     enum SaveOnClosePolicy {
         ASK,
@@ -102,7 +106,7 @@ public:
     }
 
 protected:
-    LC_DocumentsStorage *m_documentsStorage;
+    LC_DocumentsStorage *m_documentsStorage = nullptr;
     // window ID
     unsigned id = 0;
     // Graphic view
@@ -1223,6 +1223,11 @@ void QG_GraphicView::layerActivated(RS_Layer *layer) {
  */
 void QG_GraphicView::paintEvent(QPaintEvent *){
     getRenderer()->render();
+    // progressive rendering continues by the next paint, after pending events are processed;
+    // the renderer starts it again if entities were removed from the document meanwhile
+    if (getRenderer()->isRenderingInProgress()) {
+        update();
+    }
 }
 
 
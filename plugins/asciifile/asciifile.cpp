@@ -25,9 +25,33 @@
 #include <QSettings>
 
 #include <QMessageBox>
+#include <QTextStream>
 
 #include "asciifile.h"
 
+namespace {
+//! number of points read before they are added to the document
+constexpr size_t chunkSize = 65536;
+
+/**
+ * Splits the line by the separator into the fields vector, which is reused
+ * between lines to avoid building a new list for each line.
+ */
+void splitFields(const QString &line, QChar sep, bool skipEmpty, std::vector<QString> &fields)
+{
+    fields.clear();
+    int start = 0;
+    while (start <= line.size()) {
+        int end = line.indexOf(sep, start);
+        if (end < 0)
+            end = line.size();
+        if (!skipEmpty || end > start)
+            fields.push_back(line.mid(start, end - start));
+        start = end + 1;
+    }
+}
+}
+
 PluginCapabilities AsciiFile::getCapabilities() const
 {
     PluginCapabilities pluginCapabilities;
@@ -235,11 +259,15 @@ dibPunto::dibPunto(QWidget *parent) :  QDialog(parent)
     txtformats << tr("Space Separator") << tr("Tab Separator") << tr("Comma Separator") << tr("Space in Columns") << tr("*.odb for Psion 2");
     formatedit->addItems(txtformats);
     connectPoints = new QCheckBox(tr("Connect points"));
+    pointCloud = new QCheckBox(tr("Points as point cloud"));
+    pointCloud->setToolTip(tr("Add the points as a single entity, which takes less memory, "
+                              "but the points can't be edited one by one"));
 
     QHBoxLayout *loformat = new QHBoxLayout;
     loformat->addWidget(formatlabel);
     loformat->addWidget(formatedit);
     loformat->addWidget(connectPoints);
+    loformat->addWidget(pointCloud);
     mainLayout->addLayout(loformat, 0, 1);
 
     pt2d = new pointBox(tr("2D Point"),tr("Draw 2D Point"));
@@ -365,85 +393,96 @@ void dibPunto::procesFile(Document_Interface *doc)
          return;
     }
 
+    currLayer = currDoc->getCurrentLayer();
+    lastLinePoint.reset();
+    dataList.clear();
+    dataList.reserve(chunkSize);
+
+    // all chunks of the file are undone together
+    currDoc->startUndoCycle();
 //Warning, can change adding or reordering "formatedit"
     if (formatedit->currentIndex() == 4)
         procesfileODB(&infile, sep);
     else
         procesfileNormal(&infile, sep, skip);
     infile.close ();
-    QString currlay = currDoc->getCurrentLayer();
+    flushData();
+    currDoc->endUndoCycle();
+
+    currDoc->setLayer(currLayer);
+    currDoc = nullptr;
+
+}
+
+/**
+ * Adds the points read so far to the document and clears them, so large
+ * files are imported chunk by chunk instead of being held in memory.
+ */
+void dibPunto::flushData()
+{
+    if (dataList.empty())
+        return;
 
     if (pt2d->checkOn() == true)
         draw2D();
     if (pt3d->checkOn() == true)
         draw3D();
     if (ptelev->checkOn() == true)
-        drawElev();
+        drawTexts(ptelev, &PointData::z);
     if (ptnumber->checkOn() == true)
-        drawNumber();
+        drawTexts(ptnumber, &PointData::number);
     if (ptcode->checkOn() == true)
-        drawCode();
+        drawTexts(ptcode, &PointData::code);
 
-    currDoc->setLayer(currlay);
+    currDoc->setLayer(currLayer);
     /* draw lines in current layer */
     if ( connectPoints->isChecked() )
         drawLine();
 
-    currDoc = nullptr;
+    dataList.clear();
+}
 
+std::vector<QPointF> dibPunto::validPoints() const
+{
+    std::vector<QPointF> points;
+    points.reserve(dataList.size());
+    for (const PointData &pd: dataList) {
+        if (!pd.x.isEmpty() && !pd.y.isEmpty())
+            points.emplace_back(pd.x.toDouble(), pd.y.toDouble());
+    }
+    return points;
 }
 
 void dibPunto::drawLine()
 {
-    QPointF prevP, nextP;
-    int i;
-
-    for (i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty()){
-            prevP.setX(pd->x.toDouble());
-            prevP.setY(pd->y.toDouble());
-            break;
-        }
-    }
-    for (; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty()){
-            nextP.setX(pd->x.toDouble());
-            nextP.setY(pd->y.toDouble());
-            currDoc->addLine(&prevP, &nextP);
-            prevP = nextP;
-        }
-    }
+    std::vector<QPointF> points = validPoints();
+    if (points.empty())
+        return;
+    // continue from the last point of the previous chunk
+    if (lastLinePoint)
+        points.insert(points.begin(), *lastLinePoint);
+    lastLinePoint = points.back();
+    currDoc->addLines(points);
 }
 
 void dibPunto::draw2D()
 {
-    QPointF pt;
     currDoc->setLayer(pt2d->getLayer());
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty()){
-            pt.setX(pd->x.toDouble());
-            pt.setY(pd->y.toDouble());
-            currDoc->addPoint(&pt);
-        }
-    }
+    addPoints(validPoints());
 }
 void dibPunto::draw3D()
 {
-    QPointF pt;
     currDoc->setLayer(pt3d->getLayer());
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty()){
-            pt.setX(pd->x.toDouble());
-            pt.setY(pd->y.toDouble());
-/*RLZ:3d support            if (pd->z.isEmpty()) pt.setZ(0.0);
-            else  pt.setZ(pd->z.toDouble());*/
-            currDoc->addPoint(&pt);
-        }
-    }
+//RLZ:3d support, z coordinate is not used yet
+    addPoints(validPoints());
+}
+
+void dibPunto::addPoints(std::vector<QPointF> const& points)
+{
+    if (pointCloud->isChecked())
+        currDoc->addPointCloud(points);
+    else
+        currDoc->addPoints(points);
 }
 
 void dibPunto::calcPos(DPI::VAlign *v, DPI::HAlign *h, double sep,
@@ -501,94 +540,52 @@ void dibPunto::calcPos(DPI::VAlign *v, DPI::HAlign *h, double sep,
     *h =ha;
 }
 
-void dibPunto::drawNumber()
-{
-    double incx, incy, newx, newy;
-    DPI::VAlign va;
-    DPI::HAlign ha;
-    calcPos(&va, &ha, ptnumber->getSeparation(),
-                 &incx, &incy, ptnumber->getPosition());
-
-    currDoc->setLayer(ptnumber->getLayer());
-    QString sty = ptnumber->getStyleStr();
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty() && !pd->number.isEmpty()){
-            newx = pd->x.toDouble() + incx;
-            newy = pd->y.toDouble() + incy;
-            QPointF pt(newx,newy);
-            currDoc->addText(pd->number, sty, &pt, ptnumber->getHeightStr().toDouble(), 0.0, ha, va);
-        }
-    }
-}
-
-void dibPunto::drawElev()
-{
-
-    double incx, incy, newx, newy;
-    DPI::VAlign va;
-    DPI::HAlign ha;
-    calcPos(&va, &ha, ptelev->getSeparation(),
-                 &incx, &incy, ptelev->getPosition());
-
-    currDoc->setLayer(ptelev->getLayer());
-    QString sty = ptelev->getStyleStr();
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty() && !pd->z.isEmpty()){
-            newx = pd->x.toDouble() + incx;
-            newy = pd->y.toDouble() + incy;
-            QPointF pt(newx,newy);
-            currDoc->addText(pd->z, sty, &pt, ptelev->getHeightStr().toDouble(), 0.0, ha, va);
-        }
-    }
-}
-void dibPunto::drawCode()
+void dibPunto::drawTexts(textBox *box, QString PointData::*text)
 {
-    double incx, incy, newx, newy;
+    double incx, incy;
     DPI::VAlign va;
     DPI::HAlign ha;
-    calcPos(&va, &ha, ptcode->getSeparation(),
-                 &incx, &incy, ptcode->getPosition());
-
-    currDoc->setLayer(ptcode->getLayer());
-    QString sty = ptcode->getStyleStr();
-    for (int i = 0; i < dataList.size(); ++i) {
-        PointData *pd = dataList.at(i);
-        if (!pd->x.isEmpty() && !pd->y.isEmpty() && !pd->code.isEmpty()){
-            newx = pd->x.toDouble() + incx;
-            newy = pd->y.toDouble() + incy;
-            QPointF pt(newx,newy);
-            currDoc->addText(pd->code, sty, &pt, ptcode->getHeightStr().toDouble(), 0.0, ha, va);
+    calcPos(&va, &ha, box->getSeparation(),
+                 &incx, &incy, box->getPosition());
+
+    QStringList txts;
+    std::vector<QPointF> starts;
+    for (const PointData &pd: dataList) {
+        if (!pd.x.isEmpty() && !pd.y.isEmpty() && !(pd.*text).isEmpty()){
+            txts.append(pd.*text);
+            starts.emplace_back(pd.x.toDouble() + incx, pd.y.toDouble() + incy);
         }
     }
+    currDoc->setLayer(box->getLayer());
+    currDoc->addTexts(txts, box->getStyleStr(), starts, box->getHeightStr().toDouble(), 0.0, ha, va);
 }
 
 void dibPunto::procesfileODB(QFile* file, QString sep)
 {
     QStringList data;
-    PointData *pd;
 
     while (!file->atEnd()) {
         QString line = file->readLine();
         line.remove ( line.size()-2, 1);
         data = line.split(sep);
-        pd = new PointData;
+        PointData pd;
         int i = 0;
         int j = data.size();
         if (i<j && data.at(i).compare("4")==0 ){
             i = i+2;
-            if (i<j) pd->x = data.at(i); else pd->x = QString();
+            if (i<j) pd.x = data.at(i); else pd.x = QString();
             i++;
-            if (i<j) pd->y = data.at(i); else pd->y = QString();
+            if (i<j) pd.y = data.at(i); else pd.y = QString();
             i++;
-            if (i<j) pd->z = data.at(i); else pd->z = QString();
+            if (i<j) pd.z = data.at(i); else pd.z = QString();
             i++;
-            if (i<j) pd->number = data.at(i); else pd->number = QString();
+            if (i<j) pd.number = data.at(i); else pd.number = QString();
             i++;
-            if (i<j) pd->code = data.at(i); else pd->code = QString();
+            if (i<j) pd.code = data.at(i); else pd.code = QString();
         }
-        dataList.append(pd);
+        dataList.push_back(pd);
+        if (dataList.size() >= chunkSize)
+            flushData();
     }
 
 }
@@ -599,50 +596,53 @@ void dibPunto::procesfileNormal(QFile* file, QString sep, Qt::SplitBehaviorFlags
 void dibPunto::procesfileNormal(QFile* file, QString sep, QString::SplitBehavior skip)
 #endif
 {
-    //    QString outname, sep;
-    QStringList data;
-    PointData *pd;
-    while (!file->atEnd()) {
-        QString line = file->readLine();
-		if(line.isEmpty()) continue;
-        line.remove ( line.size()-1, 1);
-        data = line.split(sep, skip);
-        pd = new PointData;
-        int i = 0;
+    // lines are read into the same buffer and split in place
+    QTextStream in(file);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    in.setCodec("UTF-8");
+#endif
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    const bool skipEmpty = skip.testFlag(Qt::SkipEmptyParts);
+#else
+    const bool skipEmpty = skip == QString::SkipEmptyParts;
+#endif
+    const QChar separator = sep.at(0);
+    QString line;
+    std::vector<QString> data;
+    while (in.readLineInto(&line)) {
+        splitFields(line, separator, skipEmpty, data);
+        PointData pd;
         switch(data.size()){
         case 0:
         case 1:
-            delete pd;
             continue;
 
             //allow reading in raw 2D ascii data in format:
             // x y
         case 2:
-            pd->x = data.at(0);
-            pd->y = data.at(1);
+            pd.x = data.at(0);
+            pd.y = data.at(1);
             break;
         default:
         case 5:
-            pd->code=data.at(4);
+            pd.code=data.at(4);
             // fall-through
         case 4:
-            pd->z = data.at(3);
+            pd.z = data.at(3);
             // fall-through
         case 3:
-            pd->number = data.at(i);
-            pd->x = data.at(1);
-            pd->y = data.at(2);
+            pd.number = data.at(0);
+            pd.x = data.at(1);
+            pd.y = data.at(2);
             break;
         }
-        dataList.append(pd);
+        dataList.push_back(std::move(pd));
+        if (dataList.size() >= chunkSize)
+            flushData();
     }
 }
 
-dibPunto::~dibPunto()
-{
-    while (!dataList.isEmpty())
-         delete dataList.takeFirst();
-}
+dibPunto::~dibPunto() = default;
 
 void dibPunto::readSettings()
  {
@@ -654,6 +654,7 @@ void dibPunto::readSettings()
     fileedit->setText(str);
     formatedit->setCurrentIndex( settings.value("format", 0).toInt() );
     connectPoints->setChecked( settings.value("connectpoints", false).toBool() );
+    pointCloud->setChecked( settings.value("pointcloud", false).toBool() );
     pt2d->setCheck( settings.value("draw2d", false).toBool() );
     str = settings.value("layer2d").toString();
     pt2d->setLayer(str);
@@ -698,6 +699,7 @@ void dibPunto::writeSettings()
     settings.setValue("drawnumber", ptnumber->checkOn());
     settings.setValue("drawcode", ptcode->checkOn());
     settings.setValue("connectpoints", connectPoints->isChecked());
+    settings.setValue("pointcloud", pointCloud->isChecked());
     settings.setValue("layer2d", pt2d->getLayer());
     settings.setValue("layer3d", pt3d->getLayer());
     settings.setValue("layerelev", ptelev->getLayer());
@@ -21,13 +21,23 @@
 #include <QLineEdit>
 #include <QComboBox>
 #include <QDialog>
+#include <optional>
+#include <vector>
 #include "qc_plugininterface.h"
 #include "document_interface.h"
 
 class pointBox;
 class textBox;
 class QVBoxLayout;
-struct PointData;
+
+struct PointData
+{
+    QString number;
+    QString x;
+    QString y;
+    QString z;
+    QString code;
+};
 
 class AsciiFile : public QObject, QC_PluginInterface
 {
@@ -69,12 +79,13 @@ private:
 #else
     void procesfileNormal(QFile* file, QString sep, QString::SplitBehavior skip = QString::KeepEmptyParts);
 #endif
+    void flushData();
+    std::vector<QPointF> validPoints() const;
     void drawLine();
     void draw2D();
     void draw3D();
-    void drawNumber();
-    void drawElev();
-    void drawCode();
+    void addPoints(std::vector<QPointF> const& points);
+    void drawTexts(textBox *box, QString PointData::*text);
     bool failGUI(QString *msg);
     void calcPos(DPI::VAlign *v, DPI::HAlign *h, double sep,
                  double *x, double *y, DPT::txtposition sit);
@@ -89,7 +100,8 @@ private:
     QLineEdit *fileedit;
     QComboBox *formatedit;
     QCheckBox *connectPoints;
-    QList<PointData*> dataList;
+    QCheckBox *pointCloud;
+    std::vector<PointData> dataList;
 
     Document_Interface *currDoc;
 
@@ -164,13 +176,4 @@ private:
     imgLabel *img;
 };
 /***********/
-struct PointData
-{
-    QString number;
-    QString x;
-    QString y;
-    QString z;
-    QString code;
-};
-/***********/
 #endif // ECHOPLUG_H